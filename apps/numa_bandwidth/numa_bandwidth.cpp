@@ -0,0 +1,153 @@
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <random>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <vector>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/syscall.h>
+#endif
+#include "taco.h"
+#include "taco/storage/allocator.h"
+
+using namespace taco;
+
+static int countNumaNodes() {
+  std::ifstream online("/sys/devices/system/node/online");
+  std::string ranges;
+  if (!std::getline(online, ranges)) {
+    return 1;
+  }
+  int numNodes = 0;
+  size_t begin = 0;
+  while (begin < ranges.size()) {
+    size_t end = std::min(ranges.find(',', begin), ranges.size());
+    std::string range = ranges.substr(begin, end - begin);
+    size_t dash = range.find('-');
+    int first = std::stoi(range.substr(0, dash));
+    int last = (dash == std::string::npos) ? first
+                                           : std::stoi(range.substr(dash + 1));
+    numNodes += last - first + 1;
+    begin = end + 1;
+  }
+  return numNodes;
+}
+
+/// Adds the bytes of the array on each NUMA node to `bytesPerNode`.  Pages
+/// that are not placed yet, and all pages on systems that cannot report the
+/// nodes of pages, are not counted.
+static void countBytesPerNode(const Array& array,
+                              std::vector<double>& bytesPerNode) {
+#if defined(__linux__) && defined(SYS_move_pages)
+  const size_t pageSize = sysconf(_SC_PAGESIZE);
+  char* begin = (char*)array.getData();
+  char* end = begin + array.getSize() * array.getType().getNumBytes();
+  char* firstPage = (char*)((size_t)begin / pageSize * pageSize);
+  std::vector<void*> pages;
+  for (char* page = firstPage; page < end; page += pageSize) {
+    pages.push_back(page);
+  }
+  // Querying the nodes of pages leaves them in place.
+  std::vector<int> nodes(pages.size(), -1);
+  if (syscall(SYS_move_pages, 0, pages.size(), pages.data(), nullptr,
+              nodes.data(), 0) != 0) {
+    return;
+  }
+  for (size_t p = 0; p < pages.size(); p++) {
+    if (nodes[p] >= 0 && nodes[p] < (int)bytesPerNode.size()) {
+      char* pageBegin = std::max((char*)pages[p], begin);
+      char* pageEnd = std::min((char*)pages[p] + pageSize, end);
+      bytesPerNode[nodes[p]] += pageEnd - pageBegin;
+    }
+  }
+#endif
+}
+
+static const char* toString(NumaPlacement placement) {
+  switch (placement) {
+    case NumaPlacement::Default:    return "default";
+    case NumaPlacement::FirstTouch: return "first-touch";
+    case NumaPlacement::Interleave: return "interleave";
+  }
+  return "";
+}
+
+int main(int argc, char* argv[]) {
+  int rows = (argc > 1) ? std::stoi(argv[1]) : 1 << 18;
+  int nnzPerRow = (argc > 2) ? std::stoi(argv[2]) : 16;
+  int cols = rows;
+  const int repeats = 10;
+
+  const int numNodes = countNumaNodes();
+  std::cout << "NUMA nodes: " << numNodes << std::endl;
+  std::cout << "A: " << rows << "x" << cols << " CSR with " << nnzPerRow
+            << " nonzeros per row" << std::endl;
+
+  int maxThreads = std::max(1u, std::thread::hardware_concurrency());
+  for (NumaPlacement placement : {NumaPlacement::Default,
+                                  NumaPlacement::FirstTouch,
+                                  NumaPlacement::Interleave}) {
+    // The arrays are allocated, and so placed, when they are packed and when
+    // the kernel assembles y.
+    setNumaPlacement(placement);
+    for (int threads = 1; threads <= maxThreads; threads *= 2) {
+      taco_set_num_threads(threads);
+
+      std::default_random_engine gen(0);
+      std::uniform_int_distribution<int> col(0, cols - 1);
+      Tensor<double> A("A", {rows, cols}, Format({Dense, Sparse}));
+      Tensor<double> x("x", {cols}, Format({Dense}));
+      Tensor<double> y("y", {rows}, Format({Dense}));
+      for (int i = 0; i < rows; i++) {
+        for (int k = 0; k < nnzPerRow; k++) {
+          A.insert({i, col(gen)}, 1.0);
+        }
+      }
+      for (int j = 0; j < cols; j++) {
+        x.insert({j}, 1.0);
+      }
+      A.pack();
+      x.pack();
+
+      IndexVar i, j;
+      y(i) = A(i,j) * x(j);
+      y.compile();
+      y.assemble();
+      y.compute();
+
+      // Call plans run the kernel on every call.
+      CallPlan plan(y);
+      auto begin = std::chrono::steady_clock::now();
+      for (int r = 0; r < repeats; r++) {
+        plan.compute();
+      }
+      auto end = std::chrono::steady_clock::now();
+      double seconds = std::chrono::duration<double>(end - begin).count();
+
+      // Bytes streamed per product: pos, crd and vals of A, and y.
+      size_t nnz = A.getStorage().getValues().getSize();
+      double bytes = (rows + 1) * sizeof(int) + nnz * sizeof(int) +
+                     nnz * sizeof(double) + rows * sizeof(double);
+      std::cout << toString(placement) << "\t" << threads << " threads\t"
+                << (bytes * repeats / seconds / 1e9) << " GB/s";
+
+      // The bandwidth that each node's memory serves, from the streamed bytes
+      // that the node holds, shows whether the placement balances the nodes.
+      std::vector<double> bytesPerNode(numNodes, 0.0);
+      const Index& index = A.getStorage().getIndex();
+      countBytesPerNode(index.getModeIndex(1).getIndexArray(0), bytesPerNode);
+      countBytesPerNode(index.getModeIndex(1).getIndexArray(1), bytesPerNode);
+      countBytesPerNode(A.getStorage().getValues(), bytesPerNode);
+      countBytesPerNode(y.getStorage().getValues(), bytesPerNode);
+      for (int node = 0; node < numNodes; node++) {
+        std::cout << "\tnode " << node << ": "
+                  << (bytesPerNode[node] * repeats / seconds / 1e9) << " GB/s";
+      }
+      std::cout << std::endl;
+    }
+  }
+  setNumaPlacement(NumaPlacement::Default);
+}
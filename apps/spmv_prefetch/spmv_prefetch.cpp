@@ -0,0 +1,108 @@
+#include <iostream>
+#include <string>
+#include <random>
+#include <chrono>
+#include <vector>
+#include <algorithm>
+#include <limits>
+#include "taco.h"
+
+using namespace taco;
+
+/// Returns the seconds of the fastest of `repeats` products
+/// `y(i) = A(i,j) * x(j)`, compiled with the gathers of `x` prefetched
+/// `distance` positions ahead of their use, or without prefetching if
+/// `distance` is 0.  If `automatic` is set the product
+/// is compiled without a schedule and taco decides whether to prefetch.
+static double timeProduct(TensorBase A, Tensor<double> x, size_t distance,
+                          bool automatic, int repeats, double* checksum) {
+  Tensor<double> y("y", {A.getDimension(0)}, Format({Dense}));
+  IndexVar i("i"), j("j");
+  y(i) = A(i,j) * x(j);
+  taco_set_prefetch_large_gathers(automatic);
+  if (automatic) {
+    y.compile();
+  } else {
+    IndexStmt stmt = y.getAssignment().concretize();
+    y.compile(distance > 0 ? stmt.prefetch(j, distance) : stmt);
+  }
+  taco_set_prefetch_large_gathers(false);
+  y.assemble();
+  y.compute();
+
+  // Call plans run the kernel on every call.  The fastest call is the one
+  // that other processes disturbed least.
+  CallPlan plan(y);
+  double seconds = std::numeric_limits<double>::max();
+  for (int r = 0; r < repeats; r++) {
+    auto begin = std::chrono::steady_clock::now();
+    plan.compute();
+    auto end = std::chrono::steady_clock::now();
+    seconds = std::min(seconds,
+                       std::chrono::duration<double>(end - begin).count());
+  }
+
+  *checksum = 0.0;
+  const double* values = (const double*)y.getStorage().getValues().getData();
+  for (int r = 0; r < A.getDimension(0); r++) {
+    *checksum += values[r];
+  }
+  return seconds;
+}
+
+int main(int argc, char* argv[]) {
+  int rows = (argc > 1) ? std::stoi(argv[1]) : 1 << 20;
+  int nnzPerRow = (argc > 2) ? std::stoi(argv[2]) : 16;
+  const int repeats = 10;
+  const std::vector<size_t> distances = {0, 4, 8, 16, 32, 64};
+
+  std::cout << "A: " << rows << " rows in CSR with " << nnzPerRow
+            << " uniformly random nonzeros per row" << std::endl;
+  std::cout << "x (MiB)\tnone";
+  for (size_t distance : distances) {
+    if (distance > 0) {
+      std::cout << "\t" << distance;
+    }
+  }
+  std::cout << "\tauto\t(ns per nonzero)" << std::endl;
+
+  // A has the same number of nonzeros at every size, so only the footprint of
+  // the gathered x changes.
+  for (int mebibytes = 1; mebibytes <= 256; mebibytes *= 4) {
+    const int cols = mebibytes * (1 << 20) / sizeof(double);
+    std::default_random_engine gen(0);
+    std::uniform_int_distribution<int> col(0, cols - 1);
+    std::vector<int> pos(rows + 1);
+    std::vector<int> crd((size_t)rows * nnzPerRow);
+    std::vector<double> vals(crd.size(), 1.0);
+    for (int r = 0; r < rows; r++) {
+      pos[r] = r * nnzPerRow;
+      for (int k = 0; k < nnzPerRow; k++) {
+        crd[pos[r] + k] = col(gen);
+      }
+      std::sort(crd.begin() + pos[r], crd.begin() + pos[r] + nnzPerRow);
+    }
+    pos[rows] = rows * nnzPerRow;
+    TensorBase A = makeCSR("A", {rows, cols}, pos, crd, vals);
+    Tensor<double> x("x", {cols}, Format({Dense}));
+    x.pack();
+    double* xValues = (double*)x.getStorage().getValues().getData();
+    std::fill(xValues, xValues + cols, 1.0);
+
+    // A trailing ! marks a product whose result differs from the product
+    // without prefetching.
+    std::cout << mebibytes;
+    double expected = 0.0;
+    for (size_t distance : distances) {
+      double checksum;
+      double seconds = timeProduct(A, x, distance, false, repeats, &checksum);
+      expected = (distance == 0) ? checksum : expected;
+      std::cout << "\t" << (seconds * 1e9 / crd.size())
+                << (checksum == expected ? "" : "!");
+    }
+    double checksum;
+    double seconds = timeProduct(A, x, 0, true, repeats, &checksum);
+    std::cout << "\t" << (seconds * 1e9 / crd.size())
+              << (checksum == expected ? "" : "!") << std::endl;
+  }
+}
@@ -6,9 +6,11 @@
 #include <string>
 #include <utility>
 #include <random>
+#include <atomic>
 
 #include "taco/target.h"
 #include "taco/ir/ir.h"
+#include "taco/storage/allocator.h"
 
 namespace taco {
 namespace ir {
@@ -17,7 +19,9 @@ class Module {
 public:
   /// Create a module for some target
   Module(Target target=getTargetFromEnvironment())
-    : lib_handle(nullptr), moduleFromUserSource(false), target(target) {
+    : lib_handle(nullptr), moduleFromUserSource(false), target(target),
+      numCalls(0), bytesAllocated(0), peakBytes(0), workspaceBytes(nullptr),
+      releaseModuleWorkspaces(nullptr) {
     setJITLibname();
     setJITTmpdir();
   }
@@ -52,6 +56,11 @@ public:
   int callFuncPackedRaw(std::string name, std::vector<void*> args) {
     return callFuncPackedRaw(name, args.data());
   }
+
+  /// Call a raw function of this module, given a pointer to it from
+  /// `getFuncPtr`, and return the result.  This avoids looking up the
+  /// function on every call.
+  int callFuncPackedRaw(void* funcPtr, void** args);
   
   /// Call a function using the taco_tensor_t interface and return the result
   int callFuncPacked(std::string name, void** args) {
@@ -65,6 +74,15 @@ public:
   
   /// Set the source of the module
   void setSource(std::string source);
+
+  /// Get the statistics of the memory that calls of the module's functions
+  /// allocated through taco allocators.
+  KernelMemoryStats getMemoryStats() const;
+
+  /// Free the pooled workspaces of the generated kernels of all loaded
+  /// modules, which are allocated with the active allocator.  Kernels must not
+  /// run while the workspaces are released.
+  static void releaseWorkspaces();
   
 private:
   std::stringstream source;
@@ -78,6 +96,13 @@ private:
   bool moduleFromUserSource;
 
   Target target;
+
+  // memory statistics of the calls, updated concurrently
+  std::atomic<size_t> numCalls;
+  std::atomic<size_t> bytesAllocated;
+  std::atomic<size_t> peakBytes;
+  size_t (*workspaceBytes)();
+  void (*releaseModuleWorkspaces)();
   
   void setJITLibname();
   void setJITTmpdir();
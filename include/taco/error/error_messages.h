@@ -26,6 +26,21 @@ extern const std::string assemble_without_compile;
 // compute error messages
 extern const std::string compute_without_compile;
 
+// frozen tensor error messages
+extern const std::string modify_frozen_tensor;
+
+// kernel error messages
+extern const std::string hash_table_full;
+extern const std::string split_remainder;
+
+// call plan error messages
+extern const std::string call_plan_without_compile;
+
+// lowering error messages
+extern const std::string search_requires_int32_index;
+extern const std::string index_type_too_narrow;
+extern const std::string strided_positions_not_supported;
+
 // factory function error messages
 extern const std::string requires_matrix;
 
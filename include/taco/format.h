@@ -143,6 +143,25 @@ public:
   bool hasInsertCoord() const;
   bool isYieldPosPure() const;
 
+  /// Returns the compile-time size of the mode if the mode format stores
+  /// fixed-size dense blocks (see `DenseBlock`), and 0 otherwise.
+  int getBlockSize() const;
+
+  /// Returns the number of segments per chunk if the mode format is a sliced
+  /// ELLPACK format (see `SlicedEll`), and 0 otherwise.
+  int getChunkSize() const;
+
+  /// Returns the number of segments that are sorted by length if the mode
+  /// format is a sliced ELLPACK format, and 0 otherwise.
+  int getSortWindow() const;
+
+  /// Returns the number of hash table slots per segment if the mode format is
+  /// a hashed format (see `Hashed`), and 0 otherwise.
+  int getHashCapacity() const;
+
+  /// Returns true if the mode format is a bitmap format (see `Bitmap`).
+  bool isBitmap() const;
+
   std::vector<AttrQuery> getAttrQueries(
       std::vector<IndexVar> parentCoords, 
       std::vector<IndexVar> childCoords) const;
@@ -201,6 +220,59 @@ extern const Format DCSC;
 
 const Format COO(int order, bool isUnique = true, bool isOrdered = true, 
                  bool isAoS = false, const std::vector<int>& modeOrdering = {});
+
+/// A dense mode format that stores blocks of a fixed, compile-time size.  The
+/// size of a mode stored with this format must equal the block size.  Loops
+/// over such modes have constant trip counts, which lets the C compiler fully
+/// unroll and vectorize them.
+ModeFormat DenseBlock(int blockSize);
+
+/// Block compressed sparse row format for 4-order tensors A(ib,jb,ii,ji) that
+/// store a matrix as a CSR matrix of dense rowBlockSize x colBlockSize blocks,
+/// where row i = ib*rowBlockSize+ii and column j = jb*colBlockSize+ji (see
+/// `Tensor::block`).
+const Format BCSR(int rowBlockSize, int colBlockSize);
+
+/// Blocked compressed sparse fiber format for 2n-order tensors: n compressed
+/// levels over block coordinates followed by n dense levels that store a
+/// dense block of the given sizes per nonzero block.
+const Format BCSF(const std::vector<int>& blockSizes);
+
+/// A sliced ELLPACK (SELL-C-sigma) mode format.  Segments are grouped into
+/// chunks of chunkSize segments that are padded to equal length and stored
+/// column-major, after sorting segments by length within windows of
+/// sortWindow segments.  The format is read-only and must be the last level of
+/// a format.  Row sums such as `y(i) = A(i,j) * x(j)` are lowered to a loop
+/// over the slot columns of each chunk that sums the chunk's chunkSize rows in
+/// separate temporaries, which the C compiler vectorizes across, and padding
+/// entries are multiplied into the sums as zeros.  Other kernels iterate each
+/// segment separately with a loop strided by chunkSize.
+ModeFormat SlicedEll(int chunkSize, int sortWindow = 1);
+
+/// SELL-C-sigma format for matrices: a dense row level followed by a sliced
+/// ELLPACK column level.
+const Format SELL(int chunkSize, int sortWindow = 1);
+
+/// A hashed mode format whose segments are hash tables with `capacity` slots
+/// (a power of two).  Hashed modes support constant-time locate and insert, so
+/// they can store results that are written in unpredictable order, but they
+/// are iterated in no particular order.  Each segment must store fewer than
+/// `capacity` coordinates, and packing or computing a tensor that would store
+/// more raises an error.  An order-1 temporary with this format is a sparse
+/// workspace for `precompute` whose memory is proportional to `capacity`
+/// rather than to its dimension; its coordinates are tracked in a list that is
+/// sorted before they are consumed if the result is ordered.
+ModeFormat Hashed(int capacity);
+
+/// A bitmap mode format for moderately dense fibers.  Each segment stores its
+/// values densely, padded to a multiple of 64 coordinates, together with a
+/// bitmap of 64-bit words that marks the stored coordinates.  Bitmap levels
+/// support constant-time locate and insert, are iterated a word at a time with
+/// count-trailing-zeros, and are co-iterated with other bitmap levels by
+/// combining their words with bitwise AND (intersection) and OR (union).  An
+/// order-1 temporary with this format is a sparse workspace for `precompute`
+/// whose nonzeros are scanned in order.
+extern const ModeFormat Bitmap;
 /// @}
 
 /// True if all modes are dense.
@@ -562,9 +562,10 @@ public:
   /// variable.  Note that in the generated code, when the size of the
   /// inner index variable does not perfectly divide the original index
   /// variable, a \textit{tail strategy} is employed such as emitting a variable
-  /// sized loop that handles remaining iterations.
+  /// sized loop that handles remaining iterations (see `TailStrategy`).
   /// Preconditions: splitFactor is a positive nonzero integer
-  IndexStmt split(IndexVar i, IndexVar i1, IndexVar i2, size_t splitFactor) const; // TODO: TailStrategy
+  IndexStmt split(IndexVar i, IndexVar i1, IndexVar i2, size_t splitFactor,
+                  TailStrategy tailStrategy = TailStrategy::Guard) const;
 
   /// The divide transformation splits one index variable into
   /// two nested index variables, where the size of the outer
@@ -575,9 +576,11 @@ public:
   /// starting point of a tile can require an $O(n)$ or $O(\log (n))$
   /// search.  Therefore, if we want to parallelize a blocked
   /// loop, then we want a fixed number of blocks and not a number
-  /// proportional to the tensor size.
+  /// proportional to the tensor size.  The tail strategy handles the last
+  /// piece when divideFactor does not divide the original index variable.
   /// Preconditions: divideFactor is a positive nonzero integer
-  IndexStmt divide(IndexVar i, IndexVar i1, IndexVar i2, size_t divideFactor) const; // TODO: TailStrategy
+  IndexStmt divide(IndexVar i, IndexVar i1, IndexVar i2, size_t divideFactor,
+                   TailStrategy tailStrategy = TailStrategy::Guard) const;
 
 
   /// The reorder transformation swaps two directly nested index
@@ -611,6 +614,14 @@ public:
   /// order, such as atomic instructions, then the reductions must also
   /// be commutative.
   ///
+  /// Loops over the rows of a CSR matrix that compute a dense vector, such as
+  /// SpMV, can be parallelized over CPU threads with
+  /// ParallelUnit::CPUThreadMergePath.  This splits the merge path of the row
+  /// ends and nonzeros into tiles of equal length, so threads get equal shares
+  /// of rows plus nonzeros even if row lengths are skewed.  Rows that are
+  /// split between tiles are summed after the loop.  Results are
+  /// parallelized this way by default if an operand has skewed rows.
+  ///
   /// Preconditions:
   /// Once a parallelize transformation is used, no other transformations may be
   /// applied on the iteration graph as the preconditions for other transformations assume
@@ -624,8 +635,12 @@ public:
   /// into multiple sparse data structures cannot be parallelized as it is a while loop. Instead
   /// this loop can be parallelized by first strip-mining it with the split or divide
   /// transformation to create a parallel for loop with a serial nested while loop. Expressions
-  /// that have an output in a format that does not support random insert can also not be
-  /// parallelized. Parallelizing these expressions would require creating multiple copies of a
+  /// that have an output in a format that does not support random insert are parallelized on
+  /// CPUs with the NoRaces strategy by assembling the output in two phases (see `assemble`
+  /// with AssembleStrategy::Insert): a parallel symbolic phase counts the nonzeros of each
+  /// output fiber, a parallel prefix sum sizes the output exactly, and a parallel numeric phase
+  /// inserts the nonzeros at the computed offsets. Otherwise, parallelizing these expressions
+  /// would require creating multiple copies of a
   /// datastructure and then merging them, which is left to future work. Note that there is a special
   /// case where the output's sparsity pattern is the same as one of the inputs.
   /// This true of the popular sampled dense-dense matrix multiply (SDDMM),
@@ -706,6 +721,30 @@ public:
   /// Preconditions: unrollFactor is a positive nonzero integer
   IndexStmt unroll(IndexVar i, size_t unrollFactor) const;
 
+  /// The mergeby primitive specifies how the loop over i co-iterates its
+  /// sparse operands.  MergeStrategy::Gallop advances operands that lag
+  /// behind in an intersection with an exponential and binary search over
+  /// their coordinates instead of one position at a time, which takes
+  /// O(m log n) rather than O(m+n) steps to intersect m with n coordinates
+  /// when m is much smaller than n.  Tensors compiled without a schedule
+  /// gallop over loops whose operands' segments differ in average length by
+  /// a factor of 16 or more.
+  /// Preconditions: galloping only applies to intersections of ordered and
+  /// unique compressed levels with 32-bit coordinates; loops over other
+  /// operands fall back to the two-finger merge.
+  IndexStmt mergeby(IndexVar i, MergeStrategy strategy) const;
+
+  /// The prefetch primitive makes the loop over the positions of a sparse
+  /// operand prefetch the components of the dense operands that it gathers
+  /// (e.g. `x[crd[p+distance]]` in SpMV) `distance` iterations ahead of their
+  /// use, which hides the latency of cache misses that hardware prefetchers
+  /// cannot predict.  Tensors compiled without a schedule can prefetch large
+  /// gathers too (see `taco_set_prefetch_large_gathers`).
+  /// Preconditions: i is the index variable of a loop and distance is
+  /// positive; loops that do not iterate over positions or that run on GPUs do
+  /// not prefetch.
+  IndexStmt prefetch(IndexVar i, size_t distance) const;
+
   /// The assemble primitive specifies whether a result tensor should be 
   /// assembled by appending or inserting nonzeros into the result tensor.
   /// In the latter case, the transformation inserts additional loops to 
@@ -792,7 +831,7 @@ public:
   Forall() = default;
   Forall(const ForallNode*);
   Forall(IndexVar indexVar, IndexStmt stmt);
-  Forall(IndexVar indexVar, IndexStmt stmt, ParallelUnit parallel_unit, OutputRaceStrategy output_race_strategy, size_t unrollFactor = 0);
+  Forall(IndexVar indexVar, IndexStmt stmt, ParallelUnit parallel_unit, OutputRaceStrategy output_race_strategy, size_t unrollFactor = 0, MergeStrategy merge_strategy = MergeStrategy::TwoFinger, size_t prefetchDistance = 0);
 
   IndexVar getIndexVar() const;
   IndexStmt getStmt() const;
@@ -802,12 +841,16 @@ public:
 
   size_t getUnrollFactor() const;
 
+  MergeStrategy getMergeStrategy() const;
+
+  size_t getPrefetchDistance() const;
+
   typedef ForallNode Node;
 };
 
 /// Create a forall index statement.
 Forall forall(IndexVar i, IndexStmt stmt);
-Forall forall(IndexVar i, IndexStmt stmt, ParallelUnit parallel_unit, OutputRaceStrategy output_race_strategy, size_t unrollFactor = 0);
+Forall forall(IndexVar i, IndexStmt stmt, ParallelUnit parallel_unit, OutputRaceStrategy output_race_strategy, size_t unrollFactor = 0, MergeStrategy merge_strategy = MergeStrategy::TwoFinger, size_t prefetchDistance = 0);
 
 
 /// A where statment has a producer statement that binds a tensor variable in
@@ -305,8 +305,8 @@ struct YieldNode : public IndexStmtNode {
 };
 
 struct ForallNode : public IndexStmtNode {
-  ForallNode(IndexVar indexVar, IndexStmt stmt, ParallelUnit parallel_unit, OutputRaceStrategy  output_race_strategy, size_t unrollFactor = 0)
-      : indexVar(indexVar), stmt(stmt), parallel_unit(parallel_unit), output_race_strategy(output_race_strategy), unrollFactor(unrollFactor) {}
+  ForallNode(IndexVar indexVar, IndexStmt stmt, ParallelUnit parallel_unit, OutputRaceStrategy  output_race_strategy, size_t unrollFactor = 0, MergeStrategy merge_strategy = MergeStrategy::TwoFinger, size_t prefetchDistance = 0)
+      : indexVar(indexVar), stmt(stmt), parallel_unit(parallel_unit), output_race_strategy(output_race_strategy), unrollFactor(unrollFactor), merge_strategy(merge_strategy), prefetchDistance(prefetchDistance) {}
 
   void accept(IndexStmtVisitorStrict* v) const {
     v->visit(this);
@@ -317,6 +317,8 @@ struct ForallNode : public IndexStmtNode {
   ParallelUnit parallel_unit;
   OutputRaceStrategy  output_race_strategy;
   size_t unrollFactor = 0;
+  MergeStrategy merge_strategy = MergeStrategy::TwoFinger;
+  size_t prefetchDistance = 0;
 };
 
 struct WhereNode : public IndexStmtNode {
@@ -4,6 +4,8 @@
 #include <vector>
 #include <memory>
 
+#include "taco/storage/allocator.h"
+
 namespace taco {
 
 class Function;
@@ -19,12 +21,21 @@ class Module;
 /// They can be called to do all these things at once (`evaluate`), to only
 /// allocate memory and assemble indices (`assemble`), or to only compute
 /// component values (`compute`).
+///
+/// Kernels are immutable once compiled, and calling a kernel is thread-safe:
+/// concurrent calls may run the same kernel on different result storages,
+/// and may share operand storages that no call writes.  Each call passes its
+/// own copies of the argument `taco_tensor_t`s to the compiled functions, and
+/// workspaces are thread-local scratch of the compiled module.  Compiling
+/// kernels is not thread-safe.
 class Kernel {
 public:
   /// Construct an undefined kernel.
   Kernel();
 
-  /// Construct a kernel from relevant function pointers and a module.
+  /// Construct a kernel from relevant function pointers and a module.  The
+  /// function pointers are the `taco_tensor_t` shims of the module's
+  /// functions, which take their arguments packed in an array.
   Kernel(IndexStmt stmt, std::shared_ptr<ir::Module> module,
          void* evaluate, void* assemble, void* compute);
 
@@ -57,6 +68,9 @@ public:
   /// Check whether the kernel is defined.
   bool defined();
 
+  /// Get the statistics of the memory that calls of the kernel allocated.
+  KernelMemoryStats getMemoryStats() const;
+
   /// Print the tensor compute kernel.
   friend std::ostream& operator<<(std::ostream&, const Kernel&);
 
@@ -2,6 +2,7 @@
 #define TACO_PROVENANCE_GRAPH_H
 
 #include "taco/lower/iterator.h"
+#include "taco/ir_tags.h"
 
 namespace taco {
 struct IndexVarRelNode;
@@ -78,12 +79,14 @@ struct IndexVarRelNode : public util::Manageable<IndexVarRelNode>,
 /// The split relation takes a parentVar's iteration space and stripmines into an outervar that iterates over splitFactor-sized
 /// iterations over innerVar
 struct SplitRelNode : public IndexVarRelNode {
-  SplitRelNode(IndexVar parentVar, IndexVar outerVar, IndexVar innerVar, size_t splitFactor);
+  SplitRelNode(IndexVar parentVar, IndexVar outerVar, IndexVar innerVar, size_t splitFactor,
+               TailStrategy tailStrategy = TailStrategy::Guard);
 
   const IndexVar& getParentVar() const;
   const IndexVar& getOuterVar() const;
   const IndexVar& getInnerVar() const;
   const size_t& getSplitFactor() const;
+  TailStrategy getTailStrategy() const;
 
   void print(std::ostream& stream) const;
   bool equals(const SplitRelNode &rel) const;
@@ -117,7 +120,8 @@ bool operator==(const SplitRelNode&, const SplitRelNode&);
 // equal pieces. outerVar iterates over the number of pieces, and innerVar iterates
 // over each piece.
   struct DivideRelNode : public IndexVarRelNode {
-    DivideRelNode(IndexVar parentVar, IndexVar outerVar, IndexVar innerVar, size_t divFactor);
+    DivideRelNode(IndexVar parentVar, IndexVar outerVar, IndexVar innerVar, size_t divFactor,
+                  TailStrategy tailStrategy = TailStrategy::Guard);
 
     const IndexVar &getParentVar() const;
 
@@ -127,6 +131,8 @@ bool operator==(const SplitRelNode&, const SplitRelNode&);
 
     const size_t &getDivFactor() const;
 
+    TailStrategy getTailStrategy() const;
+
     void print(std::ostream &stream) const;
 
     bool equals(const DivideRelNode &rel) const;
@@ -411,6 +417,20 @@ public:
   /// a `.divide` scheduling operation.
   bool isDivided(IndexVar indexVar) const;
 
+  /// getTailStrategy returns the tail strategy of the split or divide of the
+  /// target IndexVar, or TailStrategy::Guard if it was not split or divided.
+  TailStrategy getTailStrategy(IndexVar indexVar) const;
+
+  /// getSplitFactor returns the factor of the split or divide of the target
+  /// IndexVar, or 0 if it was not split or divided.
+  size_t getSplitFactor(IndexVar indexVar) const;
+
+  /// isPredicatedTail returns whether the target IndexVar is the inner variable
+  /// of a split or divide with TailStrategy::Predicate that is not transformed
+  /// further and whose outer variable is defined before it, in which case its
+  /// iteration bounds are clamped to the end of its parent's iteration space.
+  bool isPredicatedTail(IndexVar indexVar, std::vector<IndexVar> derivedVarOrder) const;
+
 private:
   std::map<IndexVar, IndexVarRel> childRelMap;
   std::map<IndexVar, IndexVarRel> parentRelMap;
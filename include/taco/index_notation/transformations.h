@@ -214,8 +214,11 @@ std::ostream &operator<<(std::ostream &, const SetAssembleStrategy&);
  * 1. The loop iterates over only one data structure,
  * 2. Every result iterator has the insert capability, and
  * 3. No cross-thread reductions.
+ * If balanceNonzeros is set, loops over the rows of a CSR matrix are
+ * parallelized with merge-path partitioning (ParallelUnit::CPUThreadMergePath)
+ * when possible.
  */
-IndexStmt parallelizeOuterLoop(IndexStmt stmt);
+IndexStmt parallelizeOuterLoop(IndexStmt stmt, bool balanceNonzeros = false);
 
 /**
  * Topologically reorder ForAlls so that all tensors are iterated in order.
@@ -67,7 +67,8 @@ enum class IRNodeType {
   GetProperty,
   Continue,
   Sort,
-  Break
+  Break,
+  Prefetch
 };
 
 enum class TensorProperty {
@@ -611,10 +612,12 @@ struct For : public StmtNode<For> {
   int vec_width;  // vectorization width
   ParallelUnit parallel_unit;
   size_t unrollFactor;
+  std::vector<Expr> reductionVars;  // scalars summed across parallel iterations
   
   static Stmt make(Expr var, Expr start, Expr end, Expr increment,
                    Stmt contents, LoopKind kind=LoopKind::Serial,
-                   ParallelUnit parallel_unit=ParallelUnit::NotParallel, size_t unrollFactor=0, int vec_width=0);
+                   ParallelUnit parallel_unit=ParallelUnit::NotParallel, size_t unrollFactor=0, int vec_width=0,
+                   std::vector<Expr> reductionVars={});
   
   static const IRNodeType _type_info = IRNodeType::For;
 };
@@ -640,10 +643,11 @@ struct Function : public StmtNode<Function> {
   Stmt body;
   std::vector<Expr> inputs;
   std::vector<Expr> outputs;
+  Expr status;  // value returned by the function (0 if undefined)
   
   static Stmt make(std::string name,
                    std::vector<Expr> outputs, std::vector<Expr> inputs,
-                   Stmt body);
+                   Stmt body, Expr status=Expr());
   
   std::pair<std::vector<Datatype>,Datatype> getReturnType() const;
   
@@ -742,6 +746,18 @@ struct Sort : public StmtNode<Sort> {
   static const IRNodeType _type_info = IRNodeType::Sort;
 };
 
+/** Prefetch the element of an array at a location into the cache, as a hint
+ * that the element will be loaded soon.
+ */
+struct Prefetch : public StmtNode<Prefetch> {
+  Expr arr;
+  Expr loc;
+
+  static Stmt make(Expr arr, Expr loc);
+
+  static const IRNodeType _type_info = IRNodeType::Prefetch;
+};
+
 /** A print statement.
  * Takes in a printf-style format string and Exprs to pass
  * for the values.
@@ -768,6 +784,11 @@ struct GetProperty : public ExprNode<GetProperty> {
   static Expr make(Expr tensor, TensorProperty property, int mode=0);
   static Expr make(Expr tensor, TensorProperty property, int mode,
                    int index, std::string name);
+
+  /// Construct an index array property whose elements have the given type
+  /// (e.g., a 16-bit coordinate array).
+  static Expr make(Expr tensor, TensorProperty property, int mode,
+                   int index, std::string name, Datatype type);
   
   static const IRNodeType _type_info = IRNodeType::GetProperty;
 };
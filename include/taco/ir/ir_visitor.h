@@ -50,6 +50,7 @@ struct Print;
 struct GetProperty;
 struct Sort;
 struct Break;
+struct Prefetch;
 
 /// Extend this class to visit every node in the IR.
 class IRVisitorStrict {
@@ -102,6 +103,7 @@ public:
   virtual void visit(const GetProperty*) = 0;
   virtual void visit(const Sort*) = 0;
   virtual void visit(const Break*) = 0;
+  virtual void visit(const Prefetch*) = 0;
 };
 
 
@@ -157,6 +159,7 @@ public:
   virtual void visit(const GetProperty* op);
   virtual void visit(const Sort* op);
   virtual void visit(const Break* op);
+  virtual void visit(const Prefetch* op);
 };
 
 }}
@@ -12,5 +12,10 @@ ir::Expr simplify(const ir::Expr& expr);
 /// Simplifies a statement (e.g. by applying constant copy propagation).
 ir::Stmt simplify(const ir::Stmt& stmt);
 
+/// Removes redundant integer arithmetic from a statement, by hoisting
+/// loop-invariant address computations and loop bounds out of for loops and
+/// by reusing variables that were declared with the same value.
+ir::Stmt hoistLoopInvariants(const ir::Stmt& stmt);
+
 }}
 #endif
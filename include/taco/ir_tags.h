@@ -8,14 +8,21 @@ namespace taco {
 /// ParallelUnit::GPUBlock must be used with GPUThread to create blocks of GPU threads
 /// ParallelUnit::GPUWarp can be optionally used to allow for GPU warp-level primitives
 /// ParallelUnit::GPUThread causes for every iteration to be executed on a separate GPU thread
+/// ParallelUnit::CPUThreadMergePath parallelizes a loop over the rows of a CSR matrix over CPU
+///   threads by splitting the merge path of the rows and nonzeros into tiles of equal length
 enum class ParallelUnit {
-  NotParallel, DefaultUnit, GPUBlock, GPUWarp, GPUThread, CPUThread, CPUVector, CPUThreadGroupReduction, GPUBlockReduction, GPUWarpReduction
+  NotParallel, DefaultUnit, GPUBlock, GPUWarp, GPUThread, CPUThread, CPUVector, CPUThreadGroupReduction, GPUBlockReduction, GPUWarpReduction, CPUThreadMergePath
 };
 extern const char *ParallelUnit_NAMES[];
 
 /// OutputRaceStrategy::NoRaces raises a compile-time error if an output race exists
 /// OutputRaceStrategy::Atomics replace racing instructions with atomics
+///   (on CPUs, scalar outputs that iterations race on are instead summed with an OpenMP
+///   reduction clause, and small dense tensor outputs are copied per thread)
 /// OutputRaceStrategy::Temporary uses a temporary array for outputs that is serially reduced
+///   (on CPUs, scalar outputs that iterations race on are instead summed with an OpenMP
+///   reduction clause, and tensor outputs are copied per thread and the copies are reduced
+///   in parallel, or updated with atomics if they are large or sparse)
 /// OutputRaceStrategy::ParallelReduction uses reduction operations across a warp/vector
 /// OutputRaceStrategy::IgnoreRaces allows the user to specify that races can be safely ignored
 enum class OutputRaceStrategy {
@@ -33,6 +40,33 @@ enum class AssembleStrategy {
 };
 extern const char *AssembleStrategy_NAMES[];
 
+/// MergeStrategy::TwoFinger co-iterates the sparse operands of a loop by advancing
+///   every operand that is at the smallest coordinate by one position
+/// MergeStrategy::Gallop co-iterates the sparse operands of an intersection by
+///   advancing every operand that is behind the largest coordinate with an exponential
+///   and binary search, which skips over long runs of coordinates that are absent from
+///   a much shorter operand
+enum class MergeStrategy {
+  TwoFinger, Gallop
+};
+extern const char *MergeStrategy_NAMES[];
+
+/// TailStrategy::Guard guards every iteration of the inner loop of a split or divide
+///   against running past the end of the original index variable
+/// TailStrategy::Peel tests once per strip whether it is the last, partial strip, and
+///   runs full strips in a clone of the inner loop without guards
+/// TailStrategy::RoundUp emits no guards, and requires that the size of the original
+///   index variable is a multiple of the split (or divide) factor, which generated code
+///   checks before it runs; index variables whose size is only known inside the loop
+///   nest (e.g. derived position variables) are guarded as with TailStrategy::Guard
+/// TailStrategy::Predicate clamps the trip count of the inner loop to the iterations
+///   that remain in the last strip, so that the C compiler can predicate (or peel) the
+///   tail of a vectorized inner loop
+enum class TailStrategy {
+  Guard, Peel, RoundUp, Predicate
+};
+extern const char *TailStrategy_NAMES[];
+
 }
 
 #endif //TACO_IR_TAGS_H
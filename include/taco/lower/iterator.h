@@ -77,6 +77,8 @@ public:
   /// Capabilities supported by levels being iterated.
   bool hasCoordIter() const;
   bool hasPosIter() const;
+  bool hasBitmapIter() const;
+  bool hasChunkIter() const;
   bool hasLocate() const;
   bool hasInsert() const;
   bool hasAppend() const;
@@ -141,6 +143,15 @@ public:
   ModeFunction posBounds(const ir::Expr& parentPos) const;
   ModeFunction posAccess(const ir::Expr& pos, 
                          const std::vector<ir::Expr>& coords) const;
+
+  /// Return code for level function that implements bitmap iteration.
+  ModeFunction bitmapBounds(const ir::Expr& parentPos) const;
+
+  /// Return code for level functions that implement chunk iteration.
+  ModeFunction chunkBounds(const ir::Expr& chunk, 
+                           const ir::Expr& numSegments) const;
+  ModeFunction chunkAccess(const ir::Expr& chunk, const ir::Expr& lane,
+                           const ir::Expr& numSegments) const;
   
   /// Returns code for level function that implements locate capability.
   ModeFunction locate(const std::vector<ir::Expr>& coords) const;
@@ -174,6 +185,11 @@ public:
   ir::Stmt getSeqInsertEdge(const ir::Expr& parentPos, 
       const std::vector<ir::Expr>& coords, 
       const std::vector<AttrQueryResult>& queries) const;
+  ir::Stmt getParInsertEdge(const ir::Expr& parentPos, 
+      const std::vector<ir::Expr>& coords, 
+      const std::vector<AttrQueryResult>& queries) const;
+  ir::Stmt getParFinalizeEdges(const ir::Expr& prevSize, 
+      const std::vector<AttrQueryResult>& queries) const;
   ir::Stmt getInitCoords(const ir::Expr& prevSize, 
       const std::vector<AttrQueryResult>& queries) const;
   ir::Stmt getInitYieldPos(const ir::Expr& prevSize) const;
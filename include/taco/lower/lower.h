@@ -53,5 +53,33 @@ ir::Stmt lower(IndexStmt stmt, std::string functionName,
 /// filled with the a reason.
 bool isLowerable(IndexStmt stmt, std::string* reason=nullptr);
 
+/// Enable/disable persistent workspaces.  When enabled (the default), CPU
+/// kernels acquire the arrays of their `where`/`precompute` workspaces from a
+/// thread-local pool owned by the compiled module, instead of allocating and
+/// freeing them on every call.  Pooled arrays grow to the largest size any
+/// call has needed and are kept for later calls, so steady-state calls do not
+/// allocate workspace memory.  A thread's pool is freed when the thread exits
+/// or when the module is unloaded.
+/// @{
+void setPersistentWorkspacesEnabled(bool enabled);
+bool shouldUsePersistentWorkspaces();
+/// @}
+
+/// Bits of the status that generated functions return, which is 0 if they
+/// succeed.
+enum KernelStatus {
+  /// A row had more coordinates than a hash table segment can hold.
+  KERNEL_HASH_TABLE_FULL = 1 << 0,
+  /// The dimension of an index variable split with `TailStrategy::RoundUp` is
+  /// not a multiple of the split factor.  The function returns before it
+  /// writes any results.
+  KERNEL_SPLIT_REMAINDER = 1 << 1
+};
+
+/// The number of pooled workspace arrays of each fill (none, zeros, or ones)
+/// that a compiled module keeps per thread.  Kernels allocate further
+/// workspace arrays on every call.
+const int MAX_PERSISTENT_WORKSPACES = 64;
+
 }
 #endif
@@ -9,6 +9,7 @@
 #include <taco/index_notation/index_notation.h>
 
 #include "taco/lower/iterator.h"
+#include "taco/lower/lower.h"
 #include "taco/util/scopedset.h"
 #include "taco/util/uncopyable.h"
 #include "taco/ir_tags.h"
@@ -74,6 +75,18 @@ protected:
   /// used for vectorized and unrolled loops
   virtual ir::Stmt lowerForallCloned(Forall forall);
 
+  /// Lower a parallel forall with the Temporary or Atomics output race
+  /// strategy, whose iterations reduce into thread-private copies of the
+  /// results they race on that are summed up after the loop.  Scalar results
+  /// are summed with a reduction clause of the loop.
+  virtual ir::Stmt lowerForallPrivatized(Forall forall);
+
+  /// Lower a forall over the rows of a CSR matrix that is parallelized with
+  /// merge-path partitioning.  The merge path of the row ends and nonzeros is
+  /// split into tiles of equal length that are processed in parallel, and
+  /// rows that are split between tiles are summed after the loop.
+  virtual ir::Stmt lowerForallMergePath(Forall forall);
+
   /// Lower a forall that iterates over all the coordinates in the forall index
   /// var's dimension, and locates tensor positions from the locate iterators.
   virtual ir::Stmt lowerForallDimension(Forall forall,
@@ -93,6 +106,16 @@ protected:
                                                 ir::Stmt recoveryStmt);
 
 
+  /// Lower a forall that scans the bit guard of a bitmap workspace in order
+  /// and locates tensor positions from the locate iterators.
+  virtual ir::Stmt lowerForallBitmapWorkspace(Forall forall, 
+                                              TensorVar workspace,
+                                              std::vector<Iterator> locaters,
+                                              std::vector<Iterator> inserters,
+                                              std::vector<Iterator> appenders,
+                                              std::set<Access> reducedAccesses,
+                                              ir::Stmt recoveryStmt);
+
   /// Lower a forall that iterates over the coordinates in the iterator, and
   /// locates tensor positions from the locate iterators.
   virtual ir::Stmt lowerForallCoordinate(Forall forall, Iterator iterator,
@@ -119,6 +142,30 @@ protected:
                                        std::set<Access> reducedAccesses,
                                        ir::Stmt recoveryStmt);
 
+  /// Lower a forall whose lattice iterators all have bitmap iteration.  The
+  /// loop scans the bitmaps a word at a time, combining the words of the
+  /// iterators of each lattice point with bitwise AND and the lattice points
+  /// with bitwise OR, and visits the set bits with count-trailing-zeros.
+  virtual ir::Stmt lowerForallBitmap(Forall forall, MergeLattice lattice,
+                                     std::set<Access> reducedAccesses,
+                                     ir::Stmt recoveryStmt);
+
+  /// Returns the chunk iterator of a forall that sums the segments of a
+  /// sliced ELLPACK level into the rows of a result, as in
+  /// `forall(i, where(y(i) = t, forall(j, t += A(i,j) * x(j))))`, or an
+  /// undefined iterator if the forall does not have that form.
+  Iterator getChunkIterator(Forall forall);
+
+  /// Lower a forall returned by getChunkIterator to a loop over the chunks of
+  /// the iterator's level.  A loop over each chunk's slot columns sums every
+  /// column into one scalar temporary per lane, unrolled across the lanes so
+  /// that the compiler vectorizes it, and the lanes are then stored into the
+  /// rows of the chunk.
+  virtual ir::Stmt lowerForallChunks(Forall forall, Iterator iterator,
+                                     std::vector<Iterator> locators,
+                                     std::vector<Iterator> inserters,
+                                     ir::Stmt recoveryStmt);
+
   /// Used in lowerForallFusedPosition to generate code to
   /// search for the start of the iteration of the loop (a separate kernel on GPUs)
   virtual ir::Stmt searchForFusedPositionStart(Forall forall, Iterator posIterator);
@@ -141,13 +188,16 @@ protected:
      * \param statement
      *      A concrete index notation statement to compute at the points in the
      *      sparse iteration space described by the merge lattice.
+     * \param mergeStrategy
+     *      How the merge points of the lattice advance their iterators.
      *
      * \return
      *       IR code to compute the forall loop.
      */
   virtual ir::Stmt lowerMergeLattice(MergeLattice lattice, IndexVar coordinateVar,
                                      IndexStmt statement, 
-                                     const std::set<Access>& reducedAccesses);
+                                     const std::set<Access>& reducedAccesses,
+                                     MergeStrategy mergeStrategy = MergeStrategy::TwoFinger);
 
   virtual ir::Stmt resolveCoordinate(std::vector<Iterator> mergers, ir::Expr coordinate, bool emitVarDecl);
 
@@ -164,10 +214,14 @@ protected:
      *      coordinate the merge point is at.
      *      A concrete index notation statement to compute at the points in the
      *      sparse iteration space region described by the merge point.
+     * \param mergeStrategy
+     *      How the merge point advances its iterators.  Intersections that
+     *      cannot gallop (see `canGallop`) use the two-finger merge.
      */
   virtual ir::Stmt lowerMergePoint(MergeLattice pointLattice,
                                    ir::Expr coordinate, IndexVar coordinateVar, IndexStmt statement,
-                                   const std::set<Access>& reducedAccesses, bool resolvedCoordDeclared);
+                                   const std::set<Access>& reducedAccesses, bool resolvedCoordDeclared,
+                                   MergeStrategy mergeStrategy = MergeStrategy::TwoFinger);
 
   /// Lower a merge lattice to cases.
   virtual ir::Stmt lowerMergeCases(ir::Expr coordinate, IndexVar coordinateVar, IndexStmt stmt,
@@ -350,6 +404,11 @@ protected:
   /// temporary can be automaticallty supported by the compiler.
   std::pair<bool,bool> canAccelerateDenseTemp(Where where);
 
+  /// Returns true iff the temporary is a hashed workspace that is accelerated,
+  /// so that its values are stored by hash table slot.  Hashed workspaces that
+  /// cannot be accelerated are lowered as dense workspaces.
+  bool isHashedWorkspace(TensorVar temporary) const;
+
   /// Initializes a temporary workspace
   std::vector<ir::Stmt> codeToInitializeTemporary(Where where);
   std::vector<ir::Stmt> codeToInitializeTemporaryParallel(Where where, ParallelUnit parallelUnit);
@@ -357,9 +416,37 @@ protected:
   /// Gets the size of a temporary tensorVar in the where statement
   ir::Expr getTemporarySize(Where where);
 
+  /// Gets the product of the dimensions of a temporary tensorVar in the where
+  /// statement, which is its size unless it is a hashed workspace
+  ir::Expr getTemporaryDimensionSize(Where where);
+
+  /// Gets the number of elements of the bit guard of an accelerated workspace
+  ir::Expr getBitGuardSize(Where where);
+
   /// Initializes helper arrays to give dense workspaces sparse acceleration
   std::vector<ir::Stmt> codeToInitializeDenseAcceleratorArrays(Where where, bool parallel = false);
 
+  /// Allocates a workspace array of `size` elements, declaring it first if
+  /// `declare` is true, and initializes its elements to `fill` if `fill` is
+  /// defined.  Kernels with persistent workspaces instead acquire the array
+  /// from the module's workspace pool, which only initializes it when the
+  /// pooled buffer is allocated or grows, so the kernel must restore the
+  /// elements of an array acquired with a fill before it returns.  Pool slots
+  /// are numbered separately for each fill, since the assemble and compute
+  /// functions of a module share one pool.
+  ir::Stmt codeToAllocateWorkspace(ir::Expr array, ir::Expr size, bool declare,
+                                   ir::Expr fill = ir::Expr());
+
+  /// Frees a workspace array unless it was acquired from the workspace pool.
+  ir::Stmt codeToFreeWorkspace(ir::Expr array);
+
+  /// Prefetches the components that a loop over the positions of `iterator`
+  /// gathers through `locators` (e.g. `x[crd[p]]`), `distance` positions
+  /// ahead of the loop's position variable but before its end bound.
+  ir::Stmt codeToPrefetchGathers(Iterator iterator,
+                                 std::vector<Iterator> locators,
+                                 ir::Expr endBound, size_t distance);
+
   /// Recovers a derived indexvar from an underived variable.
   ir::Stmt codeToRecoverDerivedIndexVar(IndexVar underived, IndexVar indexVar, bool emitVarDecl);
 
@@ -369,9 +456,26 @@ protected:
 
   ir::Stmt codeToLoadCoordinatesFromPosIterators(std::vector<Iterator> iterators, bool declVars);
 
+  /// Returns true if the top point of the lattice intersects ordered and
+  /// unique compressed levels whose iterators can advance by galloping.
+  bool canGallop(MergeLattice pointLattice);
+
+  /// Advance all mergers past the coordinate if they all store it, and
+  /// otherwise gallop each merger to the first position whose coordinate is
+  /// not smaller than the coordinate.
+  ir::Stmt codeToGallopIteratorVars(ir::Expr coordinate,
+                                    std::vector<Iterator> mergers);
+
   /// Create statements to append coordinate to result modes.
   ir::Stmt appendCoordinate(std::vector<Iterator> appenders, ir::Expr coord);
 
+  /// Create statements to insert coordinate into result modes.
+  ir::Stmt insertCoordinate(std::vector<Iterator> inserters, ir::Expr coord);
+
+  /// Sets `flag` in the status that the function returns.  Threads of a
+  /// parallel loop set the flag atomically.
+  ir::Stmt setStatus(KernelStatus flag);
+
   /// Create statements to append positions to result modes.
   ir::Stmt generateAppendPositions(std::vector<Iterator> appenders);
 
@@ -394,6 +498,10 @@ protected:
   /// Check whether the statement writes to a result tensor
   bool hasStores(ir::Stmt stmt);
 
+  /// Check whether iterations past the end of a split or divided index
+  /// variable must be guarded against, given its tail strategy
+  bool needsTailGuard(IndexVar indexVar);
+
   std::pair<std::vector<Iterator>,std::vector<Iterator>>
   splitAppenderAndInserters(const std::vector<Iterator>& results);
 
@@ -468,6 +576,19 @@ private:
   /// Map form temporary to bitGuard var if accelerating dense workspace
   std::map<TensorVar, ir::Expr> tempToBitGuard;
 
+  /// Temporaries declared with a bitmap format, which are lowered as dense
+  /// workspaces whose bit guard is a bitmap
+  std::set<TensorVar> bitmapWorkspaces;
+
+  /// Temporaries declared with a hashed format, mapped to their number of hash
+  /// table slots.  They are lowered as accelerated workspaces whose values are
+  /// stored by slot and whose bit guard holds the coordinate of each slot.
+  std::map<TensorVar, int> hashedWorkspaces;
+
+  /// Map from hashed workspaces to the variable holding the slot of the
+  /// current coordinate
+  std::map<TensorVar, ir::Expr> hashedWorkspaceSlots;
+
   std::set<TensorVar> guardedTemps;
 
   /// Map from result tensors to variables tracking values array capacity.
@@ -505,6 +626,28 @@ private:
 
   bool emitUnderivedGuards = true;
 
+  bool privatizeRacingResults = true;
+
+  bool partitionMergePaths = true;
+
+  /// Whether to acquire workspace arrays from the module's workspace pool
+  bool usePersistentWorkspaces = false;
+
+  /// Workspace arrays acquired from the pool, which each have a pool slot
+  std::map<ir::Expr, int> persistentWorkspaceSlots;
+
+  /// The number of pool slots used by arrays of each fill byte (-1 if the
+  /// array is not filled).  The pool keeps the arrays of each fill apart, so
+  /// that the functions of a module only share slots whose arrays they all
+  /// restore to the same fill.
+  std::map<int, int> numPersistentWorkspaces;
+
+  /// The status that the function returns, defined if the function can fail
+  ir::Expr status;
+
+  /// Results that the enclosing parallel loop reduces into without atomics
+  std::set<TensorVar> parallelReducedResults;
+
   int inParallelLoopDepth = 0;
 
   std::map<ParallelUnit, ir::Expr> parallelUnitSizes;
@@ -73,8 +73,12 @@ std::ostream& operator<<(std::ostream&, const Mode&);
 class ModePack {
 public:
   ModePack();
+
+  /// Construct a mode pack.  If `arrayTypes` is non-empty then the ith index
+  /// array of the pack is given element type `arrayTypes[i]` (e.g., to store
+  /// coordinates in 16 bits); otherwise index arrays hold 32-bit integers.
   ModePack(size_t numModes, ModeFormat modeType, ir::Expr tensor, int mode, 
-           int level);
+           int level, const std::vector<Datatype>& arrayTypes = {});
 
   /// Returns number of tensor modes belonging to mode pack.
   size_t getNumModes() const;
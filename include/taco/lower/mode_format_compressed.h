@@ -47,6 +47,13 @@ public:
                             std::vector<ir::Expr> coords,
                             std::vector<AttrQueryResult> queries, 
                             Mode mode) const override;
+  ir::Stmt getParInsertEdge(ir::Expr parentPos, 
+                            std::vector<ir::Expr> coords,
+                            std::vector<AttrQueryResult> queries, 
+                            Mode mode) const override;
+  ir::Stmt getParFinalizeEdges(ir::Expr prevSize, 
+                               std::vector<AttrQueryResult> queries, 
+                               Mode mode) const override;
   ir::Stmt getInitCoords(ir::Expr prevSize, 
                          std::vector<AttrQueryResult> queries, 
                          Mode mode) const override;
@@ -10,7 +10,8 @@ public:
   using ModeFormatImpl::getInsertCoord;
 
   DenseModeFormat();
-  DenseModeFormat(const bool isOrdered, const bool isUnique, const bool isZeroless);
+  DenseModeFormat(const bool isOrdered, const bool isUnique, const bool isZeroless,
+                  const int blockSize = 0);
 
   ~DenseModeFormat() override {}
 
@@ -36,8 +37,16 @@ public:
   std::vector<ir::Expr> getArrays(ir::Expr tensor, int mode, 
                                   int level) const override;
 
+  /// Returns the compile-time size of the mode if it stores fixed-size dense
+  /// blocks, and 0 if its size is given by the tensor dimension.
+  int getBlockSize() const;
+
 protected:
   ir::Expr getSizeArray(ModePack pack) const;
+
+  bool equals(const ModeFormatImpl& other) const override;
+
+  const int blockSize;
 };
 
 }
@@ -0,0 +1,57 @@
+#ifndef TACO_MODE_FORMAT_HASHED_H
+#define TACO_MODE_FORMAT_HASHED_H
+
+#include "taco/lower/mode_format_impl.h"
+
+namespace taco {
+
+/// A hashed mode format.  Each segment of the mode is an open-addressing hash
+/// table with `capacity` slots, which stores the coordinates of the segment in
+/// a crd array (empty slots hold -1).  Coordinates are located and inserted in
+/// expected constant time, but are iterated in no particular order.  Each
+/// segment must store fewer than `capacity` coordinates.
+class HashedModeFormat : public ModeFormatImpl {
+public:
+  using ModeFormatImpl::getInsertCoord;
+
+  HashedModeFormat(int capacity);
+  HashedModeFormat(bool isUnique, bool isZeroless, int capacity);
+
+  ~HashedModeFormat() override {}
+
+  ModeFormat copy(std::vector<ModeFormat::Property> properties) const override;
+
+  ModeFunction posIterBounds(ir::Expr parentPos, Mode mode) const override;
+  ModeFunction posIterAccess(ir::Expr pos, std::vector<ir::Expr> coords,
+                             Mode mode) const override;
+
+  ModeFunction locate(ir::Expr parentPos, std::vector<ir::Expr> coords,
+                      Mode mode) const override;
+
+  ir::Stmt getInsertCoord(ir::Expr p, const std::vector<ir::Expr>& i,
+                          Mode mode) const override;
+  ir::Expr getWidth(Mode mode) const override;
+  ir::Stmt getInsertInitCoords(ir::Expr pBegin, ir::Expr pEnd,
+                               Mode mode) const override;
+  ir::Stmt getInsertInitLevel(ir::Expr szPrev, ir::Expr sz,
+                              Mode mode) const override;
+  ir::Stmt getInsertFinalizeLevel(ir::Expr szPrev, ir::Expr sz,
+                                  Mode mode) const override;
+
+  std::vector<ir::Expr> getArrays(ir::Expr tensor, int mode,
+                                  int level) const override;
+
+  /// Returns the number of hash table slots per segment.
+  int getCapacity() const;
+
+protected:
+  ir::Expr getCoordArray(ModePack pack) const;
+
+  bool equals(const ModeFormatImpl& other) const override;
+
+  const int capacity;
+};
+
+}
+
+#endif
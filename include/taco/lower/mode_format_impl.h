@@ -140,7 +140,9 @@ public:
 
 
   /// The position iteration capability's iterator function computes a range
-  /// [result[0], result[1]) of positions to iterate over.
+  /// [result[0], result[1]) of positions to iterate over.  Mode formats whose
+  /// positions are not contiguous may return the stride between consecutive
+  /// positions as result[2]; the stride is 1 otherwise.
   /// `pos_iter_bounds(p_{k−1}) -> begin_{k}, end_{k}`
   virtual ModeFunction posIterBounds(ir::Expr parentPos, Mode mode) const;
 
@@ -152,6 +154,29 @@ public:
                                      std::vector<ir::Expr> coords,
                                      Mode mode) const;
 
+  /// The bitmap iteration capability's bounds function returns the array of
+  /// 64-bit words that mark stored positions (result[0]), the first word of
+  /// the segment (result[1]), and the number of words per segment (result[2]).
+  /// Bit b of the segment's word w marks coordinate 64*w+b, which is stored in
+  /// position 64*(result[1]+w)+b.
+  /// `bitmap_iter_bounds(p_{k−1}) -> bits_{k}, begin_{k}, words_{k}`
+  virtual ModeFunction bitmapIterBounds(ir::Expr parentPos, Mode mode) const;
+
+  /// The chunk iteration capability's bounds function returns the first
+  /// (result[0]) and last (result[1]) position of chunk c, where the level
+  /// has n segments grouped into chunks of C segments.  The position
+  /// `begin + k*C + l` stores the kth coordinate of the chunk's lth segment, or
+  /// a zero padding entry if that segment has k or fewer coordinates.
+  /// `chunk_iter_bounds(c, n) -> begin_{c}, end_{c}`
+  virtual ModeFunction chunkIterBounds(ir::Expr chunk, ir::Expr numSegments,
+                                       Mode mode) const;
+
+  /// The chunk iteration capability's access function returns the segment
+  /// (parent position) stored in lane l of chunk c (result[0]).
+  /// `chunk_iter_access(c, l, n) -> p_{k-1}`
+  virtual ModeFunction chunkIterAccess(ir::Expr chunk, ir::Expr lane,
+                                       ir::Expr numSegments, Mode mode) const;
+
 
   /// The locate capability locates the position of a coordinate (result[0])
   /// and reports if the coordinate could not be found (result[1]).
@@ -231,6 +256,21 @@ public:
   getFinalizeYieldPos(ir::Expr prevSize, Mode mode) const;
   /// @}
 
+  /// Level functions that let ungrouped insertion insert edges in parallel.
+  /// `getParInsertEdge` inserts the edges of one parent position independently
+  /// of all other parent positions, after which `getParFinalizeEdges` combines
+  /// the edges of all parent positions.  Mode formats that return undefined
+  /// statements have their edges inserted sequentially by `getSeqInsertEdge`.
+  /// @{
+  virtual ir::Stmt
+  getParInsertEdge(ir::Expr parentPos, std::vector<ir::Expr> coords,
+                   std::vector<AttrQueryResult> queries, Mode mode) const;
+
+  virtual ir::Stmt
+  getParFinalizeEdges(ir::Expr prevSize, std::vector<AttrQueryResult> queries,
+                      Mode mode) const;
+  /// @}
+
   /// Returns arrays associated with a tensor mode
   virtual std::vector<ir::Expr>
   getArrays(ir::Expr tensor, int mode, int level) const = 0;
@@ -0,0 +1,70 @@
+#ifndef TACO_MODE_FORMAT_SLICED_ELL_H
+#define TACO_MODE_FORMAT_SLICED_ELL_H
+
+#include "taco/lower/mode_format_impl.h"
+
+namespace taco {
+
+/// A sliced ELLPACK (SELL-C-sigma) mode format.  The segments (rows) of the
+/// mode are grouped into chunks of `chunkSize` segments, each chunk is padded
+/// to the length of its longest segment, and the coordinates of a chunk are
+/// stored column-major so that the kth coordinates of the segments in a chunk
+/// are contiguous.  Segments are sorted by decreasing length within windows of
+/// `sortWindow` segments before they are assigned to chunks, to reduce padding.
+///
+/// The mode stores two arrays: a pos array and a crd array.  For a mode with n
+/// segments in m chunks, the pos array holds the first and last position of
+/// each segment ([2*p] and [2*p+1]), then the first position of each chunk
+/// followed by the total number of positions ([2*n+c]), and then the segment
+/// of each lane of each chunk ([2*n+m+1+c*C+l]).  Consecutive positions of a
+/// segment are `chunkSize` apart and padding positions store zeros.  The
+/// format is read-only; tensors are packed into it by `TensorBase::pack`.
+///
+/// Sums over the segments of a row-major loop nest are lowered with the chunk
+/// iteration capability, as a loop over the slot columns of each chunk that
+/// is unrolled across its `chunkSize` lanes so that the C compiler vectorizes
+/// it.  Other loops use position iteration, which steps by `chunkSize` within
+/// one segment.
+class SlicedEllModeFormat : public ModeFormatImpl {
+public:
+  SlicedEllModeFormat(int chunkSize, int sortWindow = 1);
+  SlicedEllModeFormat(bool isOrdered, bool isUnique, bool isZeroless,
+                      int chunkSize, int sortWindow);
+
+  ~SlicedEllModeFormat() override {}
+
+  ModeFormat copy(std::vector<ModeFormat::Property> properties) const override;
+
+  /// Returns the segment bounds and, as result[2], the distance between
+  /// consecutive positions of a segment (the chunk size).
+  ModeFunction posIterBounds(ir::Expr parentPos, Mode mode) const override;
+  ModeFunction posIterAccess(ir::Expr pos, std::vector<ir::Expr> coords,
+                             Mode mode) const override;
+
+  ModeFunction chunkIterBounds(ir::Expr chunk, ir::Expr numSegments,
+                               Mode mode) const override;
+  ModeFunction chunkIterAccess(ir::Expr chunk, ir::Expr lane,
+                               ir::Expr numSegments, Mode mode) const override;
+
+  std::vector<ir::Expr> getArrays(ir::Expr tensor, int mode,
+                                  int level) const override;
+
+  /// Returns the number of segments per chunk (C).
+  int getChunkSize() const;
+
+  /// Returns the number of segments that are sorted by length (sigma).
+  int getSortWindow() const;
+
+protected:
+  ir::Expr getPosArray(ModePack pack) const;
+  ir::Expr getCoordArray(ModePack pack) const;
+
+  bool equals(const ModeFormatImpl& other) const override;
+
+  const int chunkSize;
+  const int sortWindow;
+};
+
+}
+
+#endif
@@ -0,0 +1,176 @@
+#ifndef TACO_STORAGE_ALLOCATOR_H
+#define TACO_STORAGE_ALLOCATOR_H
+
+#include <atomic>
+#include <memory>
+#include <cstddef>
+
+#include "taco/taco_allocator_t.h"
+#include "taco/util/uncopyable.h"
+
+namespace taco {
+
+/// Set the allocator that generated kernels and arrays (`makeArray` and the
+/// value arrays of assembled tensors) allocate memory with.  A null allocator
+/// restores the system allocator (malloc/realloc/free).  Arrays are freed by
+/// the allocator that allocated them, so allocators must outlive the arrays
+/// allocated from them.  The allocator should not be changed while kernels
+/// run.  Generated kernels also allocate their pooled workspaces, which
+/// persist across calls, with the active allocator; they are freed when the
+/// allocator is changed and when an arena allocator is reset or destroyed,
+/// and reallocated by the next kernels that need them.
+void setAllocator(const taco_allocator_t* allocator);
+
+/// Get the active allocator.
+const taco_allocator_t* getAllocator();
+
+/// Allocate, reallocate and deallocate memory with the active allocator.
+/// @{
+void* allocate(size_t size);
+void* callocate(size_t num, size_t size);
+void* reallocate(void* ptr, size_t size);
+void deallocate(void* ptr);
+/// @}
+
+/// Deallocate memory with the allocator that allocated it.
+void deallocate(const taco_allocator_t* allocator, void* ptr);
+
+/// How the pages of large allocations are placed on the nodes of NUMA systems.
+enum class NumaPlacement {
+  /// Pages are placed on the node of the thread that first writes them, which
+  /// for arrays that are initialized serially is the node of one thread.
+  Default,
+
+  /// Pages are first touched in parallel by the taco threads, which partition
+  /// them with taco's parallel schedule like parallel compute loops, so that
+  /// each thread's part of an array is placed on the thread's node.  Grown
+  /// allocations place only their new pages, and allocations made in parallel
+  /// regions are not placed.
+  FirstTouch,
+
+  /// Pages are interleaved across all NUMA nodes (Linux only).  Only
+  /// allocations of the system allocator are interleaved, which taco maps
+  /// itself for the purpose.
+  Interleave
+};
+
+/// Set how taco allocations of at least a megabyte, which include the arrays
+/// that generated kernels assemble, are placed on NUMA nodes.
+void setNumaPlacement(NumaPlacement placement);
+
+/// Get how large taco allocations are placed on NUMA nodes.
+NumaPlacement getNumaPlacement();
+
+/// Returns the allocator that generated kernels allocate through.  It forwards
+/// to the active allocator and updates the allocation statistics.
+taco_allocator_t* getKernelAllocator();
+
+/// Enable or disable memory tracking, which records the allocation statistics,
+/// allocation scopes and kernel memory statistics.  Tracking is disabled by
+/// default, since it updates shared counters on every allocation.  Memory
+/// allocated while tracking is disabled is not counted when it is freed.
+void setMemoryTracking(bool enabled);
+
+/// Returns whether memory tracking is enabled.
+bool isMemoryTrackingEnabled();
+
+/// Statistics of the tracked allocations made through taco allocators.
+struct AllocatorStats {
+  size_t bytesAllocated = 0;   /// bytes requested by allocations/reallocations
+  size_t numAllocations = 0;   /// number of allocations and reallocations
+  size_t numDeallocations = 0; /// number of deallocations
+  size_t bytesInUse = 0;       /// bytes allocated and not yet deallocated
+  size_t peakBytesInUse = 0;   /// high-water mark of bytesInUse
+};
+
+/// Get the statistics of all allocations since the last reset.
+AllocatorStats getAllocatorStats();
+
+/// Reset the allocation statistics.  The bytes in use are not reset, since
+/// the memory is still allocated, and the high-water mark restarts from them.
+void resetAllocatorStats();
+
+
+/// An allocation scope records the tracked allocations that the constructing
+/// thread makes through taco allocators, including those of the generated
+/// kernels it calls, while the scope is alive.  Scopes nest, and the
+/// allocations of an inner scope also count towards the outer scopes.
+class AllocationScope : util::Uncopyable {
+public:
+  /// Create a scope.  If `includeThreads` is true, the scope also records the
+  /// allocations of the taco threads that run the parallel regions started by
+  /// the constructing thread, which must not be shared with other scopes.
+  explicit AllocationScope(bool includeThreads = false);
+  ~AllocationScope();
+
+  /// Returns the bytes requested by allocations and reallocations.
+  size_t getBytesAllocated() const;
+
+  /// Returns the largest number of bytes that were in use at once, above the
+  /// bytes in use when the scope was entered.
+  size_t getPeakBytes() const;
+
+private:
+  AllocationScope* parent;
+  bool includeThreads;
+  std::atomic<long long> bytesInUse;
+  std::atomic<size_t> peakBytes;
+  std::atomic<size_t> bytesAllocated;
+  friend struct AllocationTracker;
+};
+
+
+/// Statistics of the memory that the calls of a compiled kernel allocated
+/// through taco allocators while memory tracking was enabled.
+struct KernelMemoryStats {
+  size_t numCalls = 0;       /// number of calls
+  size_t bytesAllocated = 0; /// bytes requested by all calls
+  size_t peakBytes = 0;      /// largest peak of one call (see AllocationScope)
+  size_t workspaceBytes = 0; /// bytes of the kernel's persistent workspaces
+};
+
+
+/// An arena allocator allocates memory by bumping a pointer through large
+/// blocks, and frees all of it at once when it is reset or destroyed.
+/// Deallocating is a no-op except for the most recent allocation, which
+/// reallocations also grow in place.  Arena allocators suit iterations that
+/// create many temporary tensors, which are released together.
+class ArenaAllocator {
+public:
+  /// Create an arena that reserves memory in blocks of the given size.
+  explicit ArenaAllocator(size_t blockSize = 64 << 20);
+
+  /// Free all memory of the arena.  Arrays allocated from the arena must no
+  /// longer be used.
+  void reset();
+
+  /// Returns the number of bytes that the arena has reserved.
+  size_t getReservedBytes() const;
+
+  /// Returns the function table of the allocator, to pass to `setAllocator`.
+  const taco_allocator_t* getAllocator() const;
+
+private:
+  struct Content;
+  std::shared_ptr<Content> content;
+};
+
+
+/// A huge page allocator backs allocations of at least the given threshold
+/// with huge pages (transparent huge pages on Linux), which reduces TLB misses
+/// when kernels stream through large arrays.  Smaller allocations and systems
+/// without huge pages use the system allocator.
+class HugePageAllocator {
+public:
+  explicit HugePageAllocator(size_t threshold = 2 << 20);
+
+  /// Returns the function table of the allocator, to pass to `setAllocator`.
+  const taco_allocator_t* getAllocator() const;
+
+private:
+  struct Content;
+  std::shared_ptr<Content> content;
+};
+
+}
+#endif
@@ -15,8 +15,10 @@ class Array {
 public:
   /// The memory reclamation policy of Array objects. UserOwns means the Array
   /// object will not free its data, free means it will reclaim data  with the
-  /// C free function and delete means it will reclaim data with delete[].
-  enum Policy {UserOwns, Free, Delete};
+  /// C free function, delete means it will reclaim data with delete[] and
+  /// deallocate means it will reclaim data with the taco allocator that was
+  /// active when the array was constructed (see `setAllocator`).
+  enum Policy {UserOwns, Free, Delete, Deallocate};
 
   /// Construct an empty array of undefined elements.
   Array();
@@ -30,6 +32,9 @@ public:
   /// Returns the number of array elements
   size_t getSize() const;
 
+  /// Returns the memory reclamation policy of the array.
+  Policy getPolicy() const;
+
   /// Returns the array data.
   /// @{
   const void* getData() const;
@@ -63,7 +68,8 @@ Array makeArray(T* data, size_t size, Array::Policy policy=Array::UserOwns) {
   return Array(type<T>(), data, size, policy);
 }
 
-/// Construct an array of elements of the given type.
+/// Construct an array of elements of the given type, allocated with the
+/// active taco allocator.
 Array makeArray(Datatype type, size_t size);
 
 /// Construct an Array from the values.
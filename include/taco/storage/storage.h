@@ -58,8 +58,22 @@ public:
   size_t getSizeInBytes();
 
   /// Convert to a taco_tensor_t, whose lifetime is the same as the storage.
+  /// The conversion updates a taco_tensor_t that is shared by all copies of
+  /// the storage, so it must not be used by concurrent threads.
   operator struct taco_tensor_t*() const;
 
+  /// Point the shared taco_tensor_t (see the conversion to a taco_tensor_t) to
+  /// the current arrays of the storage.  Once bound, converting the storage
+  /// only reads the taco_tensor_t until the arrays change, so concurrent
+  /// kernels may then read the storage through it.
+  void bind() const;
+
+  /// Create a new taco_tensor_t that refers to the arrays of the storage and
+  /// must be freed with `deinit_taco_tensor_t`.  Unlike the conversion to a
+  /// taco_tensor_t this does not modify the storage, so concurrent threads
+  /// may create taco_tensor_ts of the same storage.
+  struct taco_tensor_t* makeTacoTensorT() const;
+
   /// Set the tensor index, which describes the non-zero values.
   void setIndex(const Index& index);
 
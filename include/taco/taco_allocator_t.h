@@ -0,0 +1,20 @@
+/// This file defines the runtime struct used to route the memory allocations
+/// of generated code and of taco arrays to an allocator.  Note: this file must
+/// be valid C99, not C++.  Allocators may leave `callocate` null, in which
+/// case taco zeroes memory from `allocate`.
+/// This *must* be kept in sync with the version used in codegen_c.cpp
+
+#ifndef TACO_ALLOCATOR_T_DEFINED
+#define TACO_ALLOCATOR_T_DEFINED
+
+#include <stddef.h>
+
+typedef struct taco_allocator_t {
+  void* (*allocate)(void* context, size_t size);              // as malloc
+  void* (*callocate)(void* context, size_t num, size_t size); // as calloc
+  void* (*reallocate)(void* context, void* ptr, size_t size); // as realloc
+  void  (*deallocate)(void* context, void* ptr);              // as free
+  void* context;                                              // allocator state
+} taco_allocator_t;
+
+#endif
@@ -8,6 +8,8 @@
 #include <utility>
 #include <array>
 #include <mutex>
+#include <future>
+#include <unordered_map>
 
 #include "taco/type.h"
 #include "taco/format.h"
@@ -39,6 +41,30 @@ struct AccessTensorNode;
 template <typename CType>
 struct ScalarAccess;
 
+/// The bytes of memory that a tensor holds, by component.
+struct TensorMemoryUsage {
+  /// First index arrays of the levels: positions, or dimensions of dense levels
+  size_t pos = 0;
+
+  /// Second index arrays of the levels: coordinates, hash buckets or bitmaps
+  size_t crd = 0;
+
+  /// Value array
+  size_t vals = 0;
+
+  /// Buffer of inserted components that are not yet packed
+  size_t coordinateBuffer = 0;
+
+  /// Bytes of the index and value arrays with the `Array::UserOwns` policy,
+  /// which the tensor does not free
+  size_t userOwned = 0;
+
+  /// Returns the total bytes of all components.
+  size_t total() const {
+    return pos + crd + vals + coordinateBuffer;
+  }
+};
+
 /// TensorBase is the super-class for all tensors. You can use it directly to
 /// avoid templates, or you can use the templated `Tensor<T>` that inherits from
 /// `TensorBase`.
@@ -440,6 +466,29 @@ public:
   /// Set to true to perform the assemble and compute stages simultaneously.
   void setAssembleWhileCompute(bool assembleWhileCompute);
 
+  /// Set to true to compute into the tensor's existing storage, instead of
+  /// assembling new storage, when the storage already has the structure that
+  /// assembly would produce.  That is the case if all modes are dense and the
+  /// value array has been allocated, or if the kernel, the tensor's index and
+  /// the index structures (sparsity patterns) of the operands are unchanged
+  /// since the tensor was last assembled.  Iterations that only change
+  /// operand values then run only the compute kernel and allocate no tensor
+  /// memory.  Arrays that were previously obtained from the storage see the
+  /// new values.
+  void setReuseStorage(bool reuseStorage);
+
+  /// Freeze the tensor, which computes any pending values and makes the
+  /// tensor immutable.  Inserting into, assigning to, or setting the storage
+  /// of a frozen tensor is an error.  Since its values never change,
+  /// expressions that read a frozen tensor do not register with it, which
+  /// avoids the bookkeeping that writes otherwise need to compute the
+  /// expressions that read the old values.  Freeze long-lived operands, such
+  /// as a model matrix, that many expressions read.
+  void freeze();
+
+  /// True if the tensor is frozen (see `freeze`).
+  bool isFrozen() const;
+
   /// Get the source code of the kernel functions.
   std::string getSource() const;
 
@@ -465,6 +514,14 @@ public:
   /// Get the taco_tensor_t representation of this tensor.
   taco_tensor_t* getTacoTensorT();
 
+  /// Get the bytes of memory that the tensor holds, by component.
+  TensorMemoryUsage getMemoryUsage() const;
+
+  /// Get the statistics of the memory that calls of the tensor's compiled
+  /// kernel allocated.  Compiled kernels are cached and shared by tensors that
+  /// compute the same expression, and so are their statistics.
+  KernelMemoryStats getKernelMemoryStats() const;
+
   /* --- Friend Functions    --- */
 
   /// True iff two tensors have the same type and the same values.
@@ -488,6 +545,9 @@ public:
   friend std::ostream& operator<<(std::ostream&, TensorBase&);
 
   friend struct AccessTensorNode;
+  friend class CallPlan;
+  friend std::vector<std::shared_future<TensorBase>>
+  evaluateAsync(const std::vector<TensorBase>& results);
   std::vector<TensorBase> getDependentTensors();
 private:
   static std::shared_ptr<ir::Module> getHelperFunctions(
@@ -505,6 +565,21 @@ private:
   void setNeedsAssemble(bool needsAssemble);
   void setNeedsCompute(bool needsCompute);
 
+  /// True if assembly can be skipped because the compute kernel writes into
+  /// the tensor's existing storage (see `setReuseStorage`).  The operands are
+  /// those returned by `getStructureOperands`.
+  bool reusesStorage(const std::vector<TensorBase>& operands) const;
+
+  /// Records the kernel and a copy of the index structures of the tensor and
+  /// its operands, which with the kernel determine the structure that
+  /// assembly produces, after the tensor is assembled.
+  void recordAssembledStructure(const std::vector<TensorBase>& operands);
+
+  /// True if the kernel and the index structures of the tensor and its
+  /// operands are the ones recorded when the tensor was last assembled.  This
+  /// compares the index arrays with the recorded copies and does not allocate.
+  bool matchesAssembledStructure(const std::vector<TensorBase>& operands) const;
+
   void addDependentTensor(TensorBase& tensor);
   void removeDependentTensor(TensorBase& tensor);
   void syncDependentTensors();
@@ -543,6 +618,58 @@ private:
   static std::mutex computeKernelsMutex;
 };
 
+/// A call plan invokes the compiled kernels of a tensor's expression with
+/// arguments that are bound once, when the plan is created, instead of on
+/// every call to `TensorBase::assemble` and `TensorBase::compute`.  Calling a
+/// plan only refreshes the data pointers of the bound `taco_tensor_t`s and
+/// calls the kernel, so it does not allocate memory unless the kernel
+/// assembles the result.  Plans do not synchronize their operands, whose
+/// values must be current when the plan is called; values may be updated in
+/// place between calls.  Like other writes to the result, calls first compute
+/// the pending expressions that read the result's old values.
+class CallPlan {
+public:
+  /// Create an undefined call plan.
+  CallPlan();
+
+  /// Create a call plan for the compiled expression assigned to `result`.
+  explicit CallPlan(const TensorBase& result);
+
+  /// Assemble the result's index and value arrays.
+  void assemble();
+
+  /// Compute the result's values.
+  void compute();
+
+  /// Assemble (unless the expression accumulates into the result) and
+  /// compute the result.
+  void evaluate();
+
+  /// True if the call plan is defined.
+  bool defined() const;
+
+private:
+  struct Content;
+  std::shared_ptr<Content> content;
+};
+
+/// Evaluate the pending assignments of the results, and of the pending tensors
+/// that the results read, asynchronously.  The assignments form a dependency
+/// graph, whose kernels are compiled on the calling thread and then assembled
+/// and computed by a pool of worker threads as soon as the kernels of their
+/// operands finish, so independent kernels run concurrently.  The pool has
+/// at most `taco_set_num_threads` workers, one per kernel that can run at
+/// once, and the workers share the threads among the parallel loops of their
+/// kernels.  Returns a future per result, which is ready when its values are
+/// computed and rethrows errors of the kernels it depends on.  The pending
+/// tensors must not be used until their futures are ready, and the workers
+/// finish the evaluation even if the futures are destroyed.
+/// @{
+std::vector<std::shared_future<TensorBase>>
+evaluateAsync(const std::vector<TensorBase>& results);
+std::shared_future<TensorBase> evaluateAsync(const TensorBase& result);
+/// @}
+
 /// A reference to a tensor. Tensor object copies copies the reference, and
 /// subsequent method calls affect both tensor references. To deeply copy a
 /// tensor (for instance to change the format) compute a copy index expression
@@ -592,6 +719,12 @@ public:
   /// Returns a copy of the tensor without explicit zeros.
   Tensor<CType> removeExplicitZeros(Format format) const;
 
+  /// Returns a blocked copy of the tensor, where each mode k is split into a
+  /// block coordinate and an offset within blocks of size blockSizes[k].  For
+  /// example a matrix A(i,j) becomes B(i/r, j/c, i%r, j%c), which can be
+  /// stored in the BCSR(r,c) format.  Partial blocks are padded with zeros.
+  Tensor<CType> block(std::vector<int> blockSizes, Format format) const;
+
   const_iterator<int,CType> begin() const;
   const_iterator<int,CType> begin();
 
@@ -881,6 +1014,9 @@ struct TensorBase::Content {
   ir::Stmt           assembleFunc;
   ir::Stmt           computeFunc;
   bool               assembleWhileCompute;
+  bool               reuseStorage;
+  std::weak_ptr<ir::Module> assembledModule;
+  std::vector<std::vector<char>> assembledIndices;
   std::shared_ptr<ir::Module> module;
 
   size_t             coordinateBufferUsed;
@@ -892,7 +1028,14 @@ struct TensorBase::Content {
   bool               needsCompile;
   bool               needsAssemble;
   bool               needsCompute;
-  std::vector<std::weak_ptr<TensorBase::Content>> dependentTensors;
+  bool               frozen;
+
+  // The pending tensors whose expressions read this tensor, keyed by their
+  // content, so that registering and unregistering them takes constant time.
+  // Entries of destroyed tensors are pruned when the map doubles in size.
+  std::unordered_map<const TensorBase::Content*,
+                     std::weak_ptr<TensorBase::Content>> dependentTensors;
+  size_t             dependentTensorsPruneSize;
   unsigned int       uniqueId;
 
   Content(std::string name, Datatype dataType, const std::vector<int>& dimensions,
@@ -944,6 +1087,7 @@ void TensorBase::insert(const std::vector<int>& coordinate, CType value) {
 
 template <typename CType>
 void TensorBase::insertUnsynced(const std::vector<int>& coordinate, CType value) {
+  taco_uassert(!content->frozen) << error::modify_frozen_tensor;
   taco_uassert(coordinate.size() == (size_t)getOrder()) <<
   "Wrong number of indices";
   taco_uassert(getComponentType() == type<CType>()) <<
@@ -965,6 +1109,7 @@ template <typename T, typename CType>
 void TensorBase::insertUnchecked(
     const typename TensorBase::const_iterator<T,CType>::Coordinates& coordinate, 
     CType value) {
+  taco_uassert(!content->frozen) << error::modify_frozen_tensor;
   if ((content->coordinateBuffer->size() - content->coordinateBufferUsed) < content->coordinateSize) {
     content->coordinateBuffer->resize(content->coordinateBuffer->size() + content->coordinateSize);
   }
@@ -1233,6 +1378,34 @@ Tensor<CType> Tensor<CType>::removeExplicitZeros(Format format) const {
   return newTensor;
 }
 
+template <typename CType>
+Tensor<CType> Tensor<CType>::block(std::vector<int> blockSizes, 
+                                   Format format) const {
+  taco_uassert(blockSizes.size() == (size_t)getOrder())
+      << "A block size must be given for each of the " << getOrder() 
+      << " tensor modes";
+
+  std::vector<int> newDimensions(2 * getOrder());
+  for (int mode = 0; mode < getOrder(); ++mode) {
+    taco_uassert(blockSizes[mode] > 0) << "Block sizes must be positive";
+    newDimensions[mode] = (getDimensions()[mode] + blockSizes[mode] - 1) / 
+                          blockSizes[mode];
+    newDimensions[getOrder() + mode] = blockSizes[mode];
+  }
+
+  Tensor<CType> newTensor(newDimensions, format);
+  std::vector<int> newCoordinate(2 * getOrder());
+  for (const auto& elem : *this) {
+    for (int mode = 0; mode < getOrder(); ++mode) {
+      newCoordinate[mode] = elem.first[mode] / blockSizes[mode];
+      newCoordinate[getOrder() + mode] = elem.first[mode] % blockSizes[mode];
+    }
+    newTensor.insert(newCoordinate, elem.second);
+  }
+  newTensor.pack();
+  return newTensor;
+}
+
 template <typename CType>
 TensorBase::const_iterator<int,CType> Tensor<CType>::begin() const {
   return TensorBase::iterator<CType>().begin();
@@ -1300,5 +1473,15 @@ void taco_set_num_threads(int num_threads);
 /// computations. This will be replaced by a scheduling language in the future.
 int taco_get_num_threads();
 
+/// Set whether tensors compiled without a schedule prefetch the components
+/// that loops over compressed levels gather from dense operands whose values
+/// do not fit in the last-level cache (32 MiB where the system does not report
+/// its size).  The components are prefetched 16 positions ahead of their use
+/// (see `IndexStmt::prefetch`).  Disabled by default.
+void taco_set_prefetch_large_gathers(bool enabled);
+
+/// Get whether tensors compiled without a schedule prefetch large gathers.
+bool taco_get_prefetch_large_gathers();
+
 }
 #endif
@@ -0,0 +1,73 @@
+#ifndef TACO_UTIL_TRACE_H
+#define TACO_UTIL_TRACE_H
+
+#include <string>
+#include <ostream>
+
+namespace taco {
+namespace util {
+
+/// Tracing records begin and end events of the stages of the taco pipeline
+/// (packing, compiling, assembling, computing, reading files and calling
+/// helper kernels), with the ids of the threads that run them, and exports
+/// them as Chrome trace JSON that chrome://tracing and Perfetto display.
+///
+/// Setting the environment variable TACO_TRACE to a file name enables tracing
+/// when the program starts and writes the trace to the file when it exits.
+/// Each thread records its events into its own ring buffer without locking,
+/// and the oldest events of a thread are overwritten when its buffer is full.
+/// The buffer of a thread that exits is recycled for new threads, which
+/// overwrite the events of the finished thread.
+
+/// Enable or disable the recording of trace events.
+void setTracing(bool enabled);
+
+/// Returns true if trace events are recorded.
+bool isTracing();
+
+/// Record the begin and end of an event on the calling thread.  The name and
+/// category must be string literals or otherwise outlive the trace.
+/// @{
+void traceBegin(const char* name, const char* category="taco");
+void traceEnd(const char* name, const char* category="taco");
+/// @}
+
+/// Write the recorded events as Chrome trace JSON.  Threads should not record
+/// events while the trace is written.
+/// @{
+void writeTrace(std::ostream& stream);
+void writeTrace(std::string filename);
+/// @}
+
+/// Discard the recorded events.  Threads should not record events while the
+/// trace is cleared.
+void clearTrace();
+
+/// A trace scope records a begin event when it is constructed and the end
+/// event when it is destroyed.
+class TraceScope {
+public:
+  TraceScope(const char* name, const char* category="taco")
+      : name(name), category(category), traced(isTracing()) {
+    if (traced) {
+      traceBegin(name, category);
+    }
+  }
+
+  ~TraceScope() {
+    if (traced) {
+      traceEnd(name, category);
+    }
+  }
+
+  TraceScope(const TraceScope&) = delete;
+  TraceScope& operator=(const TraceScope&) = delete;
+
+private:
+  const char* name;
+  const char* category;
+  bool traced;
+};
+
+}}
+#endif
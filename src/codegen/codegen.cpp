@@ -113,6 +113,11 @@ string CodeGen::printType(Datatype type, bool is_ptr) {
   return "";
 }
 
+string CodeGen::printIndexArrayType(Datatype type) {
+  // 32-bit index arrays keep their historical `int*` spelling
+  return (type == Int32) ? "int*" : printType(type, true);
+}
+
 string CodeGen::printCAlloc(string pointer, string size) {
   return pointer + " = malloc(" + size + ");";
 }
@@ -216,13 +221,13 @@ string CodeGen::printTensorProperty(string varname, const GetProperty* op, bool
 
   // for a Dense level, nnz is an int
   // for a Fixed level, ptr is an int
-  // all others are int*
+  // all others are pointers to the index array's element type
   if (op->property == TensorProperty::Dimension) {
     tp = "int" + star;
     ret << tp << " " << varname;
   } else {
     taco_iassert(op->property == TensorProperty::Indices);
-    tp = "int*" + star;
+    tp = printIndexArrayType(op->type) + star;
     ret << tp << " " << varname;
   }
 
@@ -250,17 +255,17 @@ string CodeGen::unpackTensorProperty(string varname, const GetProperty* op,
 
   // for a Dense level, nnz is an int
   // for a Fixed level, ptr is an int
-  // all others are int*
+  // all others are pointers to the index array's element type
   if (op->property == TensorProperty::Dimension) {
     tp = "int";
     ret << tp << " " << varname << " = (int)(" << tensor->name
         << "->dimensions[" << op->mode << "]);\n";
   } else {
     taco_iassert(op->property == TensorProperty::Indices);
-    tp = "int*";
+    tp = printIndexArrayType(op->type);
     auto nm = op->index;
     ret << tp << " " << restrictKeyword() << " " << varname << " = ";
-    ret << "(int*)(" << tensor->name << "->indices[" << op->mode;
+    ret << "(" << tp << ")(" << tensor->name << "->indices[" << op->mode;
     ret << "][" << nm << "]);\n";
   }
 
@@ -505,6 +510,14 @@ static vector<const GetProperty*> sortProps(std::map<Expr, std::string, ExprComp
   return sortedProps;
 }
 
+string CodeGen::printStatus(const Function *func,
+                            const map<Expr, string, ExprCompare>& varMap) {
+  if (!func->status.defined() || varMap.count(func->status) == 0) {
+    return "0";
+  }
+  return varMap.at(func->status);
+}
+
 string CodeGen::printFuncName(const Function *func, 
                               std::map<Expr, std::string, ExprCompare> inputMap, 
                               std::map<Expr, std::string, ExprCompare> outputMap) {
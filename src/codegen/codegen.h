@@ -39,6 +39,7 @@ protected:
   std::string printFree(std::string pointer);
 
   std::string printType(Datatype type, bool is_ptr);
+  std::string printIndexArrayType(Datatype type);
   std::string printContextDeclAndInit(std::map<Expr, std::string, ExprCompare> varMap,
                                           std::vector<Expr> localVars, int labels,
                                           std::string funcName);
@@ -52,6 +53,10 @@ protected:
   std::string printFuncName(const Function *func, 
           std::map<Expr, std::string, ExprCompare> inputMap={}, 
           std::map<Expr, std::string, ExprCompare> outputMap={});
+  /// Prints the value a function returns, which is 0 unless the function
+  /// returns a status variable that its body declares
+  static std::string printStatus(const Function *func,
+          const std::map<Expr, std::string, ExprCompare>& varMap);
 
   void resetUniqueNameCounters();
   std::string genUniqueName(std::string name);
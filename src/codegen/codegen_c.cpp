@@ -6,10 +6,12 @@
 #include <taco.h>
 
 #include "taco/ir/ir_visitor.h"
+#include "taco/ir/simplify.h"
 #include "codegen_c.h"
 #include "taco/error.h"
 #include "taco/util/strings.h"
 #include "taco/util/collections.h"
+#include "taco/lower/lower.h"
 
 using namespace std;
 
@@ -23,7 +25,7 @@ namespace {
 // stdlib.h for malloc/realloc
 // math.h for sqrt
 // MIN preprocessor macro
-// This *must* be kept in sync with taco_tensor_t.h
+// This *must* be kept in sync with taco_tensor_t.h and taco_allocator_t.h
 const string cHeaders =
   "#ifndef TACO_C_HEADERS\n"
   "#define TACO_C_HEADERS\n"
@@ -34,6 +36,7 @@ const string cHeaders =
   "#include <math.h>\n"
   "#include <complex.h>\n"
   "#include <string.h>\n"
+  "#include <pthread.h>\n"
   "#if _OPENMP\n"
   "#include <omp.h>\n"
   "#endif\n"
@@ -54,6 +57,43 @@ const string cHeaders =
   "  int32_t      vals_size;     // values array size\n"
   "} taco_tensor_t;\n"
   "#endif\n"
+  "#ifndef TACO_ALLOCATOR_T_DEFINED\n"
+  "#define TACO_ALLOCATOR_T_DEFINED\n"
+  "typedef struct taco_allocator_t {\n"
+  "  void* (*allocate)(void* context, size_t size);\n"
+  "  void* (*callocate)(void* context, size_t num, size_t size);\n"
+  "  void* (*reallocate)(void* context, void* ptr, size_t size);\n"
+  "  void  (*deallocate)(void* context, void* ptr);\n"
+  "  void* context;\n"
+  "} taco_allocator_t;\n"
+  "#endif\n"
+  // Set to the taco allocator when the module is loaded (see Module::compile)
+  "taco_allocator_t* taco_allocator = NULL;\n"
+  "void* taco_malloc(size_t size) {\n"
+  "  if (taco_allocator == NULL) {\n"
+  "    return malloc(size);\n"
+  "  }\n"
+  "  return taco_allocator->allocate(taco_allocator->context, size);\n"
+  "}\n"
+  "void* taco_calloc(size_t num, size_t size) {\n"
+  "  if (taco_allocator == NULL) {\n"
+  "    return calloc(num, size);\n"
+  "  }\n"
+  "  return taco_allocator->callocate(taco_allocator->context, num, size);\n"
+  "}\n"
+  "void* taco_realloc(void* ptr, size_t size) {\n"
+  "  if (taco_allocator == NULL) {\n"
+  "    return realloc(ptr, size);\n"
+  "  }\n"
+  "  return taco_allocator->reallocate(taco_allocator->context, ptr, size);\n"
+  "}\n"
+  "void taco_free(void* ptr) {\n"
+  "  if (taco_allocator == NULL) {\n"
+  "    free(ptr);\n"
+  "    return;\n"
+  "  }\n"
+  "  taco_allocator->deallocate(taco_allocator->context, ptr);\n"
+  "}\n"
   "#if !_OPENMP\n"
   "int omp_get_thread_num() { return 0; }\n"
   "int omp_get_max_threads() { return 1; }\n"
@@ -103,6 +143,233 @@ const string cHeaders =
   "  }\n"
   "  return lowerBound;\n"
   "}\n"
+  "int taco_gallop(int *array, int arrayStart, int arrayEnd, int target) {\n"
+  "  if (arrayStart >= arrayEnd || array[arrayStart] >= target) {\n"
+  "    return arrayStart;\n"
+  "  }\n"
+  "  int lowerBound = arrayStart; // always < target\n"
+  "  int step = 1;\n"
+  "  while (lowerBound + step < arrayEnd && array[lowerBound + step] < target) {\n"
+  "    lowerBound += step;\n"
+  "    step *= 2;\n"
+  "  }\n"
+  "  return taco_binarySearchAfter(array, lowerBound, TACO_MIN(lowerBound + step, arrayEnd), target);\n"
+  "}\n"
+  // Segments always keep an empty slot, so a coordinate that is not stored is
+  // located at an empty slot
+  "int taco_hashLocate(int *crd, int segmentBegin, int capacity, int coord) {\n"
+  "  int slot = (int)(((uint32_t)coord * 2654435761u) & (uint32_t)(capacity - 1));\n"
+  "  for (int probes = 0; probes < capacity; probes++) {\n"
+  "    int pos = segmentBegin + slot;\n"
+  "    if (crd[pos] == coord || crd[pos] < 0) {\n"
+  "      return pos;\n"
+  "    }\n"
+  "    slot = (slot + 1) & (capacity - 1);\n"
+  "  }\n"
+  "  return segmentBegin + slot;\n"
+  "}\n"
+  // Whether storing a new coordinate at the empty slot pos would leave its
+  // segment without an empty slot
+  "bool taco_hashFills(int *crd, int segmentBegin, int capacity, int pos) {\n"
+  "  if (crd[pos] >= 0) {\n"
+  "    return false;\n"
+  "  }\n"
+  "  int slot = pos - segmentBegin;\n"
+  "  for (int probes = 1; probes < capacity; probes++) {\n"
+  "    slot = (slot + 1) & (capacity - 1);\n"
+  "    if (crd[segmentBegin + slot] < 0) {\n"
+  "      return false;\n"
+  "    }\n"
+  "  }\n"
+  "  return true;\n"
+  "}\n"
+  "int taco_mergePathSearch(int *pos, int numRows, int diagonal) {\n"
+  "  int numNonzeros = pos[numRows];\n"
+  "  int lowerBound = TACO_MAX(diagonal - numNonzeros, 0);\n"
+  "  int upperBound = TACO_MIN(diagonal, numRows);\n"
+  "  while (lowerBound < upperBound) {\n"
+  "    int mid = (lowerBound + upperBound) / 2;\n"
+  "    if (pos[mid + 1] <= diagonal - mid - 1) {\n"
+  "      lowerBound = mid + 1;\n"
+  "    }\n"
+  "    else {\n"
+  "      upperBound = mid;\n"
+  "    }\n"
+  "  }\n"
+  "  return lowerBound;\n"
+  "}\n"
+  "int32_t taco_prefixSum(int32_t *array, int32_t n) {\n"
+  "  int32_t total = 0;\n"
+  "#if _OPENMP\n"
+  "  if (n >= 65536 && omp_get_max_threads() > 1) {\n"
+  "    int32_t* sums = (int32_t*)taco_calloc(omp_get_max_threads() + 1, sizeof(int32_t));\n"
+  "    #pragma omp parallel\n"
+  "    {\n"
+  "      int32_t t = omp_get_thread_num();\n"
+  "      int32_t numThreads = omp_get_num_threads();\n"
+  "      int32_t chunk = (n + numThreads - 1) / numThreads;\n"
+  "      int32_t begin = TACO_MIN(t * chunk, n);\n"
+  "      int32_t end = TACO_MIN(begin + chunk, n);\n"
+  "      int32_t sum = 0;\n"
+  "      for (int32_t i = begin; i < end; i++) {\n"
+  "        sum += array[i];\n"
+  "      }\n"
+  "      sums[t + 1] = sum;\n"
+  "      #pragma omp barrier\n"
+  "      #pragma omp single\n"
+  "      {\n"
+  "        for (int32_t i = 1; i <= numThreads; i++) {\n"
+  "          sums[i] += sums[i - 1];\n"
+  "        }\n"
+  "        total = sums[numThreads];\n"
+  "      }\n"
+  "      int32_t offset = sums[t];\n"
+  "      for (int32_t i = begin; i < end; i++) {\n"
+  "        int32_t count = array[i];\n"
+  "        array[i] = offset;\n"
+  "        offset += count;\n"
+  "      }\n"
+  "    }\n"
+  "    taco_free(sums);\n"
+  "    return total;\n"
+  "  }\n"
+  "#endif\n"
+  "  for (int32_t i = 0; i < n; i++) {\n"
+  "    int32_t count = array[i];\n"
+  "    array[i] = total;\n"
+  "    total += count;\n"
+  "  }\n"
+  "  return total;\n"
+  "}\n"
+  "uint64_t taco_bit(int pos) {\n"
+  "  return (uint64_t)1 << (pos & 63);\n"
+  "}\n"
+  "int taco_ctz(uint64_t word) {\n"
+  "#if defined(__GNUC__) || defined(__clang__)\n"
+  "  return __builtin_ctzll(word);\n"
+  "#else\n"
+  "  int bit = 0;\n"
+  "  while (!(word & 1)) {\n"
+  "    word >>= 1;\n"
+  "    bit++;\n"
+  "  }\n"
+  "  return bit;\n"
+  "#endif\n"
+  "}\n"
+  // Each thread has a pool with separate slots for unfilled, zero-filled, and
+  // one-filled workspaces, which persist across calls and are freed when the
+  // thread exits, when the module is unloaded, or when taco releases them
+  // before the allocator changes.  Each slot is freed with the allocator that
+  // allocated it.
+  "#define TACO_MAX_WORKSPACES " + util::toString(MAX_PERSISTENT_WORKSPACES) + "\n"
+  "typedef struct {\n"
+  "  void*             data;\n"
+  "  size_t            size;\n"
+  "  taco_allocator_t* allocator;\n"
+  "} taco_workspace_t;\n"
+  "typedef struct taco_workspace_pool_t {\n"
+  "  taco_workspace_t workspaces[3][TACO_MAX_WORKSPACES];\n"
+  "  struct taco_workspace_pool_t* next;\n"
+  "} taco_workspace_pool_t;\n"
+  // Bytes of the workspaces of all threads, read by the module's memory stats
+  "static size_t taco_workspace_bytes = 0;\n"
+  "size_t taco_get_workspace_bytes(void) {\n"
+  "  return __atomic_load_n(&taco_workspace_bytes, __ATOMIC_RELAXED);\n"
+  "}\n"
+  "static pthread_mutex_t taco_workspace_pools_lock = PTHREAD_MUTEX_INITIALIZER;\n"
+  "static taco_workspace_pool_t* taco_workspace_pools = NULL;\n"
+  "static pthread_once_t taco_workspace_pool_key_once = PTHREAD_ONCE_INIT;\n"
+  "static pthread_key_t taco_workspace_pool_key;\n"
+  "static __thread taco_workspace_pool_t* taco_workspace_pool = NULL;\n"
+  "static void taco_workspace_free(taco_workspace_t* workspace) {\n"
+  "  if (workspace->data == NULL) {\n"
+  "    return;\n"
+  "  }\n"
+  "  __atomic_fetch_sub(&taco_workspace_bytes, workspace->size,\n"
+  "                     __ATOMIC_RELAXED);\n"
+  "  if (workspace->allocator == NULL) {\n"
+  "    free(workspace->data);\n"
+  "  } else {\n"
+  "    workspace->allocator->deallocate(workspace->allocator->context,\n"
+  "                                     workspace->data);\n"
+  "  }\n"
+  "  workspace->data = NULL;\n"
+  "  workspace->size = 0;\n"
+  "}\n"
+  "static void taco_workspace_pool_clear(taco_workspace_pool_t* pool) {\n"
+  "  for (int32_t fill = 0; fill < 3; fill++) {\n"
+  "    for (int32_t slot = 0; slot < TACO_MAX_WORKSPACES; slot++) {\n"
+  "      taco_workspace_free(&pool->workspaces[fill][slot]);\n"
+  "    }\n"
+  "  }\n"
+  "}\n"
+  "static void taco_workspace_pool_free(taco_workspace_pool_t* pool) {\n"
+  "  taco_workspace_pool_clear(pool);\n"
+  "  free(pool);\n"
+  "}\n"
+  "static void taco_workspace_pool_release(void* data) {\n"
+  "  taco_workspace_pool_t* pool = (taco_workspace_pool_t*)data;\n"
+  "  pthread_mutex_lock(&taco_workspace_pools_lock);\n"
+  "  taco_workspace_pool_t** link = &taco_workspace_pools;\n"
+  "  while (*link != NULL && *link != pool) {\n"
+  "    link = &(*link)->next;\n"
+  "  }\n"
+  "  if (*link == pool) {\n"
+  "    *link = pool->next;\n"
+  "    taco_workspace_pool_free(pool);\n"
+  "  }\n"
+  "  pthread_mutex_unlock(&taco_workspace_pools_lock);\n"
+  "}\n"
+  "static void taco_workspace_pool_key_create(void) {\n"
+  "  pthread_key_create(&taco_workspace_pool_key, taco_workspace_pool_release);\n"
+  "}\n"
+  "__attribute__((destructor)) static void taco_workspace_pools_free(void) {\n"
+  "  pthread_once(&taco_workspace_pool_key_once, taco_workspace_pool_key_create);\n"
+  "  pthread_key_delete(taco_workspace_pool_key);\n"
+  "  pthread_mutex_lock(&taco_workspace_pools_lock);\n"
+  "  while (taco_workspace_pools != NULL) {\n"
+  "    taco_workspace_pool_t* pool = taco_workspace_pools;\n"
+  "    taco_workspace_pools = pool->next;\n"
+  "    taco_workspace_pool_free(pool);\n"
+  "  }\n"
+  "  pthread_mutex_unlock(&taco_workspace_pools_lock);\n"
+  "}\n"
+  // Frees the workspaces of all threads, which must not run kernels of the
+  // module, while keeping their pools.
+  "void taco_release_workspaces(void) {\n"
+  "  pthread_mutex_lock(&taco_workspace_pools_lock);\n"
+  "  for (taco_workspace_pool_t* pool = taco_workspace_pools; pool != NULL;\n"
+  "       pool = pool->next) {\n"
+  "    taco_workspace_pool_clear(pool);\n"
+  "  }\n"
+  "  pthread_mutex_unlock(&taco_workspace_pools_lock);\n"
+  "}\n"
+  "void* taco_workspace_acquire(int32_t slot, size_t size, int32_t fill) {\n"
+  "  if (taco_workspace_pool == NULL) {\n"
+  "    taco_workspace_pool =\n"
+  "        (taco_workspace_pool_t*)calloc(1, sizeof(taco_workspace_pool_t));\n"
+  "    pthread_once(&taco_workspace_pool_key_once, taco_workspace_pool_key_create);\n"
+  "    pthread_setspecific(taco_workspace_pool_key, taco_workspace_pool);\n"
+  "    pthread_mutex_lock(&taco_workspace_pools_lock);\n"
+  "    taco_workspace_pool->next = taco_workspace_pools;\n"
+  "    taco_workspace_pools = taco_workspace_pool;\n"
+  "    pthread_mutex_unlock(&taco_workspace_pools_lock);\n"
+  "  }\n"
+  "  taco_workspace_t* workspace =\n"
+  "      &taco_workspace_pool->workspaces[fill < 0 ? 0 : (fill == 0 ? 1 : 2)][slot];\n"
+  "  if (workspace->data == NULL || workspace->size < size) {\n"
+  "    size_t capacity = TACO_MAX(size, workspace->size);\n"
+  "    taco_workspace_free(workspace);\n"
+  "    workspace->allocator = taco_allocator;\n"
+  "    workspace->data = taco_malloc(TACO_MAX(capacity, 1));\n"
+  "    workspace->size = capacity;\n"
+  "    __atomic_fetch_add(&taco_workspace_bytes, capacity, __ATOMIC_RELAXED);\n"
+  "    if (fill >= 0) {\n"
+  "      memset(workspace->data, fill, workspace->size);\n"
+  "    }\n"
+  "  }\n"
+  "  return workspace->data;\n"
+  "}\n"
   "taco_tensor_t* init_taco_tensor_t(int32_t order, int32_t csize,\n"
   "                                  int32_t* dimensions, int32_t* mode_ordering,\n"
   "                                  taco_mode_t* mode_types) {\n"
@@ -269,11 +536,18 @@ void CodeGen_C::visit(const Function* func) {
   funcName = func->name;
   labelCount = 0;
 
+  // Hoist loop invariants before finding variables, since hoisting declares
+  // new variables
+  Stmt body = func->body;
+  if (simplify && !emittingCoroutine) {
+    body = hoistLoopInvariants(ir::simplify(body));
+  }
+
   resetUniqueNameCounters();
   FindVars inputVarFinder(func->inputs, {}, this);
-  func->body.accept(&inputVarFinder);
+  body.accept(&inputVarFinder);
   FindVars outputVarFinder({}, func->outputs, this);
-  func->body.accept(&outputVarFinder);
+  body.accept(&outputVarFinder);
 
   // output function declaration
   doIndent();
@@ -293,7 +567,7 @@ void CodeGen_C::visit(const Function* func) {
   // find all the vars that are not inputs or outputs and declare them
   resetUniqueNameCounters();
   FindVars varFinder(func->inputs, func->outputs, this);
-  func->body.accept(&varFinder);
+  body.accept(&varFinder);
   varMap = varFinder.varMap;
   localVars = varFinder.localVars;
 
@@ -306,7 +580,7 @@ void CodeGen_C::visit(const Function* func) {
   }
 
   // output body
-  print(func->body);
+  print(body);
 
   // output repack only if we allocated memory
   if (checkForAlloc(func))
@@ -317,7 +591,7 @@ void CodeGen_C::visit(const Function* func) {
   }
 
   doIndent();
-  out << "return 0;\n";
+  out << "return " << printStatus(func, varMap) << ";\n";
   indent--;
 
   doIndent();
@@ -415,6 +689,16 @@ void CodeGen_C::visit(const For* op) {
     case LoopKind::Static_Chunked:
       doIndent();
       out << getParallelizePragma(op->kind);
+      if (!op->reductionVars.empty()) {
+        out << " reduction(+:";
+        for (size_t i = 0; i < op->reductionVars.size(); ++i) {
+          if (i > 0) {
+            out << ",";
+          }
+          op->reductionVars[i].accept(this);
+        }
+        out << ")";
+      }
       out << "\n";
       break;
     default:
@@ -518,7 +802,7 @@ void CodeGen_C::visit(const Allocate* op) {
   stream << elementType << "*";
   stream << ")";
   if (op->is_realloc) {
-    stream << "realloc(";
+    stream << "taco_realloc(";
     op->var.accept(this);
     stream << ", ";
   }
@@ -526,9 +810,9 @@ void CodeGen_C::visit(const Allocate* op) {
     // If the allocation was requested to clear the allocated memory,
     // use calloc instead of malloc.
     if (op->clear) {
-      stream << "calloc(1, ";
+      stream << "taco_calloc(1, ";
     } else {
-      stream << "malloc(";
+      stream << "taco_malloc(";
     }
   }
   stream << "sizeof(" << elementType << ")";
@@ -540,6 +824,26 @@ void CodeGen_C::visit(const Allocate* op) {
     stream << endl;
 }
 
+void CodeGen_C::visit(const Free* op) {
+  doIndent();
+  stream << "taco_free(";
+  parentPrecedence = Precedence::TOP;
+  op->var.accept(this);
+  stream << ");";
+  stream << endl;
+}
+
+void CodeGen_C::visit(const Call* op) {
+  // Route the memory allocations of lowered code to the taco allocator.
+  if (op->func == "malloc" || op->func == "calloc" || op->func == "realloc" ||
+      op->func == "free") {
+    Expr call = Call::make("taco_" + op->func, op->args, op->type);
+    IRPrinter::visit(to<Call>(call));
+    return;
+  }
+  IRPrinter::visit(op);
+}
+
 void CodeGen_C::visit(const Sqrt* op) {
   taco_tassert(op->type.isFloat() && op->type.getNumBits() == 64) <<
       "Codegen doesn't currently support non-double sqrt";
@@ -564,6 +868,18 @@ void CodeGen_C::visit(const Store* op) {
   IRPrinter::visit(op);
 }
 
+void CodeGen_C::visit(const Prefetch* op) {
+  doIndent();
+  stream << "__builtin_prefetch(&";
+  parentPrecedence = Precedence::LOAD;
+  op->arr.accept(this);
+  stream << "[";
+  parentPrecedence = Precedence::TOP;
+  op->loc.accept(this);
+  stream << "]);";
+  stream << endl;
+}
+
 void CodeGen_C::generateShim(const Stmt& func, stringstream &ret) {
   const Function *funcPtr = func.as<Function>();
 
@@ -38,9 +38,12 @@ protected:
   void visit(const Min*);
   void visit(const Max*);
   void visit(const Allocate*);
+  void visit(const Free*);
+  void visit(const Call*);
   void visit(const Sqrt*);
   void visit(const Store*);
   void visit(const Assign*);
+  void visit(const Prefetch*);
 
   std::map<Expr, std::string, ExprCompare> varMap;
   std::vector<Expr> localVars;
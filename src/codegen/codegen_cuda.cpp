@@ -106,6 +106,18 @@ const string gpuAssertMacro =
   "  }\n"
   "  return lowerBound;\n"
   "}\n"
+  "__device__ __host__ int taco_gallop(int *array, int arrayStart, int arrayEnd, int target) {\n"
+  "  if (arrayStart >= arrayEnd || array[arrayStart] >= target) {\n"
+  "    return arrayStart;\n"
+  "  }\n"
+  "  int lowerBound = arrayStart; // always < target\n"
+  "  int step = 1;\n"
+  "  while (lowerBound + step < arrayEnd && array[lowerBound + step] < target) {\n"
+  "    lowerBound += step;\n"
+  "    step *= 2;\n"
+  "  }\n"
+  "  return taco_binarySearchAfter(array, lowerBound, TACO_MIN(lowerBound + step, arrayEnd), target);\n"
+  "}\n"
   "__global__ void taco_binarySearchBeforeBlock(int * __restrict__ array, int * __restrict__ results, int arrayStart, int arrayEnd, int values_per_block, int num_blocks) {\n"
   "  int thread = threadIdx.x;\n"
   "  int block = blockIdx.x;\n"
@@ -426,7 +438,8 @@ Stmt CodeGen_CUDA::simplifyFunctionBodies(Stmt stmt) {
       int numYields = countYields(func); // temporary fix as simplifying function with yields will break printContextDeclAndInit
       if (numYields == 0) {
         Stmt body = ir::simplify(func->body);
-        stmt = Function::make(func->name, func->outputs, func->inputs, body);
+        stmt = Function::make(func->name, func->outputs, func->inputs, body,
+                              func->status);
       }
       else {
         stmt = func;
@@ -802,7 +815,7 @@ void CodeGen_CUDA::visit(const Function* func) {
     out << "return (int) (tot_ms * 100000); // returns 10^-8 seconds (assumes tot_ms < 20 seconds)\n";
   }
   else {
-    out << "return 0;\n";
+    out << "return " << printStatus(func, varMap) << ";\n";
   }
   indent--;
 
@@ -2,6 +2,8 @@
 
 #include <iostream>
 #include <fstream>
+#include <mutex>
+#include <algorithm>
 #include <dlfcn.h>
 #include <unistd.h>
 #if USE_OPENMP
@@ -12,6 +14,8 @@
 #include "taco/error.h"
 #include "taco/util/strings.h"
 #include "taco/util/env.h"
+#include "taco/util/trace.h"
+#include "taco/storage/allocator.h"
 #include "codegen/codegen_c.h"
 #include "codegen/codegen_cuda.h"
 #include "taco/cuda.h"
@@ -26,6 +30,19 @@ std::default_random_engine Module::gen = std::default_random_engine();
 std::uniform_int_distribution<int> Module::randint =
     std::uniform_int_distribution<int>(0, chars.length() - 1);
 
+/// The functions that free the pooled workspaces of the loaded libraries,
+/// which stay loaded after their modules are destroyed.
+struct WorkspaceReleasers {
+  std::mutex lock;
+  std::vector<void (*)()> functions;
+};
+
+static WorkspaceReleasers& getWorkspaceReleasers() {
+  // Never destroyed, since allocators may be reset during static destruction.
+  static WorkspaceReleasers* releasers = new WorkspaceReleasers;
+  return *releasers;
+}
+
 void Module::setJITTmpdir() {
   tmpdir = util::getTmpdir();
 }
@@ -129,6 +146,10 @@ string Module::compile() {
     "-O3 -ffast-math -std=c99") + " -shared -fPIC";
 #if USE_OPENMP
     cflags += " -fopenmp";
+#endif
+#if TACO_TSAN
+    // Instrument the kernels, which are what runs concurrently
+    cflags += " -g -fsanitize=thread";
 #endif
     file_ending = ".c";
     shims_file = "";
@@ -136,26 +157,57 @@ string Module::compile() {
   
   string cmd = cc + " " + cflags + " " +
     prefix + file_ending + " " + shims_file + " " + 
-    "-o " + fullpath + " -lm";
+    "-o " + fullpath + " -lm -lpthread";
 
-  // open the output file & write out the source
-  compileToSource(tmpdir, libname);
-  
-  // write out the shims
-  writeShims(funcs, tmpdir, libname);
+  {
+    util::TraceScope trace("generate code");
+    // open the output file & write out the source
+    compileToSource(tmpdir, libname);
+
+    // write out the shims
+    writeShims(funcs, tmpdir, libname);
+  }
   
   // now compile it
-  int err = system(cmd.data());
+  int err;
+  {
+    util::TraceScope trace("compile code");
+    err = system(cmd.data());
+  }
   taco_uassert(err == 0) << "Compilation command failed:\n" << cmd
     << "\nreturned " << err;
 
   // use dlsym() to open the compiled library
   if (lib_handle) {
+    if (releaseModuleWorkspaces != nullptr) {
+      WorkspaceReleasers& releasers = getWorkspaceReleasers();
+      std::lock_guard<std::mutex> guard(releasers.lock);
+      releasers.functions.erase(std::find(releasers.functions.begin(),
+                                          releasers.functions.end(),
+                                          releaseModuleWorkspaces));
+    }
     dlclose(lib_handle);
   }
+  util::TraceScope trace("load code");
   lib_handle = dlopen(fullpath.data(), RTLD_NOW | RTLD_LOCAL);
   taco_uassert(lib_handle) << "Failed to load generated code, error is: " << dlerror();
 
+  // Route the allocations of the generated code to the taco allocator.
+  // Modules compiled from user source may not define the allocator.
+  auto allocator = (taco_allocator_t**)dlsym(lib_handle, "taco_allocator");
+  if (allocator != nullptr) {
+    *allocator = getKernelAllocator();
+  }
+  *reinterpret_cast<void**>(&workspaceBytes) =
+      dlsym(lib_handle, "taco_get_workspace_bytes");
+  *reinterpret_cast<void**>(&releaseModuleWorkspaces) =
+      dlsym(lib_handle, "taco_release_workspaces");
+  if (releaseModuleWorkspaces != nullptr) {
+    WorkspaceReleasers& releasers = getWorkspaceReleasers();
+    std::lock_guard<std::mutex> guard(releasers.lock);
+    releasers.functions.push_back(releaseModuleWorkspaces);
+  }
+
   return fullpath;
 }
 
@@ -173,10 +225,13 @@ void* Module::getFuncPtr(std::string name) {
 }
 
 int Module::callFuncPackedRaw(std::string name, void** args) {
+  return callFuncPackedRaw(getFuncPtr(name), args);
+}
+
+int Module::callFuncPackedRaw(void* v_func_ptr, void** args) {
   typedef int (*fnptr_t)(void**);
   static_assert(sizeof(void*) == sizeof(fnptr_t),
     "Unable to cast dlsym() returned void pointer to function pointer");
-  void* v_func_ptr = getFuncPtr(name);
   fnptr_t func_ptr;
   *reinterpret_cast<void**>(&func_ptr) = v_func_ptr;
 
@@ -200,7 +255,15 @@ int Module::callFuncPackedRaw(std::string name, void** args) {
   omp_set_num_threads(taco_get_num_threads());
 #endif
 
+  // The scope includes the taco threads of the kernel's parallel regions.
+  AllocationScope scope(true);
   int ret = func_ptr(args);
+  numCalls++;
+  bytesAllocated += scope.getBytesAllocated();
+  size_t peak = peakBytes;
+  while (scope.getPeakBytes() > peak &&
+         !peakBytes.compare_exchange_weak(peak, scope.getPeakBytes())) {
+  }
 
 #if USE_OPENMP
   omp_set_schedule(existingSched, existingChunkSize);
@@ -210,5 +273,22 @@ int Module::callFuncPackedRaw(std::string name, void** args) {
   return ret;
 }
 
+void Module::releaseWorkspaces() {
+  WorkspaceReleasers& releasers = getWorkspaceReleasers();
+  std::lock_guard<std::mutex> guard(releasers.lock);
+  for (auto& release : releasers.functions) {
+    release();
+  }
+}
+
+KernelMemoryStats Module::getMemoryStats() const {
+  KernelMemoryStats stats;
+  stats.numCalls = numCalls;
+  stats.bytesAllocated = bytesAllocated;
+  stats.peakBytes = peakBytes;
+  stats.workspaceBytes = (workspaceBytes != nullptr) ? workspaceBytes() : 0;
+  return stats;
+}
+
 } // namespace ir
 } // namespace taco
@@ -37,6 +37,33 @@ const std::string assemble_without_compile =
 const std::string compute_without_compile =
    "The compile method must be called before compute.";
 
+const std::string modify_frozen_tensor =
+  "Frozen tensors cannot be inserted into, assigned to, or given new storage.";
+
+const std::string hash_table_full =
+  "A hash table segment of a hashed level or workspace can hold at most its "
+  "capacity minus one coordinates.  Use a larger capacity.";
+
+const std::string split_remainder =
+  "The dimension of an index variable that is split with TailStrategy::RoundUp "
+  "must be a multiple of the split factor.";
+
+const std::string call_plan_without_compile =
+  "The compile method must be called before a call plan is created.";
+
+const std::string search_requires_int32_index =
+  "Binary searches over index arrays (used by windowed accesses and by "
+  "splitting position or coordinate loops) require 32-bit index arrays.";
+
+const std::string index_type_too_narrow =
+  "The coordinate (crd) arrays of a level must be able to hold the "
+  "coordinates of the level's dimension, and its position (pos) arrays the "
+  "number of stored components.";
+
+const std::string strided_positions_not_supported =
+  "Splitting, fusing, or windowing loops over mode formats whose positions "
+  "are strided (e.g., sliced ELLPACK) is not supported.";
+
 const std::string requires_matrix =
     "The argument must be a matrix.";
 
@@ -9,6 +9,9 @@
 #include "taco/lower/mode_format_dense.h"
 #include "taco/lower/mode_format_compressed.h"
 #include "taco/lower/mode_format_singleton.h"
+#include "taco/lower/mode_format_sliced_ell.h"
+#include "taco/lower/mode_format_hashed.h"
+#include "taco/lower/mode_format_bitmap.h"
 
 #include "taco/error.h"
 #include "taco/util/strings.h"
@@ -120,6 +123,14 @@ bool operator==(const Format& a, const Format& b){
       return false;
     }
   } 
+  // Formats that store coordinates with different integer types are distinct
+  // (levels without explicit array types default to 32-bit integers).
+  for (int i = 0; i < a.getOrder(); ++i) {
+    if (a.getCoordinateTypePos(i) != b.getCoordinateTypePos(i) ||
+        a.getCoordinateTypeIdx(i) != b.getCoordinateTypeIdx(i)) {
+      return false;
+    }
+  }
   return true;
 }
 
@@ -292,6 +303,35 @@ bool ModeFormat::isYieldPosPure() const {
   return impl->isYieldPosPure;
 }
 
+int ModeFormat::getBlockSize() const {
+  taco_iassert(defined());
+  auto denseImpl = std::dynamic_pointer_cast<const DenseModeFormat>(impl);
+  return (denseImpl != nullptr) ? denseImpl->getBlockSize() : 0;
+}
+
+int ModeFormat::getChunkSize() const {
+  taco_iassert(defined());
+  auto sellImpl = std::dynamic_pointer_cast<const SlicedEllModeFormat>(impl);
+  return (sellImpl != nullptr) ? sellImpl->getChunkSize() : 0;
+}
+
+int ModeFormat::getSortWindow() const {
+  taco_iassert(defined());
+  auto sellImpl = std::dynamic_pointer_cast<const SlicedEllModeFormat>(impl);
+  return (sellImpl != nullptr) ? sellImpl->getSortWindow() : 0;
+}
+
+int ModeFormat::getHashCapacity() const {
+  taco_iassert(defined());
+  auto hashedImpl = std::dynamic_pointer_cast<const HashedModeFormat>(impl);
+  return (hashedImpl != nullptr) ? hashedImpl->getCapacity() : 0;
+}
+
+bool ModeFormat::isBitmap() const {
+  taco_iassert(defined());
+  return std::dynamic_pointer_cast<const BitmapModeFormat>(impl) != nullptr;
+}
+
 std::vector<AttrQuery> ModeFormat::getAttrQueries(
     std::vector<IndexVar> parentCoords, 
     std::vector<IndexVar> childCoords) const {
@@ -385,6 +425,8 @@ const ModeFormat compressed = ModeFormat::Compressed;
 const ModeFormat sparse = ModeFormat::Compressed;
 const ModeFormat singleton = ModeFormat::Singleton;
 
+const ModeFormat Bitmap(std::make_shared<BitmapModeFormat>());
+
 const Format CSR({Dense, Sparse}, {0,1});
 const Format CSC({Dense, Sparse}, {1,0});
 const Format DCSR({Sparse, Sparse}, {0,1});
@@ -415,6 +457,40 @@ const Format COO(int order, bool isUnique, bool isOrdered, bool isAoS,
          : Format(modeTypes, modeOrdering);
 }
 
+ModeFormat DenseBlock(int blockSize) {
+  taco_uassert(blockSize > 0) << "Block sizes must be positive";
+  return ModeFormat(std::make_shared<DenseModeFormat>(true, true, false, 
+                                                      blockSize));
+}
+
+const Format BCSR(int rowBlockSize, int colBlockSize) {
+  return Format({Dense, Compressed, DenseBlock(rowBlockSize), 
+                 DenseBlock(colBlockSize)});
+}
+
+const Format BCSF(const std::vector<int>& blockSizes) {
+  taco_uassert(!blockSizes.empty());
+
+  std::vector<ModeFormatPack> modeTypes(blockSizes.size(), Compressed);
+  for (int blockSize : blockSizes) {
+    modeTypes.push_back(DenseBlock(blockSize));
+  }
+  return Format(modeTypes);
+}
+
+ModeFormat SlicedEll(int chunkSize, int sortWindow) {
+  return ModeFormat(std::make_shared<SlicedEllModeFormat>(chunkSize, 
+                                                          sortWindow));
+}
+
+const Format SELL(int chunkSize, int sortWindow) {
+  return Format({Dense, SlicedEll(chunkSize, sortWindow)});
+}
+
+ModeFormat Hashed(int capacity) {
+  return ModeFormat(std::make_shared<HashedModeFormat>(capacity));
+}
+
 bool isDense(const Format& format) {
   for (ModeFormat modeFormat : format.getModeFormats()) {
     if (modeFormat != Dense) {
@@ -368,7 +368,9 @@ struct Isomorphic : public IndexNotationVisitorStrict {
         !check(anode->stmt, bnode->stmt) ||
         anode->parallel_unit != bnode->parallel_unit ||
         anode->output_race_strategy != bnode->output_race_strategy ||
-        anode->unrollFactor != bnode->unrollFactor) {
+        anode->unrollFactor != bnode->unrollFactor ||
+        anode->merge_strategy != bnode->merge_strategy ||
+        anode->prefetchDistance != bnode->prefetchDistance) {
       eq = false;
       return;
     }
@@ -675,7 +677,9 @@ struct Equals : public IndexNotationVisitorStrict {
         !equals(anode->stmt, bnode->stmt) ||
         anode->parallel_unit != bnode->parallel_unit ||
         anode->output_race_strategy != bnode->output_race_strategy ||
-        anode->unrollFactor != bnode->unrollFactor) {
+        anode->unrollFactor != bnode->unrollFactor ||
+        anode->merge_strategy != bnode->merge_strategy ||
+        anode->prefetchDistance != bnode->prefetchDistance) {
       eq = false;
       return;
     }
@@ -1494,8 +1498,9 @@ IndexStmt IndexStmt::concretize() const {
   return stmt;
 }
 
-IndexStmt IndexStmt::split(IndexVar i, IndexVar i1, IndexVar i2, size_t splitFactor) const {
-  IndexVarRel rel = IndexVarRel(new SplitRelNode(i, i1, i2, splitFactor));
+IndexStmt IndexStmt::split(IndexVar i, IndexVar i1, IndexVar i2, size_t splitFactor,
+                           TailStrategy tailStrategy) const {
+  IndexVarRel rel = IndexVarRel(new SplitRelNode(i, i1, i2, splitFactor, tailStrategy));
   string reason;
 
   // Add predicate to concrete index notation
@@ -1513,8 +1518,9 @@ IndexStmt IndexStmt::split(IndexVar i, IndexVar i1, IndexVar i2, size_t splitFac
   return transformed;
 }
 
-IndexStmt IndexStmt::divide(IndexVar i, IndexVar i1, IndexVar i2, size_t splitFactor) const {
-  IndexVarRel rel = IndexVarRel(new DivideRelNode(i, i1, i2, splitFactor));
+IndexStmt IndexStmt::divide(IndexVar i, IndexVar i1, IndexVar i2, size_t splitFactor,
+                            TailStrategy tailStrategy) const {
+  IndexVarRel rel = IndexVarRel(new DivideRelNode(i, i1, i2, splitFactor, tailStrategy));
   string reason;
 
   // Add predicate to concrete index notation.
@@ -1695,7 +1701,7 @@ IndexStmt IndexStmt::unroll(IndexVar i, size_t unrollFactor) const {
 
     void visit(const ForallNode* node) {
       if (node->indexVar == i) {
-        stmt = Forall(i, rewrite(node->stmt), node->parallel_unit, node->output_race_strategy, unrollFactor);
+        stmt = Forall(i, rewrite(node->stmt), node->parallel_unit, node->output_race_strategy, unrollFactor, node->merge_strategy, node->prefetchDistance);
       }
       else {
         IndexNotationRewriter::visit(node);
@@ -1705,6 +1711,66 @@ IndexStmt IndexStmt::unroll(IndexVar i, size_t unrollFactor) const {
   return UnrollLoop(i, unrollFactor).rewrite(*this);
 }
 
+IndexStmt IndexStmt::mergeby(IndexVar i, MergeStrategy strategy) const {
+  struct SetMergeStrategy : IndexNotationRewriter {
+    using IndexNotationRewriter::visit;
+    IndexVar i;
+    MergeStrategy strategy;
+    bool found = false;
+    SetMergeStrategy(IndexVar i, MergeStrategy strategy)
+        : i(i), strategy(strategy) {}
+
+    void visit(const ForallNode* node) {
+      if (node->indexVar == i) {
+        found = true;
+        stmt = Forall(i, rewrite(node->stmt), node->parallel_unit,
+                      node->output_race_strategy, node->unrollFactor, strategy,
+                      node->prefetchDistance);
+      }
+      else {
+        IndexNotationRewriter::visit(node);
+      }
+    }
+  };
+  SetMergeStrategy setMergeStrategy(i, strategy);
+  IndexStmt transformed = setMergeStrategy.rewrite(*this);
+  taco_uassert(setMergeStrategy.found)
+      << "Index variable " << i << " is not the index variable of a loop in "
+      << *this;
+  return transformed;
+}
+
+IndexStmt IndexStmt::prefetch(IndexVar i, size_t distance) const {
+  taco_uassert(distance > 0)
+      << "The prefetch distance of " << i << " must be positive";
+  struct SetPrefetchDistance : IndexNotationRewriter {
+    using IndexNotationRewriter::visit;
+    IndexVar i;
+    size_t distance;
+    bool found = false;
+    SetPrefetchDistance(IndexVar i, size_t distance)
+        : i(i), distance(distance) {}
+
+    void visit(const ForallNode* node) {
+      if (node->indexVar == i) {
+        found = true;
+        stmt = Forall(i, rewrite(node->stmt), node->parallel_unit,
+                      node->output_race_strategy, node->unrollFactor,
+                      node->merge_strategy, distance);
+      }
+      else {
+        IndexNotationRewriter::visit(node);
+      }
+    }
+  };
+  SetPrefetchDistance setPrefetchDistance(i, distance);
+  IndexStmt transformed = setPrefetchDistance.rewrite(*this);
+  taco_uassert(setPrefetchDistance.found)
+      << "Index variable " << i << " is not the index variable of a loop in "
+      << *this;
+  return transformed;
+}
+
 IndexStmt IndexStmt::assemble(TensorVar result, AssembleStrategy strategy,
                               bool separatelySchedulable) const {
   string reason;
@@ -1806,8 +1872,8 @@ Forall::Forall(IndexVar indexVar, IndexStmt stmt)
     : Forall(indexVar, stmt, ParallelUnit::NotParallel, OutputRaceStrategy::IgnoreRaces) {
 }
 
-Forall::Forall(IndexVar indexVar, IndexStmt stmt, ParallelUnit parallel_unit, OutputRaceStrategy output_race_strategy, size_t unrollFactor)
-        : Forall(new ForallNode(indexVar, stmt, parallel_unit, output_race_strategy, unrollFactor)) {
+Forall::Forall(IndexVar indexVar, IndexStmt stmt, ParallelUnit parallel_unit, OutputRaceStrategy output_race_strategy, size_t unrollFactor, MergeStrategy merge_strategy, size_t prefetchDistance)
+        : Forall(new ForallNode(indexVar, stmt, parallel_unit, output_race_strategy, unrollFactor, merge_strategy, prefetchDistance)) {
 }
 
 IndexVar Forall::getIndexVar() const {
@@ -1830,12 +1896,20 @@ size_t Forall::getUnrollFactor() const {
   return getNode(*this)->unrollFactor;
 }
 
+MergeStrategy Forall::getMergeStrategy() const {
+  return getNode(*this)->merge_strategy;
+}
+
+size_t Forall::getPrefetchDistance() const {
+  return getNode(*this)->prefetchDistance;
+}
+
 Forall forall(IndexVar i, IndexStmt stmt) {
   return Forall(i, stmt);
 }
 
-Forall forall(IndexVar i, IndexStmt stmt, ParallelUnit parallel_unit, OutputRaceStrategy output_race_strategy, size_t unrollFactor) {
-  return Forall(i, stmt, parallel_unit, output_race_strategy, unrollFactor);
+Forall forall(IndexVar i, IndexStmt stmt, ParallelUnit parallel_unit, OutputRaceStrategy output_race_strategy, size_t unrollFactor, MergeStrategy merge_strategy, size_t prefetchDistance) {
+  return Forall(i, stmt, parallel_unit, output_race_strategy, unrollFactor, merge_strategy, prefetchDistance);
 }
 
 template <> bool isa<Forall>(IndexStmt s) {
@@ -3465,7 +3539,7 @@ private:
       stmt = op;
     }
     else {
-      stmt = new ForallNode(op->indexVar, body, op->parallel_unit, op->output_race_strategy, op->unrollFactor);
+      stmt = new ForallNode(op->indexVar, body, op->parallel_unit, op->output_race_strategy, op->unrollFactor, op->merge_strategy, op->prefetchDistance);
     }
   }
 
@@ -2,6 +2,7 @@
 
 #include <iostream>
 
+#include "taco/cuda.h"
 #include "taco/index_notation/index_notation.h"
 #include "taco/lower/lower.h"
 #include "taco/codegen/module.h"
@@ -9,6 +10,7 @@
 #include "taco/storage/index.h"
 #include "taco/storage/array.h"
 #include "taco/taco_tensor_t.h"
+#include "taco/util/trace.h"
 #include <taco/index_notation/transformations.h>
 #include "taco/index_notation/index_notation_nodes.h"
 
@@ -37,15 +39,24 @@ Kernel::Kernel(IndexStmt stmt, shared_ptr<ir::Module> module, void* evaluate,
   this->computeFunction = compute;
 }
 
-static inline
-vector<void*> packArguments(const vector<TensorStorage>& args) {
-  vector<void*> arguments;
-  arguments.reserve(args.size());
-  for (auto& arg : args) {
-    arguments.push_back(static_cast<taco_tensor_t*>(arg));
+/// The arguments of one kernel call.  Every call creates its own
+/// taco_tensor_ts, so concurrent calls do not write state they share.
+struct KernelArguments {
+  explicit KernelArguments(const vector<TensorStorage>& args) {
+    arguments.reserve(args.size());
+    for (auto& arg : args) {
+      arguments.push_back(arg.makeTacoTensorT());
+    }
+  }
+
+  ~KernelArguments() {
+    for (void* argument : arguments) {
+      deinit_taco_tensor_t((taco_tensor_t*)argument);
+    }
   }
-  return arguments;
-}
+
+  vector<void*> arguments;
+};
 
 static inline
 void unpackResults(size_t numResults, const vector<void*> arguments,
@@ -76,27 +87,37 @@ void unpackResults(size_t numResults, const vector<void*> arguments,
       }
     }
     storage.setIndex(Index(format, modeIndices));
-    storage.setValues(Array(storage.getComponentType(), tensorData->vals, num));
+    // Generated code allocates values with the active taco allocator.
+    Array::Policy policy = should_use_CUDA_unified_memory() ? Array::Free
+                                                            : Array::Deallocate;
+    storage.setValues(Array(storage.getComponentType(), tensorData->vals, num,
+                            policy));
   }
 }
 
 bool Kernel::operator()(const vector<TensorStorage>& args) const {
-  vector<void*> arguments = packArguments(args);
-  int result = content->module->callFuncPacked("evaluate", arguments.data());
-  unpackResults(this->numResults, arguments, args);
+  util::TraceScope trace("evaluate");
+  KernelArguments arguments(args);
+  int result = content->module->callFuncPackedRaw(evaluateFunction,
+                                                  arguments.arguments.data());
+  unpackResults(this->numResults, arguments.arguments, args);
   return (result == 0);
 }
 
 bool Kernel::assemble(const vector<TensorStorage>& args) const {
-  vector<void*> arguments = packArguments(args);
-  int result = content->module->callFuncPacked("assemble", arguments.data());
-  unpackResults(this->numResults, arguments, args);
+  util::TraceScope trace("assemble");
+  KernelArguments arguments(args);
+  int result = content->module->callFuncPackedRaw(assembleFunction,
+                                                  arguments.arguments.data());
+  unpackResults(this->numResults, arguments.arguments, args);
   return (result == 0);
 }
 
 bool Kernel::compute(const vector<TensorStorage>& args) const {
-  vector<void*> arguments = packArguments(args);
-  int result = content->module->callFuncPacked("compute", arguments.data());
+  util::TraceScope trace("compute");
+  KernelArguments arguments(args);
+  int result = content->module->callFuncPackedRaw(computeFunction,
+                                                  arguments.arguments.data());
   return (result == 0);
 }
 
@@ -104,6 +125,11 @@ bool Kernel::defined() {
   return content != nullptr;
 }
 
+KernelMemoryStats Kernel::getMemoryStats() const {
+  taco_uassert(content != nullptr) << "The kernel is undefined";
+  return content->module->getMemoryStats();
+}
+
 std::ostream& operator<<(std::ostream& os, const Kernel& kernel) {
   return os << kernel.content->module->getSource();
 }
@@ -114,16 +140,20 @@ Kernel compile(IndexStmt stmt) {
       << "Statement not valid concrete index notation and cannot be compiled. "
       << reason << endl << stmt;
 
+  util::TraceScope trace("compile");
   shared_ptr<ir::Module> module(new ir::Module);
-  IndexStmt parallelStmt = parallelizeOuterLoop(stmt);
-  module->addFunction(lower(parallelStmt, "compute",  false, true));
-  module->addFunction(lower(stmt, "assemble", true, false));
-  module->addFunction(lower(stmt, "evaluate", true, true));
+  {
+    util::TraceScope trace("lower");
+    IndexStmt parallelStmt = parallelizeOuterLoop(stmt);
+    module->addFunction(lower(parallelStmt, "compute",  false, true));
+    module->addFunction(lower(stmt, "assemble", true, false));
+    module->addFunction(lower(stmt, "evaluate", true, true));
+  }
   module->compile();
 
-  void* evaluate = module->getFuncPtr("evaluate");
-  void* assemble = module->getFuncPtr("assemble");
-  void* compute  = module->getFuncPtr("compute");
+  void* evaluate = module->getFuncPtr("_shim_evaluate");
+  void* assemble = module->getFuncPtr("_shim_assemble");
+  void* compute  = module->getFuncPtr("_shim_compute");
   return Kernel(stmt, module, evaluate, assemble, compute);
 }
 
@@ -120,14 +120,17 @@ struct SplitRelNode::Content {
   IndexVar outerVar;
   IndexVar innerVar;
   size_t splitFactor;
+  TailStrategy tailStrategy;
 };
 
-SplitRelNode::SplitRelNode(IndexVar parentVar, IndexVar outerVar, IndexVar innerVar, size_t splitFactor)
+SplitRelNode::SplitRelNode(IndexVar parentVar, IndexVar outerVar, IndexVar innerVar, size_t splitFactor,
+                           TailStrategy tailStrategy)
   : IndexVarRelNode(SPLIT), content(new Content) {
   content->parentVar = parentVar;
   content->outerVar = outerVar;
   content->innerVar = innerVar;
   content->splitFactor = splitFactor;
+  content->tailStrategy = tailStrategy;
 }
 
 const IndexVar& SplitRelNode::getParentVar() const {
@@ -142,14 +145,22 @@ const IndexVar& SplitRelNode::getInnerVar() const {
 const size_t& SplitRelNode::getSplitFactor() const {
   return content->splitFactor;
 }
+TailStrategy SplitRelNode::getTailStrategy() const {
+  return content->tailStrategy;
+}
 
 void SplitRelNode::print(std::ostream &stream) const {
-  stream << "split(" << getParentVar() << ", " << getOuterVar() << ", " << getInnerVar() << ", " << getSplitFactor() << ")";
+  stream << "split(" << getParentVar() << ", " << getOuterVar() << ", " << getInnerVar() << ", " << getSplitFactor();
+  if (getTailStrategy() != TailStrategy::Guard) {
+    stream << ", " << TailStrategy_NAMES[(int)getTailStrategy()];
+  }
+  stream << ")";
 }
 
 bool SplitRelNode::equals(const SplitRelNode &rel) const {
   return getParentVar() == rel.getParentVar() && getOuterVar() == rel.getOuterVar()
-        && getInnerVar() == rel.getInnerVar() && getSplitFactor() == rel.getSplitFactor();
+        && getInnerVar() == rel.getInnerVar() && getSplitFactor() == rel.getSplitFactor()
+        && getTailStrategy() == rel.getTailStrategy();
 }
 
 std::vector<IndexVar> SplitRelNode::getParents() const {
@@ -271,14 +282,17 @@ struct DivideRelNode::Content {
   IndexVar outerVar;
   IndexVar innerVar;
   size_t divFactor;
+  TailStrategy tailStrategy;
 };
 
-DivideRelNode::DivideRelNode(IndexVar parentVar, IndexVar outerVar, IndexVar innerVar, size_t divFactor)
+DivideRelNode::DivideRelNode(IndexVar parentVar, IndexVar outerVar, IndexVar innerVar, size_t divFactor,
+                             TailStrategy tailStrategy)
   : IndexVarRelNode(DIVIDE), content(new Content) {
   content->parentVar = parentVar;
   content->outerVar = outerVar;
   content->innerVar = innerVar;
   content->divFactor = divFactor;
+  content->tailStrategy = tailStrategy;
 }
 
 const IndexVar& DivideRelNode::getParentVar() const {
@@ -293,14 +307,22 @@ const IndexVar& DivideRelNode::getInnerVar() const {
 const size_t& DivideRelNode::getDivFactor() const {
   return content->divFactor;
 }
+TailStrategy DivideRelNode::getTailStrategy() const {
+  return content->tailStrategy;
+}
 
 void DivideRelNode::print(std::ostream &stream) const {
-  stream << "divide(" << getParentVar() << ", " << getOuterVar() << ", " << getInnerVar() << ", " << getDivFactor() << ")";
+  stream << "divide(" << getParentVar() << ", " << getOuterVar() << ", " << getInnerVar() << ", " << getDivFactor();
+  if (getTailStrategy() != TailStrategy::Guard) {
+    stream << ", " << TailStrategy_NAMES[(int)getTailStrategy()];
+  }
+  stream << ")";
 }
 
 bool DivideRelNode::equals(const DivideRelNode &rel) const {
   return getParentVar() == rel.getParentVar() && getOuterVar() == rel.getOuterVar() &&
-    getInnerVar() == rel.getInnerVar() && getDivFactor() == rel.getDivFactor();
+    getInnerVar() == rel.getInnerVar() && getDivFactor() == rel.getDivFactor() &&
+    getTailStrategy() == rel.getTailStrategy();
 }
 
 std::vector<IndexVar> DivideRelNode::getParents() const {
@@ -559,7 +581,11 @@ Iterator PosRelNode::getAccessIterator(Iterators iterators, ProvenanceGraph prov
 }
 
 ir::Expr PosRelNode::getAccessCoordArray(Iterators iterators, ProvenanceGraph provGraph) const {
-  return getAccessIterator(iterators, provGraph).getMode().getModePack().getArray(1);
+  ir::Expr coordArray =
+      getAccessIterator(iterators, provGraph).getMode().getModePack().getArray(1);
+  taco_uassert(coordArray.type() == Int32)
+      << error::search_requires_int32_index;
+  return coordArray;
 }
 
 
@@ -1251,7 +1277,17 @@ std::vector<ir::Expr> ProvenanceGraph::deriveIterBounds(IndexVar indexVar, std::
   }
 
   IndexVarRel rel = parentRelMap.at(indexVar);
-  return rel.getNode()->deriveIterBounds(indexVar, parentIterBounds, parentCoordBounds, variableNames, iterators, *this);
+  std::vector<ir::Expr> bounds = rel.getNode()->deriveIterBounds(indexVar, parentIterBounds, parentCoordBounds, variableNames, iterators, *this);
+  if (isPredicatedTail(indexVar, derivedVarOrder)) {
+    // The strip that the outer variable selects starts where the inner
+    // variable is zero, and the inner loop stops at the end of the parent.
+    IndexVar parent = getParents(indexVar)[0];
+    std::map<IndexVar, ir::Expr> stripStartNames = variableNames;
+    stripStartNames[indexVar] = ir::Literal::make(0, bounds[1].type());
+    ir::Expr stripStart = rel.getNode()->recoverVariable(parent, stripStartNames, iterators, parentIterBounds, parentCoordBounds, *this);
+    bounds[1] = ir::Min::make(bounds[1], ir::Sub::make(parentIterBounds.at(parent)[1], stripStart));
+  }
+  return bounds;
 }
 
 bool ProvenanceGraph::hasCoordBounds(IndexVar indexVar) const {
@@ -1419,4 +1455,52 @@ bool ProvenanceGraph::isDivided(IndexVar indexVar) const {
   return false;
 }
 
+TailStrategy ProvenanceGraph::getTailStrategy(IndexVar indexVar) const {
+  if (!childRelMap.count(indexVar)) {
+    return TailStrategy::Guard;
+  }
+  IndexVarRel rel = childRelMap.at(indexVar);
+  if (rel.getRelType() == SPLIT) {
+    return rel.getNode<SplitRelNode>()->getTailStrategy();
+  }
+  if (rel.getRelType() == DIVIDE) {
+    return rel.getNode<DivideRelNode>()->getTailStrategy();
+  }
+  return TailStrategy::Guard;
+}
+
+size_t ProvenanceGraph::getSplitFactor(IndexVar indexVar) const {
+  if (!childRelMap.count(indexVar)) {
+    return 0;
+  }
+  IndexVarRel rel = childRelMap.at(indexVar);
+  if (rel.getRelType() == SPLIT) {
+    return rel.getNode<SplitRelNode>()->getSplitFactor();
+  }
+  if (rel.getRelType() == DIVIDE) {
+    return rel.getNode<DivideRelNode>()->getDivFactor();
+  }
+  return 0;
+}
+
+bool ProvenanceGraph::isPredicatedTail(IndexVar indexVar, std::vector<IndexVar> derivedVarOrder) const {
+  if (isUnderived(indexVar)) {
+    return false;
+  }
+  IndexVarRel rel = parentRelMap.at(indexVar);
+  if (rel.getRelType() != SPLIT && rel.getRelType() != DIVIDE) {
+    return false;
+  }
+  IndexVar parent = getParents(indexVar)[0];
+  std::vector<IndexVar> children = getChildren(parent);
+  if (getTailStrategy(parent) != TailStrategy::Predicate || indexVar != children[1] ||
+      !getChildren(indexVar).empty()) {
+    return false;
+  }
+  // The outer variable must be defined before the inner variable
+  auto outer = std::find(derivedVarOrder.begin(), derivedVarOrder.end(), children[0]);
+  auto inner = std::find(derivedVarOrder.begin(), derivedVarOrder.end(), indexVar);
+  return outer != derivedVarOrder.end() && outer < inner;
+}
+
 }
@@ -687,6 +687,56 @@ OutputRaceStrategy Parallelize::getOutputRaceStrategy() const {
   return content->output_race_strategy;
 }
 
+/// Returns true if the loop iterates over the rows of a CSR matrix and 
+/// directly contains a loop over the nonzeros of each row, which computes a 
+/// dense vector indexed by the rows.  The rows and nonzeros of such loops can 
+/// be partitioned with merge paths.
+static bool isMergePathLoop(Forall forall, const ProvenanceGraph& provGraph) {
+  if (!isa<Forall>(forall.getStmt())) {
+    return false;
+  }
+  Forall inner = to<Forall>(forall.getStmt());
+  const IndexVar i = forall.getIndexVar();
+  const IndexVar j = inner.getIndexVar();
+  if (!isa<Assignment>(inner.getStmt()) || !provGraph.isUnderived(i) || 
+      !provGraph.isUnderived(j)) {
+    return false;
+  }
+
+  Assignment assignment = to<Assignment>(inner.getStmt());
+  const TensorVar result = assignment.getLhs().getTensorVar();
+  if (assignment.getLhs().getIndexVars() != vector<IndexVar>({i}) || 
+      !isDense(result.getFormat()) || (assignment.getOperator().defined() && 
+      !isa<Add>(assignment.getOperator()))) {
+    return false;
+  }
+
+  // Exactly one operand must be a CSR matrix that is accessed by the rows and 
+  // columns, and all other operands must be dense.
+  int numMatrices = 0;
+  bool dense = true;
+  match(assignment.getRhs(),
+    function<void(const AccessNode*)>([&](const AccessNode* op) {
+      const Format format = op->tensorVar.getFormat();
+      if (isDense(format)) {
+        return;
+      }
+      const auto modeFormats = format.getModeFormats();
+      if (op->indexVars == vector<IndexVar>({i, j}) && 
+          format.getModeOrdering() == vector<int>({0, 1}) && 
+          modeFormats[0].getName() == ModeFormat::Dense.getName() &&
+          modeFormats[1].getName() == ModeFormat::Compressed.getName() &&
+          modeFormats[1].isUnique()) {
+        numMatrices++;
+      }
+      else {
+        dense = false;
+      }
+    })
+  );
+  return dense && numMatrices == 1;
+}
+
 IndexStmt Parallelize::apply(IndexStmt stmt, std::string* reason) const {
   INIT_REASON(reason);
 
@@ -700,6 +750,7 @@ IndexStmt Parallelize::apply(IndexStmt stmt, std::string* reason) const {
     set<IndexVar> definedIndexVars;
     set<IndexVar> reductionIndexVars;
     set<ParallelUnit> parentParallelUnits;
+    ir::Expr appendedResult;
     std::string reason = "";
 
     IndexStmt rewriteParallel(IndexStmt stmt) {
@@ -788,6 +839,7 @@ IndexStmt Parallelize::apply(IndexStmt stmt, std::string* reason) const {
               if (!iterator.hasInsert()) {
                 reason = "Precondition failed: The output tensor must support " 
                          "inserts";
+                appendedResult = iterator.getTensor();
                 return;
               }
               if (iterator.isLeaf()) {
@@ -798,6 +850,19 @@ IndexStmt Parallelize::apply(IndexStmt stmt, std::string* reason) const {
           }
         }
 
+        // Precondition 4: Merge-path partitioning must partition the rows and 
+        //                 nonzeros of a CSR matrix on a CPU
+        if (parallelize.getParallelUnit() == ParallelUnit::CPUThreadMergePath &&
+            (should_use_CUDA_codegen() || 
+             parallelize.getOutputRaceStrategy() != OutputRaceStrategy::NoRaces ||
+             !isMergePathLoop(foralli, provGraph))) {
+          reason = "Precondition failed: Merge-path partitioning requires a "
+                   "loop over the rows of a CSR matrix that computes a dense "
+                   "vector indexed by the rows, with the NoRaces strategy on "
+                   "CPUs";
+          return;
+        }
+
         if (parallelize.getOutputRaceStrategy() == OutputRaceStrategy::Temporary &&
             util::contains(reductionIndexVars, underivedForall.getIndexVar())) {
           // Need to precompute reduction
@@ -819,7 +884,18 @@ IndexStmt Parallelize::apply(IndexStmt stmt, std::string* reason) const {
           );
           taco_iassert(!precomputeAssignments.empty());
 
-          IndexStmt precomputed_stmt = forall(i, foralli.getStmt(), parallelize.getParallelUnit(), parallelize.getOutputRaceStrategy(), foralli.getUnrollFactor());
+          // On CPUs, reductions are privatized per thread when the loop is 
+          // lowered.
+          if (!should_use_CUDA_codegen()) {
+            stmt = forall(i, foralli.getStmt(), parallelize.getParallelUnit(), 
+                          parallelize.getOutputRaceStrategy(), 
+                          foralli.getUnrollFactor(),
+                          foralli.getMergeStrategy(),
+                          foralli.getPrefetchDistance());
+            return;
+          }
+
+          IndexStmt precomputed_stmt = forall(i, foralli.getStmt(), parallelize.getParallelUnit(), parallelize.getOutputRaceStrategy(), foralli.getUnrollFactor(), foralli.getMergeStrategy(), foralli.getPrefetchDistance());
           for (auto assignment : precomputeAssignments) {
             // Construct temporary of correct type and size of outer loop
             TensorVar w(string("w_") + ParallelUnit_NAMES[(int) parallelize.getParallelUnit()], Type(assignment->lhs.getDataType(), {Dimension(i)}), taco::dense);
@@ -859,7 +935,7 @@ IndexStmt Parallelize::apply(IndexStmt stmt, std::string* reason) const {
         }
 
 
-        stmt = forall(i, foralli.getStmt(), parallelize.getParallelUnit(), parallelize.getOutputRaceStrategy(), foralli.getUnrollFactor());
+        stmt = forall(i, foralli.getStmt(), parallelize.getParallelUnit(), parallelize.getOutputRaceStrategy(), foralli.getUnrollFactor(), foralli.getMergeStrategy(), foralli.getPrefetchDistance());
         return;
       }
 
@@ -874,6 +950,26 @@ IndexStmt Parallelize::apply(IndexStmt stmt, std::string* reason) const {
   rewriter.parallelize = *this;
   IndexStmt rewritten = rewriter.rewriteParallel(stmt);
   if (!rewriter.reason.empty()) {
+    // Results that are assembled by appending cannot be assembled in 
+    // parallel, so try to assemble them in two phases instead: a symbolic 
+    // phase that counts the nonzeros of each result fiber and a numeric phase 
+    // that inserts the nonzeros at offsets computed from those counts.  Both 
+    // phases share the loop that is parallelized.
+    if (rewriter.appendedResult.defined() && !should_use_CUDA_codegen() &&
+        getParallelUnit() == ParallelUnit::CPUThread &&
+        getOutputRaceStrategy() == OutputRaceStrategy::NoRaces) {
+      for (const auto& tensorVar : rewriter.tensorVars) {
+        if (tensorVar.second != rewriter.appendedResult) {
+          continue;
+        }
+        string assembleReason;
+        IndexStmt assembled = SetAssembleStrategy(tensorVar.first, 
+            AssembleStrategy::Insert, false).apply(stmt, &assembleReason);
+        if (assembled.defined()) {
+          return apply(assembled, reason);
+        }
+      }
+    }
     *reason = rewriter.reason;
     return IndexStmt();
   }
@@ -1027,7 +1123,8 @@ IndexStmt SetAssembleStrategy::apply(IndexStmt stmt, string* reason) const {
         stmt = op;
       } else if (s.defined()) {
         stmt = Forall(op->indexVar, s, op->parallel_unit, 
-                      op->output_race_strategy, op->unrollFactor);
+                      op->output_race_strategy, op->unrollFactor,
+                      op->merge_strategy, op->prefetchDistance);
       } else {
         stmt = IndexStmt();
       }
@@ -1135,6 +1232,15 @@ IndexStmt SetAssembleStrategy::apply(IndexStmt stmt, string* reason) const {
       stmt = IndexStmt();
     }
 
+    void visit(const LiteralNode* op) {
+      // Attribute queries are computed over the structure of the operands, so 
+      // literals are replaced by whether they are nonzero.
+      const auto bytes = static_cast<const char*>(op->val);
+      const auto numBytes = op->getDataType().getNumBytes();
+      expr = Literal(std::any_of(bytes, bytes + numBytes, 
+                                 [](char byte) { return byte != 0; }));
+    }
+
     void visit(const AccessNode* op) {
       if (util::contains(arguments, op->tensorVar)) {
         expr = Access(op->tensorVar, op->indexVars, op->packageModifiers(),
@@ -1245,7 +1351,8 @@ IndexStmt SetAssembleStrategy::apply(IndexStmt stmt, string* reason) const {
         stmt = op;
       } else if (s.defined()) {
         stmt = new ForallNode(op->indexVar, s, op->parallel_unit, 
-                              op->output_race_strategy, op->unrollFactor);
+                              op->output_race_strategy, op->unrollFactor,
+                              op->merge_strategy, op->prefetchDistance);
       } else {
         stmt = IndexStmt();
       }
@@ -1291,7 +1398,7 @@ std::ostream& operator<<(std::ostream& os,
 
 // Autoscheduling functions
 
-IndexStmt parallelizeOuterLoop(IndexStmt stmt) {
+IndexStmt parallelizeOuterLoop(IndexStmt stmt, bool balanceNonzeros) {
   // get outer ForAll
   Forall forall;
   bool matched = false;
@@ -1328,6 +1435,29 @@ IndexStmt parallelizeOuterLoop(IndexStmt stmt) {
     return parallelized256;
   }
   else {
+    // Parallelizing loops that append to results requires assembling the 
+    // results in two phases, which is only worth it when explicitly requested.
+    const auto assembledByInsertion = getAssembledByUngroupedInsertion(stmt);
+    for (const auto& result : getResults(stmt)) {
+      if (util::contains(assembledByInsertion, result)) {
+        continue;
+      }
+      for (const auto& modeFormat : result.getFormat().getModeFormats()) {
+        if (!modeFormat.hasInsert()) {
+          return stmt;
+        }
+      }
+    }
+
+    if (balanceNonzeros) {
+      IndexStmt balanced = Parallelize(forall.getIndexVar(), 
+                                       ParallelUnit::CPUThreadMergePath, 
+                                       OutputRaceStrategy::NoRaces).apply(stmt);
+      if (balanced != IndexStmt()) {
+        return balanced;
+      }
+    }
+
     IndexStmt parallelized = Parallelize(forall.getIndexVar(), ParallelUnit::CPUThread, OutputRaceStrategy::NoRaces).apply(stmt, &reason);
     if (parallelized == IndexStmt()) {
       // can't parallelize
@@ -1443,6 +1573,8 @@ IndexStmt reorderLoopsTopologically(IndexStmt stmt) {
     IndexStmt innerBody;
     map <IndexVar, ParallelUnit> forallParallelUnit;
     map <IndexVar, OutputRaceStrategy> forallOutputRaceStrategy;
+    map <IndexVar, MergeStrategy> forallMergeStrategy;
+    map <IndexVar, size_t> forallPrefetchDistance;
     vector<IndexVar> indexVarOriginalOrder;
     Iterators iterators;
 
@@ -1456,6 +1588,8 @@ IndexStmt reorderLoopsTopologically(IndexStmt stmt) {
       indexVarOriginalOrder.push_back(i);
       forallParallelUnit[i] = foralli.getParallelUnit();
       forallOutputRaceStrategy[i] = foralli.getOutputRaceStrategy();
+      forallMergeStrategy[i] = foralli.getMergeStrategy();
+      forallPrefetchDistance[i] = foralli.getPrefetchDistance();
 
       // Iterator and if Iterator enforces constraints
       vector<pair<Iterator, bool>> depIterators;
@@ -1538,12 +1672,18 @@ IndexStmt reorderLoopsTopologically(IndexStmt stmt) {
     IndexStmt innerBody;
     const map <IndexVar, ParallelUnit> forallParallelUnit;
     const map <IndexVar, OutputRaceStrategy> forallOutputRaceStrategy;
+    const map <IndexVar, MergeStrategy> forallMergeStrategy;
+    const map <IndexVar, size_t> forallPrefetchDistance;
 
     TopoReorderRewriter(const vector<IndexVar>& sortedVars, IndexStmt innerBody,
                         const map <IndexVar, ParallelUnit> forallParallelUnit,
-                        const map <IndexVar, OutputRaceStrategy> forallOutputRaceStrategy)
+                        const map <IndexVar, OutputRaceStrategy> forallOutputRaceStrategy,
+                        const map <IndexVar, MergeStrategy> forallMergeStrategy,
+                        const map <IndexVar, size_t> forallPrefetchDistance)
         : sortedVars(sortedVars), innerBody(innerBody),
-        forallParallelUnit(forallParallelUnit), forallOutputRaceStrategy(forallOutputRaceStrategy)  {
+        forallParallelUnit(forallParallelUnit), forallOutputRaceStrategy(forallOutputRaceStrategy),
+        forallMergeStrategy(forallMergeStrategy),
+        forallPrefetchDistance(forallPrefetchDistance)  {
     }
 
     void visit(const ForallNode* node) {
@@ -1554,14 +1694,16 @@ IndexStmt reorderLoopsTopologically(IndexStmt stmt) {
       taco_iassert(util::contains(sortedVars, i));
       stmt = innerBody;
       for (auto it = sortedVars.rbegin(); it != sortedVars.rend(); ++it) {
-        stmt = forall(*it, stmt, forallParallelUnit.at(*it), forallOutputRaceStrategy.at(*it), foralli.getUnrollFactor());
+        stmt = forall(*it, stmt, forallParallelUnit.at(*it), forallOutputRaceStrategy.at(*it), foralli.getUnrollFactor(), forallMergeStrategy.at(*it), forallPrefetchDistance.at(*it));
       }
       return;
     }
 
   };
   TopoReorderRewriter rewriter(sortedVars, dagBuilder.innerBody, 
-                               dagBuilder.forallParallelUnit, dagBuilder.forallOutputRaceStrategy);
+                               dagBuilder.forallParallelUnit, dagBuilder.forallOutputRaceStrategy,
+                               dagBuilder.forallMergeStrategy,
+                               dagBuilder.forallPrefetchDistance);
   return rewriter.rewrite(stmt);
 }
 
@@ -1701,7 +1843,9 @@ IndexStmt scalarPromote(IndexStmt stmt, ProvenanceGraph provGraph,
       }
 
       stmt = forall(i, body, foralli.getParallelUnit(),
-                    foralli.getOutputRaceStrategy(), foralli.getUnrollFactor());
+                    foralli.getOutputRaceStrategy(), foralli.getUnrollFactor(),
+                    foralli.getMergeStrategy(),
+                    foralli.getPrefetchDistance());
       for (const auto& consumer : consumers) {
         stmt = where(consumer, stmt);
       }
@@ -644,7 +644,8 @@ Stmt Switch::make(std::vector<std::pair<Expr,Stmt>> cases, Expr controlExpr) {
 
 // For loop
 Stmt For::make(Expr var, Expr start, Expr end, Expr increment, Stmt body,
-  LoopKind kind, ParallelUnit parallel_unit, size_t unrollFactor, int vec_width) {
+  LoopKind kind, ParallelUnit parallel_unit, size_t unrollFactor, int vec_width,
+  std::vector<Expr> reductionVars) {
   For *loop = new For;
   loop->var = var;
   loop->start = start;
@@ -655,6 +656,7 @@ Stmt For::make(Expr var, Expr start, Expr end, Expr increment, Stmt body,
   loop->unrollFactor = unrollFactor;
   loop->vec_width = vec_width;
   loop->parallel_unit = parallel_unit;
+  loop->reductionVars = reductionVars;
   return loop;
 }
 
@@ -672,12 +674,13 @@ Stmt While::make(Expr cond, Stmt contents, LoopKind kind,
 // Function
 Stmt Function::make(std::string name,
                     std::vector<Expr> outputs, std::vector<Expr> inputs,
-                    Stmt body) {
+                    Stmt body, Expr status) {
   Function *func = new Function;
   func->name = name;
   func->body = Scope::make(body);
   func->inputs = inputs;
   func->outputs = outputs;
+  func->status = status;
   return func;
 }
 
@@ -824,6 +827,22 @@ Expr GetProperty::make(Expr tensor, TensorProperty property, int mode,
   return gp;
 }
 
+Expr GetProperty::make(Expr tensor, TensorProperty property, int mode,
+                       int index, std::string name, Datatype type) {
+  taco_iassert(property == TensorProperty::Indices)
+      << "Only index arrays may have a non-default element type";
+  taco_iassert(type.isInt() || type.isUInt())
+      << "Index arrays must have integer elements";
+  GetProperty* gp = new GetProperty;
+  gp->tensor = tensor;
+  gp->property = property;
+  gp->mode = mode;
+  gp->name = name;
+  gp->index = index;
+  gp->type = type;
+  return gp;
+}
+
 // Sort
 Stmt Sort::make(std::vector<Expr> args) {
   Sort* sort = new Sort;
@@ -831,6 +850,16 @@ Stmt Sort::make(std::vector<Expr> args) {
   return sort;
 }
 
+// Prefetch
+Stmt Prefetch::make(Expr arr, Expr loc) {
+  taco_iassert(loc.type().isInt() || loc.type().isUInt())
+      << "Can't prefetch from a non-integer offset";
+  Prefetch* prefetch = new Prefetch;
+  prefetch->arr = arr;
+  prefetch->loc = loc;
+  return prefetch;
+}
+
 
 // GetProperty
 Expr GetProperty::make(Expr tensor, TensorProperty property, int mode) {
@@ -971,6 +1000,8 @@ template<> void StmtNode<Sort>::accept(IRVisitorStrict *v)
   const { v->visit((const Sort*)this); }
 template<> void StmtNode<Break>::accept(IRVisitorStrict *v)
   const { v->visit((const Break*)this); }
+template<> void StmtNode<Prefetch>::accept(IRVisitorStrict *v)
+  const { v->visit((const Prefetch*)this); }
 
 // printing methods
 std::ostream& operator<<(std::ostream& os, const Stmt& stmt) {
@@ -261,7 +261,7 @@ void IRPrinter::visit(const IfThenElse* op) {
     doIndent();
     stream << "}";
   }
-  else if (isa<Assign>(scopedStmt)) {
+  else if (isa<Assign>(scopedStmt) && !to<Assign>(scopedStmt)->use_atomics) {
     int tmp = indent;
     indent = 0;
     stream << " ";
@@ -597,6 +597,18 @@ void IRPrinter::visit(const Sort* op) {
   stream << endl;
 }
 
+void IRPrinter::visit(const Prefetch* op) {
+  doIndent();
+  stream << "prefetch(&";
+  parentPrecedence = Precedence::LOAD;
+  op->arr.accept(this);
+  stream << "[";
+  parentPrecedence = Precedence::TOP;
+  op->loc.accept(this);
+  stream << "]);";
+  stream << endl;
+}
+
 
 void IRPrinter::resetNameCounters() {
   // seed the unique names with all C99 keywords
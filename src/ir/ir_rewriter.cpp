@@ -303,7 +303,8 @@ void IRRewriter::visit(const For* op) {
   }
   else {
     stmt = For::make(var, start, end, increment, contents, op->kind,
-                     op->parallel_unit, op->unrollFactor, op->vec_width);
+                     op->parallel_unit, op->unrollFactor, op->vec_width,
+                     op->reductionVars);
   }
 }
 
@@ -373,7 +374,7 @@ void IRRewriter::visit(const Function* op) {
     stmt = op;
   }
   else {
-    stmt = Function::make(op->name, outputs, inputs, body);
+    stmt = Function::make(op->name, outputs, inputs, body, op->status);
   }
 }
 
@@ -425,7 +426,8 @@ void IRRewriter::visit(const Allocate* op) {
     stmt = op;
   }
   else {
-    stmt = Allocate::make(var, num_elements, op->is_realloc, op->old_elements);
+    stmt = Allocate::make(var, num_elements, op->is_realloc, op->old_elements,
+                          op->clear);
   }
 }
 
@@ -478,6 +480,10 @@ void IRRewriter::visit(const GetProperty* op) {
   if (tensor == op->tensor) {
     expr = op;
   }
+  else if (op->property == TensorProperty::Indices) {
+    expr = GetProperty::make(tensor, op->property, op->mode, op->index,
+                             op->name, op->type);
+  }
   else {
     expr = GetProperty::make(tensor, op->property, op->mode, op->index, op->name);
   }
@@ -501,5 +507,16 @@ void IRRewriter::visit(const Sort* op) {
   }
 }
 
+void IRRewriter::visit(const Prefetch* op) {
+  Expr arr = rewrite(op->arr);
+  Expr loc = rewrite(op->loc);
+  if (arr == op->arr && loc == op->loc) {
+    stmt = op;
+  }
+  else {
+    stmt = Prefetch::make(arr, loc);
+  }
+}
+
 
 }}
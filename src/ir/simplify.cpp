@@ -2,6 +2,7 @@
 
 #include <map>
 #include <queue>
+#include <set>
 
 #include "taco/ir/ir.h"
 #include "taco/ir/ir_visitor.h"
@@ -620,6 +621,9 @@ ir::Stmt simplify(const ir::Stmt& stmt) {
       void visit(const Break *op) {
         stmt = Stmt();
       }
+      void visit(const Prefetch *op) {
+        stmt = Stmt();
+      }
     };
 
     struct CheckModified : public IRVisitor {
@@ -721,4 +725,562 @@ ir::Stmt simplify(const ir::Stmt& stmt) {
   return simplifiedStmt;
 }
 
+// Integer arithmetic over variables, tensor dimensions and integer literals
+// (and loads if `allowLoads` is true).  Such expressions, other than loads,
+// cannot trap and can therefore be evaluated speculatively.
+static bool isIntArithmetic(Expr expr, bool allowLoads) {
+  if (!expr.type().isInt() && !expr.type().isUInt()) {
+    return false;
+  }
+  if (isa<Var>(expr)) {
+    return !to<Var>(expr)->is_ptr;
+  }
+  if (isa<GetProperty>(expr)) {
+    return to<GetProperty>(expr)->property == TensorProperty::Dimension;
+  }
+  if (isa<Literal>(expr)) {
+    return true;
+  }
+  if (isa<Add>(expr)) {
+    return isIntArithmetic(to<Add>(expr)->a, allowLoads) &&
+           isIntArithmetic(to<Add>(expr)->b, allowLoads);
+  }
+  if (isa<Sub>(expr)) {
+    return isIntArithmetic(to<Sub>(expr)->a, allowLoads) &&
+           isIntArithmetic(to<Sub>(expr)->b, allowLoads);
+  }
+  if (isa<Mul>(expr)) {
+    return isIntArithmetic(to<Mul>(expr)->a, allowLoads) &&
+           isIntArithmetic(to<Mul>(expr)->b, allowLoads);
+  }
+  if (isa<Neg>(expr)) {
+    return isIntArithmetic(to<Neg>(expr)->a, allowLoads);
+  }
+  if (isa<Cast>(expr)) {
+    return isIntArithmetic(to<Cast>(expr)->a, allowLoads);
+  }
+  if (isa<Load>(expr)) {
+    const auto load = to<Load>(expr);
+    return allowLoads && (isa<Var>(load->arr) || isa<GetProperty>(load->arr)) &&
+           isIntArithmetic(load->loc, allowLoads);
+  }
+  return false;
+}
+
+// Structural equality of the expressions accepted by `isIntArithmetic`, where
+// variables are only equal to themselves.
+static bool isSameExpr(Expr a, Expr b) {
+  if (a == b) {
+    return true;
+  }
+  if (a.type() != b.type()) {
+    return false;
+  }
+  if (isa<GetProperty>(a) && isa<GetProperty>(b)) {
+    const auto propa = to<GetProperty>(a);
+    const auto propb = to<GetProperty>(b);
+    return propa->tensor == propb->tensor && 
+           propa->property == propb->property && 
+           propa->mode == propb->mode && propa->index == propb->index;
+  }
+  if (isa<Literal>(a) && isa<Literal>(b)) {
+    const auto lita = to<Literal>(a);
+    const auto litb = to<Literal>(b);
+    return lita->type.isInt() ? lita->getIntValue() == litb->getIntValue() 
+                              : lita->getUIntValue() == litb->getUIntValue();
+  }
+  if (isa<Add>(a) && isa<Add>(b)) {
+    return isSameExpr(to<Add>(a)->a, to<Add>(b)->a) &&
+           isSameExpr(to<Add>(a)->b, to<Add>(b)->b);
+  }
+  if (isa<Sub>(a) && isa<Sub>(b)) {
+    return isSameExpr(to<Sub>(a)->a, to<Sub>(b)->a) &&
+           isSameExpr(to<Sub>(a)->b, to<Sub>(b)->b);
+  }
+  if (isa<Mul>(a) && isa<Mul>(b)) {
+    return isSameExpr(to<Mul>(a)->a, to<Mul>(b)->a) &&
+           isSameExpr(to<Mul>(a)->b, to<Mul>(b)->b);
+  }
+  if (isa<Neg>(a) && isa<Neg>(b)) {
+    return isSameExpr(to<Neg>(a)->a, to<Neg>(b)->a);
+  }
+  if (isa<Cast>(a) && isa<Cast>(b)) {
+    return isSameExpr(to<Cast>(a)->a, to<Cast>(b)->a);
+  }
+  if (isa<Load>(a) && isa<Load>(b)) {
+    return isSameExpr(to<Load>(a)->arr, to<Load>(b)->arr) &&
+           isSameExpr(to<Load>(a)->loc, to<Load>(b)->loc);
+  }
+  return false;
+}
+
+// The variables and arrays an expression reads, and whether it multiplies two
+// operands that are not both literals.
+struct ExprOperands : public IRVisitor {
+  std::vector<Expr> operands;
+  bool hasLoads = false;
+  bool hasMul = false;
+
+  using IRVisitor::visit;
+
+  ExprOperands(Expr expr) {
+    expr.accept(this);
+  }
+
+  void visit(const Var* op) {
+    operands.push_back(op);
+  }
+
+  void visit(const GetProperty* op) {
+    operands.push_back(op);
+  }
+
+  void visit(const Load* op) {
+    hasLoads = true;
+    IRVisitor::visit(op);
+  }
+
+  void visit(const Mul* op) {
+    hasMul = hasMul || !isa<Literal>(op->a) || !isa<Literal>(op->b);
+    IRVisitor::visit(op);
+  }
+};
+
+// The variables and arrays a statement writes, and whether it has other side
+// effects (e.g. calls) that might write arrays.
+struct StmtEffects : public IRVisitor {
+  std::vector<Expr> writes;
+  bool hasSideEffects = false;
+
+  using IRVisitor::visit;
+
+  StmtEffects(Stmt stmt) {
+    stmt.accept(this);
+  }
+
+  bool writesAny(const std::vector<Expr>& exprs) const {
+    for (auto& expr : exprs) {
+      for (auto& write : writes) {
+        if (isSameExpr(expr, write)) {
+          return true;
+        }
+      }
+    }
+    return false;
+  }
+
+  void visit(const VarDecl* op) {
+    writes.push_back(op->var);
+    IRVisitor::visit(op);
+  }
+
+  void visit(const Assign* op) {
+    writes.push_back(op->lhs);
+    IRVisitor::visit(op);
+  }
+
+  void visit(const For* op) {
+    writes.push_back(op->var);
+    IRVisitor::visit(op);
+  }
+
+  void visit(const Store* op) {
+    writes.push_back(op->arr);
+    IRVisitor::visit(op);
+  }
+
+  void visit(const Allocate* op) {
+    writes.push_back(op->var);
+    hasSideEffects = true;
+    IRVisitor::visit(op);
+  }
+
+  void visit(const Free* op) {
+    hasSideEffects = true;
+  }
+
+  void visit(const Call* op) {
+    hasSideEffects = true;
+    IRVisitor::visit(op);
+  }
+
+  void visit(const Sort* op) {
+    hasSideEffects = true;
+    IRVisitor::visit(op);
+  }
+
+  void visit(const Yield* op) {
+    hasSideEffects = true;
+    IRVisitor::visit(op);
+  }
+};
+
+// Names a variable that stores an expression after the (first few distinct)
+// variables, tensor properties and literals it combines, e.g.
+// `i_B2_dimension` for `i * B2_dimension`.
+static std::string nameOf(Expr expr) {
+  struct CollectNames : public IRVisitor {
+    std::vector<std::string> names;
+
+    using IRVisitor::visit;
+
+    void add(std::string name) {
+      if (names.size() < 3 && !util::contains(names, name)) {
+        names.push_back(name);
+      }
+    }
+
+    void visit(const Var* op) {
+      add(op->name);
+    }
+
+    void visit(const GetProperty* op) {
+      add(op->name);
+    }
+
+    void visit(const Literal* op) {
+      add(util::toString(Expr(op)));
+    }
+  };
+  CollectNames collectNames;
+  expr.accept(&collectNames);
+  return util::join(collectNames.names, "_");
+}
+
+// The names of all variables in a statement and the number of times each
+// variable is declared or assigned (loop variables and assignments count
+// twice, since they update the variable).
+struct VarUses : public IRVisitor {
+  std::set<std::string> names;
+  std::map<Expr,int> writes;
+
+  using IRVisitor::visit;
+
+  VarUses(Stmt stmt) {
+    stmt.accept(this);
+  }
+
+  void visit(const Var* op) {
+    names.insert(op->name);
+  }
+
+  void visit(const VarDecl* op) {
+    writes[op->var]++;
+    IRVisitor::visit(op);
+  }
+
+  void visit(const Assign* op) {
+    writes[op->lhs] += 2;
+    IRVisitor::visit(op);
+  }
+
+  void visit(const For* op) {
+    writes[op->var] += 2;
+    IRVisitor::visit(op);
+  }
+};
+
+// Replaces the loads of an array location with a variable that stores it.
+struct ReplaceLoad : public IRRewriter {
+  Expr load;
+  Expr var;
+
+  using IRRewriter::visit;
+
+  ReplaceLoad(Expr load, Expr var) : load(load), var(var) {
+  }
+
+  void visit(const Load* op) {
+    if (isSameExpr(op, load)) {
+      expr = var;
+      return;
+    }
+    IRRewriter::visit(op);
+  }
+};
+
+// Hoists loop-invariant integer arithmetic out of for loops.  Arithmetic is
+// only hoisted if it multiplies (e.g. to compute the locations of dense
+// components or to recover split index variables), since the C compiler
+// cannot always prove that it is loop invariant; loop bounds are also hoisted
+// if they load (e.g. `pos[i+1]`), since they are evaluated at least once.
+struct LoopInvariantHoister : public IRRewriter {
+  using IRRewriter::visit;
+
+  // Variables of the function, which hoisted variables must not shadow
+  VarUses* uses;
+
+  // Effects of the body of the loop whose invariants are being hoisted
+  const StmtEffects* loopEffects = nullptr;
+  std::vector<std::pair<Expr,Expr>> hoisted;
+
+  // The right-hand side of a declaration that must not be replaced by a copy
+  Expr keep;
+
+  LoopInvariantHoister(VarUses* uses) : uses(uses) {
+  }
+
+  Expr hoist(Expr expr, std::string name) {
+    for (auto& invariant : hoisted) {
+      if (isSameExpr(invariant.first, expr)) {
+        return invariant.second;
+      }
+    }
+    std::string uniqueName = name;
+    for (int i = 0; util::contains(uses->names, uniqueName); i++) {
+      uniqueName = name + std::to_string(i);
+    }
+    uses->names.insert(uniqueName);
+    Expr var = Var::make(uniqueName, expr.type());
+    uses->writes[var] = 1;
+    hoisted.push_back({expr, var});
+    return var;
+  }
+
+  bool isInvariant(Expr expr, bool allowLoads) {
+    if (loopEffects == nullptr || !isIntArithmetic(expr, allowLoads)) {
+      return false;
+    }
+    ExprOperands operands(expr);
+    return !loopEffects->writesAny(operands.operands) &&
+           (!operands.hasLoads || !loopEffects->hasSideEffects);
+  }
+
+  template <typename T>
+  void hoistOrRewrite(const T* op) {
+    if (Expr(op) != keep && isInvariant(op, false) && ExprOperands(op).hasMul) {
+      expr = hoist(op, nameOf(op));
+      return;
+    }
+    IRRewriter::visit(op);
+  }
+
+  void visit(const Add* op) {
+    hoistOrRewrite(op);
+  }
+
+  void visit(const Sub* op) {
+    hoistOrRewrite(op);
+  }
+
+  void visit(const Mul* op) {
+    hoistOrRewrite(op);
+  }
+
+  void visit(const Neg* op) {
+    hoistOrRewrite(op);
+  }
+
+  void visit(const Cast* op) {
+    hoistOrRewrite(op);
+  }
+
+  // Variables that are declared more than once (e.g. in both branches of a
+  // split loop) cannot be copies, since copy propagation does not distinguish
+  // between their declarations
+  void visit(const VarDecl* op) {
+    Expr outerKeep = keep;
+    if (uses->writes[op->var] != 1) {
+      keep = op->rhs;
+    }
+    IRRewriter::visit(op);
+    keep = outerKeep;
+  }
+
+  void visit(const For* op) {
+    StmtEffects effects(op->contents);
+    effects.writes.push_back(op->var);
+
+    LoopInvariantHoister bodyHoister(uses);
+    bodyHoister.loopEffects = &effects;
+    Stmt contents = bodyHoister.rewrite(op->contents);
+
+    Expr end = op->end;
+    if (bodyHoister.isInvariant(end, true)) {
+      ExprOperands operands(end);
+      if (operands.hasLoads || operands.hasMul) {
+        end = bodyHoister.hoist(end, util::toString(op->var) + "_end");
+        if (isa<Load>(op->end)) {
+          contents = ReplaceLoad(op->end, end).rewrite(contents);
+        }
+      }
+    }
+
+    // The hoisted expressions might be invariant in the enclosing loop too
+    std::vector<Stmt> stmts;
+    for (auto& invariant : bodyHoister.hoisted) {
+      stmts.push_back(VarDecl::make(invariant.second, 
+                                    rewrite(invariant.first)));
+    }
+    Expr start = rewrite(op->start);
+    end = rewrite(end);
+    Expr increment = rewrite(op->increment);
+    if (stmts.empty() && contents == op->contents && start == op->start && 
+        end == op->end && increment == op->increment) {
+      stmt = op;
+      return;
+    }
+    Stmt loop = For::make(op->var, start, end, increment, contents, op->kind,
+                          op->parallel_unit, op->unrollFactor, op->vec_width,
+                          op->reductionVars);
+    if (stmts.empty()) {
+      stmt = loop;
+      return;
+    }
+    stmts.push_back(loop);
+    stmt = Block::make(stmts);
+  }
+};
+
+// Collects the names of variables that are declared more than once, since a
+// reference to such a variable may resolve to a different declaration in a
+// nested scope.
+struct RedeclaredNames : public IRVisitor {
+  std::set<std::string> declared;
+  std::set<std::string> redeclared;
+
+  using IRVisitor::visit;
+
+  RedeclaredNames(Stmt stmt) {
+    stmt.accept(this);
+  }
+
+  void declare(Expr var) {
+    if (isa<Var>(var) && !declared.insert(to<Var>(var)->name).second) {
+      redeclared.insert(to<Var>(var)->name);
+    }
+  }
+
+  void visit(const VarDecl* op) {
+    declare(op->var);
+    IRVisitor::visit(op);
+  }
+
+  void visit(const For* op) {
+    declare(op->var);
+    IRVisitor::visit(op);
+  }
+};
+
+// Reuses the values of variables declared earlier in the same block with the
+// same integer arithmetic, e.g. the locations of components of two tensors
+// with the same dense dimensions.
+struct CommonSubexpressionEliminator : public IRRewriter {
+  using IRRewriter::visit;
+
+  std::set<std::string> redeclared;
+  std::map<Expr,int> writes;
+
+  CommonSubexpressionEliminator(Stmt stmt,
+                                const std::set<std::string>& redeclared)
+      : redeclared(redeclared), writes(VarUses(stmt).writes) {
+  }
+
+  // Nested blocks do not open scopes, so they are flattened into one sequence
+  static void flatten(const Block* op, std::vector<Stmt>* contents) {
+    for (auto& content : op->contents) {
+      if (isa<Block>(content)) {
+        flatten(to<Block>(content), contents);
+      } else {
+        contents->push_back(content);
+      }
+    }
+  }
+
+  void visit(const Block* op) {
+    std::vector<Stmt> flattened;
+    flatten(op, &flattened);
+
+    std::vector<std::pair<Expr,Expr>> available;
+    std::vector<Stmt> contents;
+    bool modified = flattened.size() != op->contents.size();
+    for (auto& content : flattened) {
+      Stmt rewritten = rewrite(content);
+      if (!rewritten.defined()) {
+        modified = modified || content.defined();
+        continue;
+      }
+      if (isa<VarDecl>(rewritten) &&
+          writes[to<VarDecl>(rewritten)->var] == 1) {
+        const auto decl = to<VarDecl>(rewritten);
+        for (auto& value : available) {
+          if (isSameExpr(value.first, decl->rhs)) {
+            rewritten = VarDecl::make(decl->var, value.second);
+            break;
+          }
+        }
+      }
+      modified = modified || (rewritten != content);
+      contents.push_back(rewritten);
+
+      // Invalidate the values that depend on variables this statement writes
+      StmtEffects effects(rewritten);
+      std::vector<std::pair<Expr,Expr>> stillAvailable;
+      for (auto& value : available) {
+        ExprOperands operands(value.first);
+        operands.operands.push_back(value.second);
+        if (!effects.writesAny(operands.operands)) {
+          stillAvailable.push_back(value);
+        }
+      }
+      available = stillAvailable;
+
+      if (isa<VarDecl>(rewritten)) {
+        const auto decl = to<VarDecl>(rewritten);
+        if (!isa<Var>(decl->rhs) && !isa<Literal>(decl->rhs) &&
+            isIntArithmetic(decl->rhs, false) &&
+            !util::contains(redeclared, to<Var>(decl->var)->name)) {
+          available.push_back({decl->rhs, decl->var});
+        }
+      }
+    }
+    stmt = modified ? Block::make(contents) : op;
+  }
+};
+
+// Removes the copies `int x = y` left behind by the passes above, where
+// neither `x` nor `y` is ever reassigned, by replacing uses of `x` with `y`.
+struct CopyFolder : public IRRewriter {
+  using IRRewriter::visit;
+
+  std::map<Expr,int> writes;
+  std::set<std::string> redeclared;
+  std::map<Expr,Expr> copies;
+
+  CopyFolder(Stmt stmt, const std::set<std::string>& redeclared)
+      : writes(VarUses(stmt).writes), redeclared(redeclared) {
+  }
+
+  bool isFoldable(Expr var) {
+    return isa<Var>(var) && !to<Var>(var)->is_ptr &&
+           (!util::contains(writes, var) || writes.at(var) == 1) &&
+           !util::contains(redeclared, to<Var>(var)->name);
+  }
+
+  void visit(const Var* op) {
+    Expr var = op;
+    expr = util::contains(copies, var) ? copies.at(var) : var;
+  }
+
+  void visit(const VarDecl* op) {
+    Expr rhs = rewrite(op->rhs);
+    if (isa<Var>(rhs) && rhs.type() == op->var.type() &&
+        isFoldable(op->var) && isFoldable(rhs)) {
+      copies.insert({op->var, rhs});
+      stmt = Stmt();
+      return;
+    }
+    stmt = (rhs == op->rhs) ? op : VarDecl::make(op->var, rhs);
+  }
+};
+
+ir::Stmt hoistLoopInvariants(const ir::Stmt& stmt) {
+  VarUses uses(stmt);
+  Stmt hoisted = LoopInvariantHoister(&uses).rewrite(stmt);
+  RedeclaredNames names(hoisted);
+  Stmt eliminated =
+      CommonSubexpressionEliminator(hoisted, names.redeclared).rewrite(hoisted);
+  return CopyFolder(eliminated, names.redeclared).rewrite(eliminated);
+}
+
 }}
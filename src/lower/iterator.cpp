@@ -227,6 +227,18 @@ bool Iterator::hasPosIter() const {
   return getMode().defined() && getMode().getModeFormat().hasCoordPosIter();
 }
 
+bool Iterator::hasBitmapIter() const {
+  taco_iassert(defined());
+  if (isDimensionIterator()) return false;
+  return getMode().defined() && getMode().getModeFormat().isBitmap();
+}
+
+bool Iterator::hasChunkIter() const {
+  taco_iassert(defined());
+  if (isDimensionIterator()) return false;
+  return getMode().defined() && getMode().getModeFormat().getChunkSize() > 0;
+}
+
 bool Iterator::hasLocate() const {
   taco_iassert(defined());
   if (isDimensionIterator()) return false;
@@ -290,6 +302,27 @@ ModeFunction Iterator::posAccess(const ir::Expr& pos,
   return getMode().getModeFormat().impl->posIterAccess(pos, coords, getMode());
 }
 
+ModeFunction Iterator::bitmapBounds(const ir::Expr& parentPos) const {
+  taco_iassert(defined() && content->mode.defined());
+  return getMode().getModeFormat().impl->bitmapIterBounds(parentPos, 
+                                                          getMode());
+}
+
+ModeFunction Iterator::chunkBounds(const ir::Expr& chunk, 
+                                   const ir::Expr& numSegments) const {
+  taco_iassert(defined() && content->mode.defined());
+  return getMode().getModeFormat().impl->chunkIterBounds(chunk, numSegments,
+                                                         getMode());
+}
+
+ModeFunction Iterator::chunkAccess(const ir::Expr& chunk, const ir::Expr& lane,
+                                   const ir::Expr& numSegments) const {
+  taco_iassert(defined() && content->mode.defined());
+  return getMode().getModeFormat().impl->chunkIterAccess(chunk, lane, 
+                                                         numSegments, 
+                                                         getMode());
+}
+
 ModeFunction Iterator::locate(const std::vector<ir::Expr>& coords) const {
   taco_iassert(defined() && content->mode.defined());
   return getMode().getModeFormat().impl->locate(getParent().getPosVar(),
@@ -381,6 +414,21 @@ Stmt Iterator::getSeqInsertEdge(const Expr& parentPos,
                                                           queries, getMode());
 }
 
+Stmt Iterator::getParInsertEdge(const Expr& parentPos, 
+    const std::vector<Expr>& coords, 
+    const std::vector<AttrQueryResult>& queries) const {
+  taco_iassert(defined() && content->mode.defined());
+  return getMode().getModeFormat().impl->getParInsertEdge(parentPos, coords, 
+                                                          queries, getMode());
+}
+
+Stmt Iterator::getParFinalizeEdges(const Expr& prevSize, 
+    const std::vector<AttrQueryResult>& queries) const {
+  taco_iassert(defined() && content->mode.defined());
+  return getMode().getModeFormat().impl->getParFinalizeEdges(prevSize, queries,
+                                                             getMode());
+}
+
 Stmt Iterator::getInitCoords(const Expr& prevSize, 
     const std::vector<AttrQueryResult>& queries) const {
   taco_iassert(defined() && content->mode.defined());
@@ -583,9 +631,13 @@ void Iterators::createAccessIterators(Access access, Format format, Expr tensorI
     taco_iassert(modeTypePack.getModeFormats().size() > 0);
 
     int modeNumber = format.getModeOrdering()[level-1];
+    vector<Datatype> arrayTypes;
+    if ((size_t)level <= format.getLevelArrayTypes().size()) {
+      arrayTypes = format.getLevelArrayTypes()[level-1];
+    }
     ModePack modePack(modeTypePack.getModeFormats().size(),
                       modeTypePack.getModeFormats()[0], tensorIR,
-                      modeNumber, level);
+                      modeNumber, level, arrayTypes);
 
     int pos = 0;
     for (auto& modeType : modeTypePack.getModeFormats()) {
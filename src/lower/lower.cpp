@@ -4,6 +4,7 @@
 #include <vector>
 #include <list>
 #include <set>
+#include <atomic>
 #include <map>
 
 #include "taco/index_notation/index_notation.h"
@@ -83,4 +84,14 @@ bool isLowerable(IndexStmt stmt, std::string* reason) {
   return true;
 }
 
+static std::atomic<bool> persistentWorkspacesEnabled(true);
+
+void setPersistentWorkspacesEnabled(bool enabled) {
+  persistentWorkspacesEnabled = enabled;
+}
+
+bool shouldUsePersistentWorkspaces() {
+  return persistentWorkspacesEnabled;
+}
+
 }
@@ -1,6 +1,7 @@
 #include <taco/lower/mode_format_compressed.h>
 #include "taco/lower/lowerer_impl_imperative.h"
 #include "taco/lower/lowerer_impl.h"
+#include "taco/lower/lower.h"
 
 #include "taco/index_notation/index_notation.h"
 #include "taco/index_notation/index_notation_nodes.h"
@@ -10,11 +11,13 @@
 #include "taco/ir/ir.h"
 #include "ir/ir_generators.h"
 #include "taco/ir/ir_visitor.h"
+#include "taco/ir/ir_rewriter.h"
 #include "taco/ir/simplify.h"
 #include "taco/lower/iterator.h"
 #include "taco/lower/merge_lattice.h"
 #include "mode_access.h"
 #include "taco/util/collections.h"
+#include "taco/error/error_messages.h"
 #include "taco/ir/workspace_rewriter.h"
 
 using namespace std;
@@ -66,6 +69,61 @@ private:
   }
 };
 
+/// Results that parallel loops with the Temporary output race strategy race to 
+/// reduce into are copied per thread if they have at most this many components.
+static const long long MAX_PRIVATIZED_RESULT_SIZE = 1 << 20;
+
+/// Results that parallel loops with the Atomics output race strategy race to 
+/// reduce into are copied per thread, instead of updated with atomics, if they 
+/// have at most this many components.
+static const long long MAX_ATOMICS_PRIVATIZED_RESULT_SIZE = 1 << 12;
+
+/// Loops that are parallelized with merge-path partitioning are split into 
+/// tiles of this many row ends and nonzeros.
+static const int MERGE_PATH_TILE_SIZE = 1 << 12;
+
+/// Returns the block size of the level that stores the given tensor mode, or
+/// 0 if the mode is not stored as fixed-size dense blocks.
+static int getBlockSize(const Format& format, int mode) {
+  for (int level = 0; level < format.getOrder(); ++level) {
+    if (format.getModeOrdering()[level] == mode) {
+      return format.getModeFormats()[level].getBlockSize();
+    }
+  }
+  return 0;
+}
+
+/// Returns the distance between consecutive positions of a position iterator
+/// (see `ModeFormatImpl::posIterBounds`).
+static Expr getPosStride(const ModeFunction& posBounds) {
+  return (posBounds.numResults() > 2) ? posBounds[2] : ir::Literal::make(1);
+}
+
+static bool hasUnitPosStride(const Iterator& iterator) {
+  if (!iterator.hasPosIter()) {
+    return true;
+  }
+  Expr stride = getPosStride(iterator.posBounds(iterator.getParent().getPosVar()));
+  return isa<ir::Literal>(stride) && to<ir::Literal>(stride)->equalsScalar(1);
+}
+
+/// Returns true if `expr` is zero whenever `access` is zero, i.e. if the access
+/// is a factor of the expression.
+static bool isAnnihilatedBy(IndexExpr expr, const AccessNode* access) {
+  if (expr.ptr == access) {
+    return true;
+  }
+  if (isa<taco::Mul>(expr)) {
+    const auto mul = to<taco::Mul>(expr);
+    return isAnnihilatedBy(mul.getA(), access) || 
+           isAnnihilatedBy(mul.getB(), access);
+  }
+  if (isa<taco::Neg>(expr)) {
+    return isAnnihilatedBy(to<taco::Neg>(expr).getA(), access);
+  }
+  return false;
+}
+
 LowererImplImperative::LowererImplImperative() : visitor(new Visitor(this)) {
 }
 
@@ -209,6 +267,40 @@ LowererImplImperative::lower(IndexStmt stmt, string name,
   this->compute = compute;
   definedIndexVarsOrdered = {};
   definedIndexVars = {};
+  usePersistentWorkspaces = shouldUsePersistentWorkspaces() &&
+                            !should_use_CUDA_codegen();
+  persistentWorkspaceSlots = {};
+  numPersistentWorkspaces = {};
+  status = Expr();
+
+  // Lower vector temporaries declared with a bitmap format as dense workspaces
+  // whose bit guard is a bitmap, and those declared with a hashed format as
+  // workspaces whose values are stored in hash table slots
+  bitmapWorkspaces = {};
+  hashedWorkspaces = {};
+  hashedWorkspaceSlots = {};
+  map<TensorVar,TensorVar> sparseWorkspaceVars;
+  for (auto& temporary : getTemporaries(stmt)) {
+    if (temporary.getOrder() != 1) {
+      continue;
+    }
+    const ModeFormat modeFormat = temporary.getFormat().getModeFormats()[0];
+    if (modeFormat.isBitmap()) {
+      TensorVar workspace(temporary.getName(), temporary.getType(), Dense);
+      sparseWorkspaceVars.insert({temporary, workspace});
+      bitmapWorkspaces.insert(workspace);
+    }
+    else if (modeFormat.getHashCapacity() > 0) {
+      TensorVar workspace(temporary.getName(), temporary.getType(), Dense);
+      sparseWorkspaceVars.insert({temporary, workspace});
+      hashedWorkspaces.insert({workspace, modeFormat.getHashCapacity()});
+      hashedWorkspaceSlots.insert({workspace, 
+          Var::make(temporary.getName() + "_slot", Int32)});
+    }
+  }
+  if (!sparseWorkspaceVars.empty()) {
+    stmt = replace(stmt, sparseWorkspaceVars);
+  }
 
   // Create result and parameter variables
   vector<TensorVar> results = getResults(stmt);
@@ -342,6 +434,31 @@ LowererImplImperative::lower(IndexStmt stmt, string name,
         }
       })
     );
+    // Modes stored as fixed-size dense blocks have compile-time extents, so
+    // loops over them get constant trip counts.
+    match(stmt,
+      function<void(const AccessNode*)>([&](const AccessNode* n) {
+        auto indexVars = n->indexVars;
+        if (!util::contains(indexVars, indexVar)) {
+          return;
+        }
+        int loc = (int)distance(indexVars.begin(),
+                                find(indexVars.begin(), indexVars.end(),
+                                     indexVar));
+        if (Access(n).isModeWindowed(loc) || Access(n).isModeIndexSet(loc)) {
+          return;
+        }
+        const int blockSize = getBlockSize(n->tensorVar.getFormat(), loc);
+        if (blockSize > 0) {
+          Dimension dim = n->tensorVar.getType().getShape().getDimension(loc);
+          taco_uassert(!dim.isFixed() || dim.getSize() == (size_t)blockSize)
+              << "Mode " << loc << " of " << n->tensorVar.getName() 
+              << " has size " << dim.getSize() 
+              << " but is stored in blocks of size " << blockSize;
+          dimension = ir::Literal::make(blockSize);
+        }
+      })
+    );
     dimensions.insert({indexVar, dimension});
     underivedBounds.insert({indexVar, {ir::Literal::make(0), dimension}});
   }
@@ -407,13 +524,39 @@ LowererImplImperative::lower(IndexStmt stmt, string name,
     }
   }
 
+  Stmt functionBody = Block::blanks(Block::make(header),
+                                    initializeResults,
+                                    body,
+                                    finalizeResults,
+                                    Block::make(footer));
+
+  // Check that variables split without tail guards divide evenly, and run the
+  // function only if they do
+  vector<Stmt> entryChecks;
+  for (auto& indexVar : provGraph.getAllIndexVars()) {
+    if (provGraph.getTailStrategy(indexVar) != TailStrategy::RoundUp ||
+        !provGraph.isUnderived(indexVar) ||
+        !util::contains(dimensions, indexVar)) {
+      continue;
+    }
+    Expr factor = ir::Literal::make((int)provGraph.getSplitFactor(indexVar));
+    Expr remainder = ir::Rem::make(dimensions.at(indexVar), factor);
+    entryChecks.push_back(IfThenElse::make(Neq::make(remainder, 0),
+                                           setStatus(KERNEL_SPLIT_REMAINDER)));
+  }
+  if (!entryChecks.empty()) {
+    functionBody = Block::make(Block::make(entryChecks),
+                               IfThenElse::make(Eq::make(status, 0),
+                                                functionBody));
+  }
+
+  // Declare the status if the function can fail
+  if (status.defined()) {
+    functionBody = Block::make(VarDecl::make(status, 0), functionBody);
+  }
+
   // Create function
-  return Function::make(name, resultsIR, argumentsIR,
-                        Block::blanks(Block::make(header),
-                                      initializeResults,
-                                      body,
-                                      finalizeResults,
-                                      Block::make(footer)));
+  return Function::make(name, resultsIR, argumentsIR, functionBody, status);
 }
 
 
@@ -441,7 +584,8 @@ Stmt LowererImplImperative::lowerAssignment(Assignment assignment)
       else {
         taco_iassert(isa<taco::Add>(assignment.getOperator()));
         bool useAtomics = markAssignsAtomicDepth > 0 &&
-                          !util::contains(whereTemps, result);
+                          !util::contains(whereTemps, result) &&
+                          !util::contains(parallelReducedResults, result);
         computeStmt = compoundAssign(var, rhs, useAtomics, atomicParallelUnit);
       }
     }
@@ -449,7 +593,8 @@ Stmt LowererImplImperative::lowerAssignment(Assignment assignment)
   // Assignments to tensor variables (non-scalar).
   else {
     Expr values = getValuesArray(result);
-    Expr loc = generateValueLocExpr(assignment.getLhs());
+    Expr loc = isHashedWorkspace(result) ? hashedWorkspaceSlots.at(result)
+                                         : generateValueLocExpr(assignment.getLhs());
 
     std::vector<Stmt> accessStmts;
 
@@ -485,8 +630,9 @@ Stmt LowererImplImperative::lowerAssignment(Assignment assignment)
         computeStmt = Store::make(values, loc, rhs);
       }
       else {
-        computeStmt = compoundStore(values, loc, rhs,
-                                    markAssignsAtomicDepth > 0,
+        bool useAtomics = markAssignsAtomicDepth > 0 &&
+                          !util::contains(parallelReducedResults, result);
+        computeStmt = compoundStore(values, loc, rhs, useAtomics,
                                     atomicParallelUnit);
       }
       taco_iassert(computeStmt.defined());
@@ -529,9 +675,34 @@ Stmt LowererImplImperative::lowerAssignment(Assignment assignment)
     Expr indexListSize = tempToIndexListSize.at(result);
 
     Stmt markBitGuardAsTrue = Store::make(bitGuardArr, loc, true);
+    Expr readBitGuard = Load::make(bitGuardArr, loc);
     Stmt trackIndex = Store::make(indexList, indexListSize, loc);
     Expr incrementSize = ir::Add::make(indexListSize, 1);
     Stmt incrementStmt = Assign::make(indexListSize, incrementSize);
+    Stmt locateSlot;
+    if (isHashedWorkspace(result)) {
+      // Hashed workspaces store values by slot, and their bit guard holds the 
+      // coordinate stored in each slot (or -1 if the slot is empty)
+      Expr coordinate = loc;
+      loc = hashedWorkspaceSlots.at(result);
+      locateSlot = VarDecl::make(loc, 
+          Call::make("taco_hashLocate", {bitGuardArr, 0, 
+                     hashedWorkspaces.at(result), coordinate}, Int32));
+      markBitGuardAsTrue = Store::make(bitGuardArr, loc, coordinate);
+      readBitGuard = Gte::make(Load::make(bitGuardArr, loc), 0);
+      trackIndex = Store::make(indexList, indexListSize, coordinate);
+    }
+    if (util::contains(bitmapWorkspaces, result)) {
+      // Bitmap workspaces are scanned instead of tracking an index list
+      Expr word = ir::Div::make(loc, 64);
+      Expr bit = ir::Call::make("taco_bit", {loc}, UInt64);
+      markBitGuardAsTrue = Store::make(bitGuardArr, word, 
+          BitOr::make(Load::make(bitGuardArr, word), bit));
+      readBitGuard = Neq::make(BitAnd::make(Load::make(bitGuardArr, word), bit),
+                               0);
+      trackIndex = Stmt();
+      incrementStmt = Stmt();
+    }
 
     Stmt firstWriteAtIndex = Block::make(trackIndex, markBitGuardAsTrue, incrementStmt);
     if (needComputeAssign && values.defined()) {
@@ -543,10 +714,19 @@ Stmt LowererImplImperative::lowerAssignment(Assignment assignment)
       }
       firstWriteAtIndex = Block::make(initialStorage, firstWriteAtIndex);
     }
+    if (isHashedWorkspace(result)) {
+      // A new coordinate may not take the last empty slot of the hash table,
+      // which locating coordinates that are not stored relies on
+      Expr fills = Call::make("taco_hashFills", {bitGuardArr, 0,
+                              hashedWorkspaces.at(result), loc}, Bool);
+      firstWriteAtIndex = IfThenElse::make(fills,
+                                           setStatus(KERNEL_HASH_TABLE_FULL),
+                                           firstWriteAtIndex);
+    }
 
-    Expr readBitGuard = Load::make(bitGuardArr, loc);
     computeStmt = IfThenElse::make(ir::Neg::make(readBitGuard),
                                    firstWriteAtIndex, computeStmt);
+    computeStmt = Block::make(locateSlot, computeStmt);
   }
 
   return assembleGuardTrivial ? computeStmt : IfThenElse::make(assembleGuard,
@@ -593,11 +773,27 @@ LowererImplImperative::splitAppenderAndInserters(const vector<Iterator>& results
 
 Stmt LowererImplImperative::lowerForall(Forall forall)
 {
+  if (partitionMergePaths && 
+      forall.getParallelUnit() == ParallelUnit::CPUThreadMergePath) {
+    return lowerForallMergePath(forall);
+  }
+
+  if (privatizeRacingResults && !should_use_CUDA_codegen() &&
+      forall.getParallelUnit() == ParallelUnit::CPUThread &&
+      (forall.getOutputRaceStrategy() == OutputRaceStrategy::Temporary ||
+       forall.getOutputRaceStrategy() == OutputRaceStrategy::Atomics)) {
+    return lowerForallPrivatized(forall);
+  }
+
   bool hasExactBound = provGraph.hasExactBound(forall.getIndexVar());
   bool forallNeedsUnderivedGuards = !hasExactBound && emitUnderivedGuards;
+  bool peelsTail = false;
+  for (const IndexVar& parent : provGraph.newlyRecoverableParents(forall.getIndexVar(), definedIndexVars)) {
+    peelsTail |= (provGraph.getTailStrategy(parent) == TailStrategy::Peel);
+  }
   if (!ignoreVectorize && forallNeedsUnderivedGuards &&
       (forall.getParallelUnit() == ParallelUnit::CPUVector ||
-       forall.getUnrollFactor() > 0)) {
+       forall.getUnrollFactor() > 0 || peelsTail)) {
     return lowerForallCloned(forall);
   }
 
@@ -611,7 +807,8 @@ Stmt LowererImplImperative::lowerForall(Forall forall)
     // place pos guard
     if (forallNeedsUnderivedGuards && provGraph.isCoordVariable(varToRecover) &&
         provGraph.getChildren(varToRecover).size() == 1 &&
-        provGraph.isPosVariable(provGraph.getChildren(varToRecover)[0])) {
+        provGraph.isPosVariable(provGraph.getChildren(varToRecover)[0]) &&
+        needsTailGuard(provGraph.getChildren(varToRecover)[0])) {
       IndexVar posVar = provGraph.getChildren(varToRecover)[0];
       std::vector<ir::Expr> iterBounds = provGraph.deriveIterBounds(posVar, definedIndexVarsOrdered, underivedBounds, indexVarToExprMap, iterators);
 
@@ -649,7 +846,7 @@ Stmt LowererImplImperative::lowerForall(Forall forall)
     // place underived guard
     std::vector<ir::Expr> iterBounds = provGraph.deriveIterBounds(varToRecover, definedIndexVarsOrdered, underivedBounds, indexVarToExprMap, iterators);
     if (forallNeedsUnderivedGuards && underivedBounds.count(varToRecover) &&
-        !provGraph.hasPosDescendant(varToRecover)) {
+        !provGraph.hasPosDescendant(varToRecover) && needsTailGuard(varToRecover)) {
 
       // FIXME: [Olivia] Check this with someone
       // Removed underived guard if indexVar is bounded is divisible by its split child indexVar
@@ -687,7 +884,9 @@ Stmt LowererImplImperative::lowerForall(Forall forall)
     // 3. Without an extra guard, the second chunk of 3 in the first group of 5
     // may attempt to perform an iteration for the second group of 5, which is
     // incorrect.
-    if (this->provGraph.isDivided(varToRecover)) {
+    // A predicated inner loop already stops at the end of its portion.
+    if (this->provGraph.isDivided(varToRecover) &&
+        !this->provGraph.isPredicatedTail(this->provGraph.getChildren(varToRecover)[1], definedIndexVarsOrdered)) {
       // Collect the children iteration variables.
       auto children = this->provGraph.getChildren(varToRecover);
       auto outer = children[0];
@@ -741,8 +940,16 @@ Stmt LowererImplImperative::lowerForall(Forall forall)
   }
 
   Stmt loops;
+  // Emit a loop that scans the words of bitmap iterators (optimization)
+  if (!lattice.iterators().empty() && 
+      util::all(lattice.iterators(), 
+                [](Iterator it) { return it.hasBitmapIter(); }) &&
+      provGraph.isUnderived(forall.getIndexVar()) &&
+      !should_use_CUDA_codegen()) {
+    loops = lowerForallBitmap(forall, lattice, reducedAccesses, recoveryStmt);
+  }
   // Emit a loop that iterates over over a single iterator (optimization)
-  if (lattice.iterators().size() == 1 && lattice.iterators()[0].isUnique()) {
+  else if (lattice.iterators().size() == 1 && lattice.iterators()[0].isUnique()) {
     taco_iassert(lattice.points().size() == 1);
 
     MergePoint point = lattice.points()[0];
@@ -790,6 +997,13 @@ Stmt LowererImplImperative::lowerForall(Forall forall)
       canAccelWithSparseIteration &= indexListsExist;
     }
 
+    // Sums over the segments of a sliced ELLPACK level are lowered to loops
+    // over the chunks of the level
+    Iterator chunkIterator;
+    if (iterator.isDimensionIterator() && appenders.empty()) {
+      chunkIterator = getChunkIterator(forall);
+    }
+
     if (!isWhereProducer && hasPosDescendant && underivedAncestors.size() > 1 && provGraph.isPosVariable(iterator.getIndexVar()) && posDescendant == forall.getIndexVar()) {
       loops = lowerForallFusedPosition(forall, iterator, locators,
                                          inserters, appenders, reducedAccesses, recoveryStmt);
@@ -797,6 +1011,11 @@ Stmt LowererImplImperative::lowerForall(Forall forall)
     else if (canAccelWithSparseIteration) {
       loops = lowerForallDenseAcceleration(forall, locators, inserters, appenders, reducedAccesses, recoveryStmt);
     }
+    // Emit chunk loops over a sliced ELLPACK level
+    else if (chunkIterator.defined()) {
+      loops = lowerForallChunks(forall, chunkIterator, locators, inserters,
+                                recoveryStmt);
+    }
     // Emit dimension coordinate iteration loop
     else if (iterator.isDimensionIterator()) {
       loops = lowerForallDimension(forall, point.locators(),
@@ -819,7 +1038,8 @@ Stmt LowererImplImperative::lowerForall(Forall forall)
     std::vector<IndexVar> underivedAncestors = provGraph.getUnderivedAncestors(forall.getIndexVar());
     taco_iassert(underivedAncestors.size() == 1); // TODO: add support for fused coordinate of pos loop
     loops = lowerMergeLattice(lattice, underivedAncestors[0],
-                              forall.getStmt(), reducedAccesses);
+                              forall.getStmt(), reducedAccesses,
+                              forall.getMergeStrategy());
   }
 //  taco_iassert(loops.defined());
 
@@ -863,6 +1083,20 @@ Stmt LowererImplImperative::lowerForallCloned(Forall forall) {
       }
     }
   }
+  taco_uassert(!varsWithGuard.empty())
+    << "Unable to vectorize or unroll loop over unbound variable " << forall.getIndexVar();
+
+  // tails that are rounded up or predicated need no guards, so the loop does
+  // not have to be cloned
+  varsWithGuard = util::filter(varsWithGuard, [&](IndexVar var) {
+    return needsTailGuard(var);
+  });
+  if (varsWithGuard.empty()) {
+    emitUnderivedGuards = false;
+    Stmt loop = lowerForall(forall);
+    emitUnderivedGuards = true;
+    return loop;
+  }
 
   // determine min and max values for vars given already defined variables.
   // we do a recovery where we fill in undefined variables with either 0's or the max of their iteration
@@ -932,15 +1166,10 @@ Stmt LowererImplImperative::lowerForallCloned(Forall forall) {
 
   Stmt unvectorizedLoop;
 
-  taco_uassert(guardCondition.defined())
-    << "Unable to vectorize or unroll loop over unbound variable " << forall.getIndexVar();
-
   // build loop with guards (not vectorized)
-  if (!varsWithGuard.empty()) {
-    ignoreVectorize = true;
-    unvectorizedLoop = lowerForall(forall);
-    ignoreVectorize = false;
-  }
+  ignoreVectorize = true;
+  unvectorizedLoop = lowerForall(forall);
+  ignoreVectorize = false;
 
   // build loop without guards
   emitUnderivedGuards = false;
@@ -951,6 +1180,413 @@ Stmt LowererImplImperative::lowerForallCloned(Forall forall) {
   return Block::make(Block::make(guardRecoverySteps), IfThenElse::make(guardCondition, unvectorizedLoop, vectorizedLoop));
 }
 
+bool LowererImplImperative::needsTailGuard(IndexVar indexVar) {
+  switch (provGraph.getTailStrategy(indexVar)) {
+    case TailStrategy::RoundUp:
+      // The dimensions of underived variables are checked on entry
+      return !provGraph.isUnderived(indexVar);
+    case TailStrategy::Predicate: {
+      IndexVar inner = provGraph.getChildren(indexVar)[1];
+      return !provGraph.isPredicatedTail(inner, definedIndexVarsOrdered);
+    }
+    default:
+      return true;
+  }
+}
+
+Stmt LowererImplImperative::lowerForallPrivatized(Forall forall) {
+  const bool useAtomics = 
+      forall.getOutputRaceStrategy() == OutputRaceStrategy::Atomics;
+
+  // Iterations of the loop race to reduce into results that are not indexed 
+  // by the parallelized index variable, which includes all scalar results.
+  const auto parallelVars = 
+      provGraph.getUnderivedAncestors(forall.getIndexVar());
+  vector<TensorVar> racingResults;
+  for (const auto& access : getResultAccesses(forall).second) {
+    const TensorVar result = access.getTensorVar();
+    if (util::contains(temporaryArrays, result) || 
+        util::contains(racingResults, result)) {
+      continue;
+    }
+    if (!util::any(access.getIndexVars(), [&](const IndexVar& var) {
+          return util::contains(parallelVars, var); })) {
+      racingResults.push_back(result);
+    }
+  }
+
+  // Reduce into a racing result without atomics only if it is reduced by 
+  // addition and, unless it is a scalar, dense and small enough to copy per 
+  // thread.  Racing results that cannot be reduced this way are updated with 
+  // atomics instead.
+  const long long maxPrivatizedSize = useAtomics 
+                                    ? MAX_ATOMICS_PRIVATIZED_RESULT_SIZE 
+                                    : MAX_PRIVATIZED_RESULT_SIZE;
+  set<TensorVar> addedResults;
+  set<TensorVar> otherReducedResults;
+  match(forall,
+    function<void(const AssignmentNode*)>([&](const AssignmentNode* op) {
+      const TensorVar result = op->lhs.getTensorVar();
+      if (op->op.defined() && isa<taco::Add>(op->op)) {
+        addedResults.insert(result);
+      }
+      else {
+        otherReducedResults.insert(result);
+      }
+    })
+  );
+  vector<TensorVar> scalarResults, privatizedResults;
+  bool needsAtomics = false;
+  for (const auto& result : racingResults) {
+    bool reduce = generateComputeCode() && 
+                  util::contains(addedResults, result) &&
+                  !util::contains(otherReducedResults, result);
+    if (reduce && isScalar(result.getType())) {
+      scalarResults.push_back(result);
+      continue;
+    }
+    reduce = reduce && isDense(result.getFormat());
+    long long numElements = 1;
+    for (const auto& dimension : result.getType().getShape()) {
+      reduce = reduce && dimension.isFixed();
+      if (reduce) {
+        numElements *= dimension.getSize();
+      }
+    }
+    if (reduce && numElements <= maxPrivatizedSize) {
+      privatizedResults.push_back(result);
+    }
+    else {
+      needsAtomics = true;
+    }
+  }
+
+  privatizeRacingResults = false;
+  if (scalarResults.empty() && privatizedResults.empty()) {
+    if (needsAtomics && !useAtomics) {
+      markAssignsAtomicDepth++;
+      atomicParallelUnit = forall.getParallelUnit();
+    }
+    Stmt loop = lowerForall(forall);
+    if (needsAtomics && !useAtomics) {
+      markAssignsAtomicDepth--;
+    }
+    privatizeRacingResults = true;
+    return loop;
+  }
+
+  // Scalar results are summed with a reduction clause of the parallel loop.
+  vector<Expr> reductionVars;
+  for (const auto& result : scalarResults) {
+    reductionVars.push_back(getTensorVar(result));
+    parallelReducedResults.insert(result);
+  }
+
+  // Each thread reduces into a zero-initialized private copy of every other 
+  // result, and the copies are then summed into the result in parallel.
+  vector<Stmt> allocCopies, declCopies, reduceCopies, freeCopies;
+  if (!privatizedResults.empty()) {
+    Expr numThreads = Var::make("num_threads", Int32);
+    Expr threadNum = ir::Call::make("omp_get_thread_num", {}, Int32);
+    allocCopies.push_back(VarDecl::make(numThreads, 
+        ir::Call::make("omp_get_max_threads", {}, Int32)));
+    for (const auto& result : privatizedResults) {
+      const Datatype type = result.getType().getDataType();
+      const Expr tensor = getTensorVar(result);
+      Expr size = 1;
+      for (int mode = 0; mode < result.getOrder(); ++mode) {
+        size = ir::Mul::make(size, GetProperty::make(tensor, 
+                                                     TensorProperty::Dimension, 
+                                                     mode));
+      }
+      Expr sizeVar = Var::make(result.getName() + "_private_size", Int32);
+      allocCopies.push_back(VarDecl::make(sizeVar, size));
+
+      Expr copies = Var::make(result.getName() + "_private_all", type, true, 
+                              false);
+      Expr callocCopies = ir::Call::make("calloc", 
+          {ir::Mul::make(sizeVar, numThreads), Sizeof::make(type)}, type);
+      allocCopies.push_back(VarDecl::make(copies, callocCopies));
+
+      Expr copy = Var::make(result.getName() + "_private", type, true, false);
+      declCopies.push_back(VarDecl::make(copy, ir::Add::make(copies, 
+          ir::Mul::make(sizeVar, threadNum))));
+
+      Expr values = getValuesArray(result);
+      Expr p = Var::make("p" + result.getName(), Int32);
+      Expr t = Var::make("t" + result.getName(), Int32);
+      Expr copyValue = Load::make(copies, 
+                                  ir::Add::make(ir::Mul::make(t, sizeVar), p));
+      Stmt reduceCopy = For::make(t, 0, numThreads, 1, 
+                                  compoundStore(values, p, copyValue));
+      reduceCopies.push_back(For::make(p, 0, sizeVar, 1, reduceCopy, 
+                                       LoopKind::Static_Chunked, 
+                                       ParallelUnit::CPUThread));
+      freeCopies.push_back(Free::make(copies));
+
+      TemporaryArrays arrays;
+      arrays.values = copy;
+      temporaryArrays.insert({result, arrays});
+      parallelReducedResults.insert(result);
+    }
+  }
+
+  if (needsAtomics && !useAtomics) {
+    markAssignsAtomicDepth++;
+    atomicParallelUnit = forall.getParallelUnit();
+  }
+  Stmt loop = lowerForall(forall);
+  if (needsAtomics && !useAtomics) {
+    markAssignsAtomicDepth--;
+  }
+  privatizeRacingResults = true;
+  for (const auto& result : privatizedResults) {
+    temporaryArrays.erase(result);
+  }
+  for (const auto& result : racingResults) {
+    parallelReducedResults.erase(result);
+  }
+
+  // Declare the private copies at the top of the parallel loop body and add 
+  // the reduction clause to the parallel loop.
+  struct DeclareCopies : public IRRewriter {
+    using IRRewriter::visit;
+
+    Stmt declCopies;
+    vector<Expr> reductionVars;
+    bool declared = false;
+
+    void visit(const For* op) {
+      if (declared || op->parallel_unit != ParallelUnit::CPUThread) {
+        IRRewriter::visit(op);
+        return;
+      }
+      declared = true;
+      Stmt contents = isa<Scope>(op->contents) 
+                    ? to<Scope>(op->contents)->scopedStmt : op->contents;
+      if (declCopies.defined()) {
+        contents = Block::make(declCopies, contents);
+      }
+      stmt = For::make(op->var, op->start, op->end, op->increment, contents, 
+                       op->kind, op->parallel_unit, op->unrollFactor, 
+                       op->vec_width, reductionVars);
+    }
+  };
+  DeclareCopies declareCopies;
+  if (!declCopies.empty()) {
+    declareCopies.declCopies = Block::make(declCopies);
+  }
+  declareCopies.reductionVars = reductionVars;
+  loop = declareCopies.rewrite(loop);
+  taco_iassert(declareCopies.declared);
+
+  return Block::blanks(Block::make(allocCopies), loop, 
+                       Block::make(reduceCopies), Block::make(freeCopies));
+}
+
+Stmt LowererImplImperative::lowerForallMergePath(Forall forall) {
+  // Find the compressed level of the matrix whose nonzeros the nested loop 
+  // iterates over.
+  IndexVar j;
+  match(forall.getStmt(),
+    function<void(const ForallNode*)>([&](const ForallNode* op) {
+      j = op->indexVar;
+    })
+  );
+  Iterator nonzeros;
+  match(forall.getStmt(),
+    function<void(const AccessNode*)>([&](const AccessNode* op) {
+      for (const auto& iterator : getIterators(Access(op))) {
+        if (iterator.getIndexVar() == j && iterator.hasPosIter() && 
+            !iterator.isFull()) {
+          nonzeros = iterator;
+        }
+      }
+    })
+  );
+  taco_iassert(nonzeros.defined());
+
+  partitionMergePaths = false;
+  Stmt loop = lowerForall(forall);
+  partitionMergePaths = true;
+
+  // Values that tiles compute for the last row they reach, which is usually 
+  // split between tiles, are stored in carry arrays and added to the results 
+  // after the loop.
+  map<Expr,Expr> carries;
+  for (const auto& access : getResultAccesses(forall).first) {
+    const TensorVar result = access.getTensorVar();
+    carries.insert({getTensorVar(result), 
+                    Var::make(result.getName() + "_carry", 
+                              result.getType().getDataType(), true, false)});
+  }
+
+  struct ClampPositions : public IRRewriter {
+    using IRRewriter::visit;
+
+    Expr posVar, posBegin, posEnd;
+
+    void visit(const For* op) {
+      if (op->var != posVar) {
+        IRRewriter::visit(op);
+        return;
+      }
+      stmt = For::make(op->var, ir::Max::make(op->start, posBegin), 
+                       ir::Min::make(op->end, posEnd), op->increment, 
+                       rewrite(op->contents), op->kind, op->parallel_unit, 
+                       op->unrollFactor, op->vec_width, op->reductionVars);
+    }
+  };
+
+  struct StoreCarries : public IRRewriter {
+    using IRRewriter::visit;
+
+    map<Expr,Expr> carries;
+    Expr tile;
+
+    Expr getCarry(Expr arr) {
+      if (!isa<GetProperty>(arr) || 
+          to<GetProperty>(arr)->property != TensorProperty::Values ||
+          !util::contains(carries, to<GetProperty>(arr)->tensor)) {
+        return Expr();
+      }
+      return carries.at(to<GetProperty>(arr)->tensor);
+    }
+
+    void visit(const Store* op) {
+      Expr carry = getCarry(op->arr);
+      if (!carry.defined()) {
+        IRRewriter::visit(op);
+        return;
+      }
+      // Carries only hold the values that the tile adds to the results.
+      Expr data = op->data;
+      if (isa<ir::Add>(data) && isa<Load>(to<ir::Add>(data)->a) && 
+          getCarry(to<Load>(to<ir::Add>(data)->a)->arr) == carry) {
+        data = to<ir::Add>(data)->b;
+      }
+      stmt = Store::make(carry, tile, data);
+    }
+  };
+
+  struct PartitionMergePath : public IRRewriter {
+    using IRRewriter::visit;
+
+    Iterator nonzeros;
+    map<Expr,Expr> carries;
+    map<Expr,Expr> values;
+    vector<Stmt> allocCarries, addCarries, freeCarries;
+    bool partitioned = false;
+
+    void visit(const For* op) {
+      if (op->parallel_unit != ParallelUnit::CPUThreadMergePath) {
+        IRRewriter::visit(op);
+        return;
+      }
+      partitioned = true;
+
+      const string name = util::toString(op->var);
+      const string posName = util::toString(nonzeros.getPosVar());
+      Expr posArray = nonzeros.getMode().getModePack().getArray(0);
+      Expr numRows = op->end;
+
+      // Split the merge path of the row ends and nonzeros into tiles.
+      Expr items = Var::make(name + "_merge_items", Int32);
+      Expr tiles = Var::make(name + "_merge_tiles", Int32);
+      allocCarries.push_back(VarDecl::make(items, 
+          ir::Add::make(numRows, Load::make(posArray, numRows))));
+      allocCarries.push_back(VarDecl::make(tiles, 
+          ir::Div::make(ir::Add::make(items, MERGE_PATH_TILE_SIZE - 1), 
+                        MERGE_PATH_TILE_SIZE)));
+
+      Expr tile = Var::make(name + "_tile", Int32);
+      Expr diagonalBegin = Var::make(name + "_diagonal_begin", Int32);
+      Expr diagonalEnd = Var::make(name + "_diagonal_end", Int32);
+      Expr rowBegin = Var::make(name + "_tile_begin", Int32);
+      Expr rowEnd = Var::make(name + "_tile_end", Int32);
+      Expr posBegin = Var::make(posName + "_tile_begin", Int32);
+      Expr posEnd = Var::make(posName + "_tile_end", Int32);
+      vector<Stmt> tileStmts;
+      tileStmts.push_back(VarDecl::make(diagonalBegin, 
+          ir::Mul::make(tile, MERGE_PATH_TILE_SIZE)));
+      tileStmts.push_back(VarDecl::make(diagonalEnd, ir::Min::make(
+          ir::Add::make(diagonalBegin, MERGE_PATH_TILE_SIZE), items)));
+      tileStmts.push_back(VarDecl::make(rowBegin, 
+          ir::Call::make("taco_mergePathSearch", 
+                         {posArray, numRows, diagonalBegin}, Int32)));
+      tileStmts.push_back(VarDecl::make(posBegin, 
+          ir::Sub::make(diagonalBegin, rowBegin)));
+      tileStmts.push_back(VarDecl::make(rowEnd, 
+          ir::Call::make("taco_mergePathSearch", 
+                         {posArray, numRows, diagonalEnd}, Int32)));
+      tileStmts.push_back(VarDecl::make(posEnd, 
+          ir::Sub::make(diagonalEnd, rowEnd)));
+
+      // Each tile computes the rows that end in the tile, starting at the 
+      // tile's first nonzero.
+      ClampPositions clampPositions;
+      clampPositions.posVar = nonzeros.getPosVar();
+      clampPositions.posBegin = posBegin;
+      clampPositions.posEnd = posEnd;
+      Stmt contents = isa<Scope>(op->contents) 
+                    ? to<Scope>(op->contents)->scopedStmt : op->contents;
+      contents = clampPositions.rewrite(contents);
+      tileStmts.push_back(For::make(op->var, rowBegin, rowEnd, 1, contents));
+
+      // The row that the tile ends in is computed into the carries.
+      Expr carryRows = Var::make(name + "_carry_rows", Int32, true, false);
+      allocCarries.push_back(VarDecl::make(carryRows, 0));
+      allocCarries.push_back(Allocate::make(carryRows, tiles));
+      freeCarries.push_back(Free::make(carryRows));
+      tileStmts.push_back(Store::make(carryRows, tile, rowEnd));
+      for (const auto& carry : carries) {
+        allocCarries.push_back(VarDecl::make(carry.second, 0));
+        allocCarries.push_back(Allocate::make(carry.second, tiles));
+        freeCarries.push_back(Free::make(carry.second));
+        tileStmts.push_back(Store::make(carry.second, tile, 
+            ir::Literal::zero(carry.second.type())));
+      }
+      StoreCarries storeCarries;
+      storeCarries.carries = carries;
+      storeCarries.tile = tile;
+      tileStmts.push_back(IfThenElse::make(ir::Lt::make(rowEnd, numRows), 
+          Block::make(VarDecl::make(op->var, rowEnd), 
+                      storeCarries.rewrite(contents))));
+
+      stmt = For::make(tile, 0, tiles, 1, Block::make(tileStmts), 
+                       LoopKind::Static_Chunked, ParallelUnit::CPUThread);
+
+      Expr t = Var::make(name + "_carry_tile", Int32);
+      Expr carryRow = Load::make(carryRows, t);
+      vector<Stmt> addCarry;
+      for (const auto& carry : carries) {
+        addCarry.push_back(compoundStore(values.at(carry.first), carryRow, 
+                                         Load::make(carry.second, t)));
+      }
+      addCarries.push_back(For::make(t, 0, tiles, 1, 
+          IfThenElse::make(ir::Lt::make(carryRow, numRows), 
+                           Block::make(addCarry))));
+    }
+  };
+  PartitionMergePath partitionMergePath;
+  partitionMergePath.nonzeros = nonzeros;
+  partitionMergePath.carries = carries;
+  for (const auto& carry : carries) {
+    partitionMergePath.values.insert({carry.first, GetProperty::make(
+        carry.first, TensorProperty::Values)});
+  }
+  loop = partitionMergePath.rewrite(loop);
+  if (!partitionMergePath.partitioned) {
+    // Loops that do no work (e.g. when only assembling dense results) are 
+    // eliminated during lowering.
+    return loop;
+  }
+
+  return Block::blanks(Block::make(partitionMergePath.allocCarries), loop, 
+                       Block::make(partitionMergePath.addCarries), 
+                       Block::make(partitionMergePath.freeCarries));
+}
+
 Stmt LowererImplImperative::searchForFusedPositionStart(Forall forall, Iterator posIterator) {
   vector<Stmt> searchForUnderivedStart;
   vector<IndexVar> underivedAncestors = provGraph.getUnderivedAncestors(forall.getIndexVar());
@@ -1112,6 +1748,8 @@ Stmt LowererImplImperative::searchForFusedPositionStart(Forall forall, Iterator
       underivedStartTarget = this->iterators.modeIterator(underivedAncestors[i+1]).getPosVar();
     }
 
+    taco_uassert(posIteratorLevel.getMode().getModePack().getArray(0).type() ==
+                 Int32) << error::search_requires_int32_index;
     vector<Expr> binarySearchArgs = {
             posIteratorLevel.getMode().getModePack().getArray(0), // array
             posIteratorLevel.getBeginVar(), // arrayStart
@@ -1208,9 +1846,28 @@ Stmt LowererImplImperative::lowerForallDimension(Forall forall,
       atomicParallelUnit = forall.getParallelUnit();
     }
 
+    if (util::contains(bitmapWorkspaces, var)) {
+      return lowerForallBitmapWorkspace(forall, var, locators, inserters, 
+                                        appenders, reducedAccesses, 
+                                        recoveryStmt);
+    }
+
     Stmt declareVar = VarDecl::make(coordinate, Load::make(indexList, loopVar));
     Stmt body = lowerForallBody(coordinate, forall.getStmt(), locators, inserters, appenders, reducedAccesses);
     Stmt resetGuard = ir::Store::make(bitGuard, coordinate, ir::Literal::make(false), markAssignsAtomicDepth > 0, atomicParallelUnit);
+    Stmt resetSlots;
+    if (isHashedWorkspace(var)) {
+      // Emptying a slot would cut the probe sequences of coordinates that are
+      // yet to be located, so the slots are recorded in the index list as they
+      // are read and emptied after the loop.
+      Expr slot = hashedWorkspaceSlots.at(var);
+      declareVar = Block::make(declareVar, VarDecl::make(slot, 
+          Call::make("taco_hashLocate", {bitGuard, 0, hashedWorkspaces.at(var), 
+                     coordinate}, Int32)));
+      resetGuard = Store::make(indexList, loopVar, slot);
+      resetSlots = For::make(loopVar, 0, indexListSize, 1, 
+          Store::make(bitGuard, Load::make(indexList, loopVar), -1));
+    }
 
     if (forall.getParallelUnit() != ParallelUnit::NotParallel && forall.getOutputRaceStrategy() == OutputRaceStrategy::Atomics) {
       markAssignsAtomicDepth--;
@@ -1232,9 +1889,46 @@ Stmt LowererImplImperative::lowerForallDimension(Forall forall,
     return Block::blanks(For::make(loopVar, 0, indexListSize, 1, body, kind,
                                          ignoreVectorize ? ParallelUnit::NotParallel : forall.getParallelUnit(),
                                          ignoreVectorize ? 0 : forall.getUnrollFactor()),
+                                         resetSlots,
                                          posAppend);
   }
 
+Stmt LowererImplImperative::lowerForallBitmapWorkspace(Forall forall,
+                                                       TensorVar workspace,
+                                                       vector<Iterator> locators,
+                                                       vector<Iterator> inserters,
+                                                       vector<Iterator> appenders,
+                                                       set<Access> reducedAccesses,
+                                                       ir::Stmt recoveryStmt)
+{
+  Expr bitGuard = tempToBitGuard.at(workspace);
+  Expr coordinate = getCoordinateVar(forall.getIndexVar());
+  Expr word = Var::make(workspace.getName() + "_word", Int());
+  Expr bits = Var::make(workspace.getName() + "_bits", UInt64);
+
+  vector<Expr> bounds = provGraph.deriveIterBounds(forall.getIndexVar(), 
+      definedIndexVarsOrdered, underivedBounds, indexVarToExprMap, iterators);
+  Expr numWords = ir::Div::make(ir::Add::make(bounds[1], 63), 64);
+
+  // Extract the lowest set bit before lowering the body, since the body may
+  // continue to the next iteration.
+  Expr lowestBit = Call::make("taco_ctz", {bits}, Int());
+  Stmt declareCoordinate = VarDecl::make(coordinate, 
+      ir::Add::make(ir::Mul::make(word, 64), lowestBit));
+  Stmt clearBit = Assign::make(bits, BitAnd::make(bits, ir::Sub::make(bits, 1)));
+  Stmt body = lowerForallBody(coordinate, forall.getStmt(), locators, 
+                              inserters, appenders, reducedAccesses);
+  body = Block::make(declareCoordinate, clearBit, recoveryStmt, body);
+
+  // Reset the bit guard a word at a time as the words are scanned
+  Stmt scanWord = Block::make(VarDecl::make(bits, Load::make(bitGuard, word)),
+                              Store::make(bitGuard, word, 0),
+                              While::make(Neq::make(bits, 0), body));
+
+  Stmt posAppend = generateAppendPositions(appenders);
+  return Block::blanks(For::make(word, 0, numWords, 1, scanWord), posAppend);
+}
+
 Stmt LowererImplImperative::lowerForallCoordinate(Forall forall, Iterator iterator,
                                         vector<Iterator> locators,
                                         vector<Iterator> inserters,
@@ -1256,9 +1950,16 @@ Stmt LowererImplImperative::lowerForallPosition(Forall forall, Iterator iterator
   Stmt declareCoordinate = Stmt();
   Stmt strideGuard = Stmt();
   Stmt boundsGuard = Stmt();
+  Stmt emptyGuard = Stmt();
   if (provGraph.isCoordVariable(forall.getIndexVar())) {
-    Expr coordinateArray = iterator.posAccess(iterator.getPosVar(),
-                                              coordinates(iterator)).getResults()[0];
+    ModeFunction posAccess = iterator.posAccess(iterator.getPosVar(),
+                                                coordinates(iterator));
+    Expr coordinateArray = posAccess.getResults()[0];
+    // Skip positions that do not store a coordinate (e.g. empty hash slots).
+    if (!isValue(posAccess[1], true)) {
+      emptyGuard = IfThenElse::make(Eq::make(posAccess[1], false),
+                                    Continue::make());
+    }
     // If the iterator is windowed, we must recover the coordinate index
     // variable from the windowed space.
     if (iterator.isWindowed()) {
@@ -1298,8 +1999,11 @@ Stmt LowererImplImperative::lowerForallPosition(Forall forall, Iterator iterator
   // Code to compute iteration bounds
   Stmt boundsCompute;
   Expr startBound, endBound;
+  Expr stride = 1;
   Expr parentPos = iterator.getParent().getPosVar();
   if (!provGraph.isUnderived(iterator.getIndexVar())) {
+    taco_uassert(hasUnitPosStride(iterator)) 
+        << error::strided_positions_not_supported;
     vector<Expr> bounds = provGraph.deriveIterBounds(iterator.getIndexVar(), definedIndexVarsOrdered, underivedBounds, indexVarToExprMap, iterators);
     startBound = bounds[0];
     endBound = bounds[1];
@@ -1310,6 +2014,7 @@ Stmt LowererImplImperative::lowerForallPosition(Forall forall, Iterator iterator
     boundsCompute = bounds.compute();
     startBound = bounds[0];
     endBound = bounds[1];
+    stride = getPosStride(bounds);
     // If we have a window on this iterator, then search for the start of
     // the window rather than starting at the beginning of the level.
     if (iterator.isWindowed()) {
@@ -1344,17 +2049,372 @@ Stmt LowererImplImperative::lowerForallPosition(Forall forall, Iterator iterator
     kind = LoopKind::Runtime;
   }
 
+  // Prefetch the components that later iterations gather
+  Stmt prefetchGathers;
+  if (forall.getPrefetchDistance() > 0 && !should_use_CUDA_codegen() &&
+      provGraph.isCoordVariable(forall.getIndexVar()) &&
+      provGraph.isUnderived(iterator.getIndexVar()) && isValue(stride, 1)) {
+    prefetchGathers = codeToPrefetchGathers(iterator, locators, endBound,
+                                            forall.getPrefetchDistance());
+  }
+
   // Loop with preamble and postamble
   return Block::blanks(
                        boundsCompute,
-                       For::make(iterator.getPosVar(), startBound, endBound, 1,
-                                 Block::make(strideGuard, declareCoordinate, boundsGuard, body),
+                       For::make(iterator.getPosVar(), startBound, endBound, stride,
+                                 Block::make(prefetchGathers, emptyGuard, strideGuard, declareCoordinate, boundsGuard, body),
                                  kind,
                                  ignoreVectorize ? ParallelUnit::NotParallel : forall.getParallelUnit(), ignoreVectorize ? 0 : forall.getUnrollFactor()),
                        posAppend);
 
 }
 
+Stmt LowererImplImperative::codeToPrefetchGathers(Iterator iterator,
+                                                  vector<Iterator> locators,
+                                                  Expr endBound,
+                                                  size_t distance) {
+  // Read the coordinate of a later position, but never past the last position
+  // of the loop.
+  Expr pos = iterator.getPosVar();
+  Expr aheadPos = ir::Min::make(ir::Add::make(pos, (int)distance),
+                                ir::Sub::make(endBound, 1));
+  ModeFunction posAccess = iterator.posAccess(aheadPos, coordinates(iterator));
+  if (posAccess.compute().defined()) {
+    return Stmt();
+  }
+  Expr coordinate = getCoordinateVar(iterator.getIndexVar());
+  Expr aheadCoordinate = Var::make(util::toString(coordinate) + "_ahead",
+                                   coordinate.type());
+
+  vector<Stmt> prefetches;
+  for (Iterator& locator : locators) {
+    if (!locator.hasLocate() || locator.isWindowed() || 
+        locator.hasIndexSet()) {
+      continue;
+    }
+    vector<Expr> coords = coordinates(locator);
+    coords.back() = aheadCoordinate;
+    ModeFunction locate = locator.locate(coords);
+    if (locate.compute().defined()) {
+      continue;
+    }
+
+    // Prefetch the first component of the located subtensor, whose remaining
+    // levels must be dense.
+    Expr componentPos = locate[0];
+    bool denseBelow = true;
+    for (Iterator level = locator; !level.isLeaf() && denseBelow;) {
+      level = level.getChild();
+      denseBelow = level.getMode().getModeFormat().getName() == 
+                   ModeFormat::Dense.getName();
+      componentPos = ir::Mul::make(componentPos, 
+                                   level.getMode().getModePack().getArray(0));
+    }
+    if (!denseBelow) {
+      continue;
+    }
+    Expr values = GetProperty::make(locator.getTensor(), 
+                                    TensorProperty::Values);
+    prefetches.push_back(Prefetch::make(values, componentPos));
+  }
+  if (prefetches.empty()) {
+    return Stmt();
+  }
+  prefetches.insert(prefetches.begin(), 
+                    VarDecl::make(aheadCoordinate, posAccess[0]));
+  return Block::make(prefetches);
+}
+
+Stmt LowererImplImperative::lowerForallBitmap(Forall forall, 
+                                              MergeLattice lattice,
+                                              set<Access> reducedAccesses,
+                                              ir::Stmt recoveryStmt)
+{
+  Expr coordinate = getCoordinateVar(forall.getIndexVar());
+  Expr word = Var::make(util::toString(coordinate) + "_word", Int());
+  Expr bits = Var::make(util::toString(coordinate) + "_bits", UInt64);
+
+  MergePoint point = lattice.points()[0];
+  vector<Iterator> appenders;
+  vector<Iterator> inserters;
+  tie(appenders, inserters) = splitAppenderAndInserters(point.results());
+
+  // Code to compute the bitmap words of each iterator's segment
+  vector<Stmt> boundsCompute;
+  map<Iterator, Expr> iteratorWords;
+  map<Iterator, Expr> iteratorBegins;
+  Expr numWords;
+  for (auto& iterator : lattice.iterators()) {
+    ModeFunction bounds = iterator.bitmapBounds(iterator.getParent().getPosVar());
+    boundsCompute.push_back(bounds.compute());
+    iteratorWords.insert({iterator, Load::make(bounds[0], 
+                                               ir::Add::make(bounds[1], word))});
+    iteratorBegins.insert({iterator, bounds[1]});
+    numWords = bounds[2];
+  }
+
+  // Intersect the iterators of each lattice point and union the lattice
+  // points, skipping points that cover a subset of another point's space.
+  Expr mask;
+  for (auto& point : lattice.points()) {
+    const set<Iterator> iterators = util::toSet(point.iterators());
+    if (util::any(lattice.points(), [&](const MergePoint& other) {
+          const set<Iterator> otherIterators = util::toSet(other.iterators());
+          return otherIterators.size() < iterators.size() &&
+                 std::includes(iterators.begin(), iterators.end(),
+                               otherIterators.begin(), otherIterators.end());
+        })) {
+      continue;
+    }
+    Expr pointMask;
+    for (auto& iterator : point.iterators()) {
+      Expr iteratorWord = iteratorWords.at(iterator);
+      pointMask = pointMask.defined() ? BitAnd::make(pointMask, iteratorWord) 
+                                      : iteratorWord;
+    }
+    mask = mask.defined() ? BitOr::make(mask, pointMask) : pointMask;
+  }
+
+  // Extract the lowest set bit before lowering the body, since the body may
+  // continue to the next iteration.
+  Expr lowestBit = Call::make("taco_ctz", {bits}, Int());
+  Stmt declareCoordinate = VarDecl::make(coordinate, 
+      ir::Add::make(ir::Mul::make(word, 64), lowestBit));
+  Stmt clearBit = Assign::make(bits, BitAnd::make(bits, ir::Sub::make(bits, 1)));
+  vector<Stmt> declarePosVars;
+  for (auto& iterator : lattice.iterators()) {
+    Expr segmentBegin = ir::Mul::make(iteratorBegins.at(iterator), 64);
+    declarePosVars.push_back(VarDecl::make(iterator.getPosVar(),
+        ir::Add::make(segmentBegin, coordinate)));
+  }
+
+  if (forall.getParallelUnit() != ParallelUnit::NotParallel && forall.getOutputRaceStrategy() == OutputRaceStrategy::Atomics) {
+    markAssignsAtomicDepth++;
+  }
+
+  Stmt body = lowerForallBody(coordinate, forall.getStmt(), point.locators(),
+                              inserters, appenders, reducedAccesses);
+
+  if (forall.getParallelUnit() != ParallelUnit::NotParallel && forall.getOutputRaceStrategy() == OutputRaceStrategy::Atomics) {
+    markAssignsAtomicDepth--;
+  }
+
+  body = Block::make(declareCoordinate, clearBit, Block::make(declarePosVars),
+                     recoveryStmt, body);
+
+  // Code to append positions
+  Stmt posAppend = generateAppendPositions(appenders);
+
+  LoopKind kind = LoopKind::Serial;
+  if (forall.getParallelUnit() == ParallelUnit::CPUThread && !ignoreVectorize &&
+      forall.getOutputRaceStrategy() != OutputRaceStrategy::ParallelReduction) {
+    kind = LoopKind::Runtime;
+  }
+  ParallelUnit parallelUnit = (kind == LoopKind::Serial) 
+                              ? ParallelUnit::NotParallel 
+                              : forall.getParallelUnit();
+
+  Stmt scanWord = Block::make(VarDecl::make(bits, mask),
+                              While::make(Neq::make(bits, 0), body));
+  return Block::blanks(Block::make(boundsCompute),
+                       For::make(word, 0, numWords, 1, scanWord, kind,
+                                 parallelUnit),
+                       posAppend);
+}
+
+Iterator LowererImplImperative::getChunkIterator(Forall forall) {
+  const IndexVar i = forall.getIndexVar();
+  if (should_use_CUDA_codegen() || !generateComputeCode() ||
+      generateAssembleCode() || markAssignsAtomicDepth > 0 ||
+      !provGraph.isUnderived(i) || forall.getUnrollFactor() > 0 ||
+      (forall.getParallelUnit() != ParallelUnit::NotParallel &&
+       forall.getParallelUnit() != ParallelUnit::CPUThread) ||
+      (forall.getOutputRaceStrategy() != OutputRaceStrategy::NoRaces &&
+       forall.getOutputRaceStrategy() != OutputRaceStrategy::IgnoreRaces) ||
+      !isa<Where>(forall.getStmt())) {
+    return Iterator();
+  }
+
+  // The forall must store a scalar temporary into the rows of a result...
+  Where where = to<Where>(forall.getStmt());
+  TensorVar temporary = where.getTemporary();
+  if (!isScalar(temporary.getType()) || util::contains(guardedTemps, temporary) ||
+      !isa<Assignment>(where.getConsumer()) || 
+      !isa<Forall>(where.getProducer())) {
+    return Iterator();
+  }
+  Assignment consumer = to<Assignment>(where.getConsumer());
+  if (consumer.getLhs().getIndexVars() != vector<IndexVar>({i}) ||
+      !isa<Access>(consumer.getRhs()) ||
+      to<Access>(consumer.getRhs()).getTensorVar() != temporary) {
+    return Iterator();
+  }
+
+  // ...that is the sum of a product over the segments of a row...
+  Forall producer = to<Forall>(where.getProducer());
+  const IndexVar j = producer.getIndexVar();
+  if (!provGraph.isUnderived(j) || producer.getUnrollFactor() > 0 ||
+      producer.getParallelUnit() != ParallelUnit::NotParallel ||
+      producer.getPrefetchDistance() > 0 ||
+      !isa<Assignment>(producer.getStmt())) {
+    return Iterator();
+  }
+  Assignment reduction = to<Assignment>(producer.getStmt());
+  if (reduction.getLhs().getTensorVar() != temporary ||
+      !isa<taco::Add>(reduction.getOperator())) {
+    return Iterator();
+  }
+
+  // ...of one matrix with vectors over the segments' coordinates...
+  const AccessNode* matrix = nullptr;
+  bool isRowSum = true;
+  match(reduction.getRhs(),
+    function<void(const AccessNode*)>([&](const AccessNode* op) {
+      const auto& indexVars = op->indexVars;
+      if (indexVars == vector<IndexVar>({i, j}) && matrix == nullptr) {
+        matrix = op;
+      } else if (!indexVars.empty() && indexVars != vector<IndexVar>({j})) {
+        isRowSum = false;
+      }
+    })
+  );
+  if (!isRowSum || matrix == nullptr) {
+    return Iterator();
+  }
+
+  // ...where the matrix's padding entries do not contribute to the sum...
+  if (!isAnnihilatedBy(reduction.getRhs(), matrix)) {
+    return Iterator();
+  }
+
+  // ...and the segments are chunked rows of a dense row level.
+  definedIndexVars.insert(j);
+  MergeLattice lattice = MergeLattice::make(producer, iterators, provGraph,
+                                            definedIndexVars, 
+                                            whereTempsToResult);
+  definedIndexVars.erase(j);
+  if (lattice.iterators().size() != 1 || lattice.points().size() != 1 ||
+      !lattice.points()[0].results().empty()) {
+    return Iterator();
+  }
+  Iterator iterator = lattice.iterators()[0];
+  if (!iterator.hasChunkIter() || iterator.isWindowed() || 
+      iterator.hasIndexSet() || !(getIterators(Access(matrix)).back() == iterator) ||
+      iterator.getParent().getIndexVar() != i ||
+      !iterator.getParent().getParent().isRoot()) {
+    return Iterator();
+  }
+  return iterator;
+}
+
+Stmt LowererImplImperative::lowerForallChunks(Forall forall, Iterator iterator,
+                                              vector<Iterator> locators,
+                                              vector<Iterator> inserters,
+                                              ir::Stmt recoveryStmt)
+{
+  Where where = to<Where>(forall.getStmt());
+  Forall producer = to<Forall>(where.getProducer());
+  Assignment reduction = to<Assignment>(producer.getStmt());
+  TensorVar temporary = where.getTemporary();
+  const Datatype type = temporary.getType().getDataType();
+  const int chunkSize = iterator.getMode().getModeFormat().getChunkSize();
+
+  Expr coordinate = getCoordinateVar(forall.getIndexVar());
+  Expr chunk = Var::make(util::toString(coordinate) + "_chunk", Int());
+  Expr slot = Var::make(util::toString(iterator.getPosVar()) + "_slot", 
+                        iterator.getPosVar().type());
+  Expr numSegments = getDimension(forall.getIndexVar());
+  Expr numChunks = ir::Div::make(ir::Add::make(numSegments, chunkSize - 1),
+                                 chunkSize);
+
+  // Sum a slot column of the chunk into the lane's temporary
+  const IndexVar j = producer.getIndexVar();
+  definedIndexVars.insert(j);
+  definedIndexVarsOrdered.push_back(j);
+  MergeLattice lattice = MergeLattice::make(producer, iterators, provGraph,
+                                            definedIndexVars, 
+                                            whereTempsToResult);
+  Expr segmentCoordinate = getCoordinateVar(j);
+  ModeFunction posAccess = iterator.posAccess(iterator.getPosVar(),
+                                              coordinates(iterator));
+  Expr laneValue = Var::make(temporary.getName() + "_lane", type);
+  Stmt sumLane = Block::make(VarDecl::make(segmentCoordinate, posAccess[0]),
+                             declLocatePosVars(lattice.points()[0].locators()),
+                             compoundAssign(laneValue, 
+                                            lower(reduction.getRhs())));
+  definedIndexVars.erase(j);
+  definedIndexVarsOrdered.pop_back();
+
+  // Store a lane's temporary into its row
+  ModeFunction bounds = iterator.chunkBounds(chunk, numSegments);
+  Expr lane = Var::make(util::toString(coordinate) + "_lane", Int());
+  ModeFunction rowAccess = iterator.chunkAccess(chunk, lane, numSegments);
+  Expr value = Var::make(temporary.getName() + "_val", type);
+  taco_iassert(util::contains(tensorVars, temporary));
+  tensorVars.find(temporary)->second = value;
+  Stmt storeLane = Block::make(rowAccess.compute(),
+                               VarDecl::make(coordinate, rowAccess[0]),
+                               recoveryStmt,
+                               declLocatePosVars(inserters),
+                               declLocatePosVars(locators),
+                               VarDecl::make(value, laneValue),
+                               lower(where.getConsumer()));
+
+  // The lanes are unrolled into scalar temporaries, so that the C compiler
+  // can keep them in vector registers and vectorize the sum of a slot column
+  // across them.  Each lane renames the variables it declares.
+  struct RenameLane : public IRRewriter {
+    using IRRewriter::visit;
+
+    map<Expr,Expr> names;
+    string suffix;
+
+    void visit(const Var* op) {
+      expr = util::contains(names, Expr(op)) ? names.at(op) : op;
+    }
+
+    void visit(const VarDecl* op) {
+      if (!util::contains(names, op->var)) {
+        const Var* var = to<Var>(op->var);
+        names.insert({op->var, Var::make(var->name + suffix, var->type,
+                                         var->is_ptr, var->is_tensor)});
+      }
+      IRRewriter::visit(op);
+    }
+  };
+  vector<Stmt> declareLanes, sumLanes, storeLanes;
+  Expr numLanes = ir::Sub::make(numSegments, ir::Mul::make(chunk, chunkSize));
+  for (int l = 0; l < chunkSize; ++l) {
+    RenameLane rename;
+    rename.suffix = to_string(l);
+    Expr laneValueL = Var::make(temporary.getName() + "_lane" + rename.suffix,
+                                type);
+    rename.names.insert({laneValue, laneValueL});
+    rename.names.insert({lane, ir::Literal::make(l)});
+    declareLanes.push_back(VarDecl::make(laneValueL, ir::Literal::zero(type)));
+    sumLanes.push_back(rename.rewrite(Block::make(
+        VarDecl::make(iterator.getPosVar(), ir::Add::make(slot, l)), sumLane)));
+    // The last chunk may have fewer lanes than the others
+    Stmt storeLaneL = rename.rewrite(storeLane);
+    storeLanes.push_back((l == 0) ? storeLaneL 
+        : IfThenElse::make(Lt::make(l, numLanes), storeLaneL));
+  }
+  Stmt slotLoop = For::make(slot, bounds[0], bounds[1], chunkSize, 
+                            Block::make(sumLanes));
+
+  LoopKind kind = LoopKind::Serial;
+  if (forall.getParallelUnit() == ParallelUnit::CPUThread && !ignoreVectorize) {
+    kind = LoopKind::Runtime;
+  }
+  ParallelUnit parallelUnit = (kind == LoopKind::Serial) 
+                              ? ParallelUnit::NotParallel 
+                              : forall.getParallelUnit();
+  return For::make(chunk, 0, numChunks, 1, 
+                   Block::make(Block::make(declareLanes), bounds.compute(),
+                               slotLoop, Block::make(storeLanes)),
+                   kind, parallelUnit);
+}
+
 Stmt LowererImplImperative::lowerForallFusedPosition(Forall forall, Iterator iterator,
                                       vector<Iterator> locators,
                                       vector<Iterator> inserters,
@@ -1362,6 +2422,9 @@ Stmt LowererImplImperative::lowerForallFusedPosition(Forall forall, Iterator ite
                                       set<Access> reducedAccesses,
                                       ir::Stmt recoveryStmt)
 {
+  taco_uassert(hasUnitPosStride(iterator)) 
+      << error::strided_positions_not_supported;
+
   Expr coordinate = getCoordinateVar(forall.getIndexVar());
   Stmt declareCoordinate = Stmt();
   if (provGraph.isCoordVariable(forall.getIndexVar())) {
@@ -1521,7 +2584,8 @@ Stmt LowererImplImperative::lowerForallFusedPosition(Forall forall, Iterator ite
 
 Stmt LowererImplImperative::lowerMergeLattice(MergeLattice lattice, IndexVar coordinateVar,
                                     IndexStmt statement,
-                                    const std::set<Access>& reducedAccesses)
+                                    const std::set<Access>& reducedAccesses,
+                                    MergeStrategy mergeStrategy)
 {
   Expr coordinate = getCoordinateVar(coordinateVar);
   vector<Iterator> appenders = filter(lattice.results(),
@@ -1544,7 +2608,7 @@ Stmt LowererImplImperative::lowerMergeLattice(MergeLattice lattice, IndexVar coo
     // points in the merge lattice.
     IndexStmt zeroedStmt = zero(statement, getExhaustedAccesses(point,lattice));
     MergeLattice sublattice = lattice.subLattice(point);
-    Stmt mergeLoop = lowerMergePoint(sublattice, coordinate, coordinateVar, zeroedStmt, reducedAccesses, resolvedCoordDeclared);
+    Stmt mergeLoop = lowerMergePoint(sublattice, coordinate, coordinateVar, zeroedStmt, reducedAccesses, resolvedCoordDeclared, mergeStrategy);
     mergeLoopsVec.push_back(mergeLoop);
   }
   Stmt mergeLoops = Block::make(mergeLoopsVec);
@@ -1559,7 +2623,8 @@ Stmt LowererImplImperative::lowerMergeLattice(MergeLattice lattice, IndexVar coo
 
 Stmt LowererImplImperative::lowerMergePoint(MergeLattice pointLattice,
                                   ir::Expr coordinate, IndexVar coordinateVar, IndexStmt statement,
-                                  const std::set<Access>& reducedAccesses, bool resolvedCoordDeclared)
+                                  const std::set<Access>& reducedAccesses, bool resolvedCoordDeclared,
+                                  MergeStrategy mergeStrategy)
 {
   MergePoint point = pointLattice.points().front();
 
@@ -1617,8 +2682,22 @@ Stmt LowererImplImperative::lowerMergePoint(MergeLattice pointLattice,
     indexSetStmts.push_back(ir::IfThenElse::make(ir::And::make(iterEq, setEq), shiftDown, incr));
   }
 
+  // Galloping intersections are at the largest coordinate of their mergers,
+  // which every merger that is behind skips ahead to.
+  bool gallop = (mergeStrategy == MergeStrategy::Gallop) && 
+                canGallop(pointLattice);
+
   // Merge iterator coordinate variables
-  Stmt resolvedCoordinate = resolveCoordinate(mergers, coordinate, !resolvedCoordDeclared);
+  Stmt resolvedCoordinate;
+  if (gallop) {
+    Expr maxCoordinate = Max::make(coordinates(mergers));
+    resolvedCoordinate = resolvedCoordDeclared 
+                         ? Assign::make(coordinate, maxCoordinate) 
+                         : VarDecl::make(coordinate, maxCoordinate);
+  }
+  else {
+    resolvedCoordinate = resolveCoordinate(mergers, coordinate, !resolvedCoordDeclared);
+  }
 
   // Locate positions
   Stmt loadLocatorPosVars = declLocatePosVars(locators);
@@ -1635,7 +2714,9 @@ Stmt LowererImplImperative::lowerMergePoint(MergeLattice pointLattice,
                                    reducedAccesses);
 
   // Increment iterator position variables
-  Stmt incIteratorVarStmts = codeToIncIteratorVars(coordinate, coordinateVar, iterators, mergers);
+  Stmt incIteratorVarStmts = gallop 
+      ? codeToGallopIteratorVars(coordinate, mergers)
+      : codeToIncIteratorVars(coordinate, coordinateVar, iterators, mergers);
 
   /// While loop over rangers
   return While::make(checkThatNoneAreExhausted(rangers),
@@ -1789,16 +2870,31 @@ Stmt LowererImplImperative::lowerForallBody(Expr coordinate, IndexStmt stmt,
   // Code to append coordinates
   Stmt appendCoords = appendCoordinate(appenders, coordinate);
 
-  // TODO: Emit code to insert coordinates
+  // Code to insert coordinates
+  Stmt insertCoords = generateAssembleCode() 
+                      ? insertCoordinate(inserters, coordinate) : Stmt();
 
   return Block::make(initVals,
                      declInserterPosVars,
                      declLocatorPosVars,
                      body,
-                     appendCoords);
+                     appendCoords,
+                     insertCoords);
 }
 
 Expr LowererImplImperative::getTemporarySize(Where where) {
+  Expr size = getTemporaryDimensionSize(where);
+
+  // Accelerated hashed workspaces store one value per hash table slot
+  TensorVar temporary = where.getTemporary();
+  if (util::contains(hashedWorkspaces, temporary) &&
+      canAccelerateDenseTemp(where).first) {
+    return ir::Literal::make(hashedWorkspaces.at(temporary));
+  }
+  return size;
+}
+
+Expr LowererImplImperative::getTemporaryDimensionSize(Where where) {
   TensorVar temporary = where.getTemporary();
   int temporaryOrder = temporary.getType().getShape().getOrder();
 
@@ -1848,14 +2944,26 @@ Expr LowererImplImperative::getTemporarySize(Where where) {
   return Expr();
 }
 
+Expr LowererImplImperative::getBitGuardSize(Where where) {
+  Expr size = getTemporarySize(where);
+  if (util::contains(bitmapWorkspaces, where.getTemporary())) {
+    return ir::Div::make(ir::Add::make(size, 63), 64);
+  }
+  return size;
+}
+
 vector<Stmt> LowererImplImperative::codeToInitializeDenseAcceleratorArrays(Where where, bool parallel) {
   // if parallel == true, need to initialize dense accelerator arrays as size*numThreads
   // and rename all dense accelerator arrays to name + '_all'
 
   TensorVar temporary = where.getTemporary();
 
-  // TODO: emit as uint64 and manually emit bit pack code
-  const Datatype bitGuardType = taco::Bool;
+  // Bitmap workspaces pack the bit guard into 64-bit words and are scanned in
+  // order, so they need no index list.
+  // TODO: emit other bit guards as uint64 too
+  const bool isBitmap = util::contains(bitmapWorkspaces, temporary);
+  const bool isHashed = util::contains(hashedWorkspaces, temporary);
+  const Datatype bitGuardType = isBitmap ? UInt64 : (isHashed ? Int32 : taco::Bool);
   std::string bitGuardSuffix;
   if (parallel)
     bitGuardSuffix = "_already_set_all";
@@ -1863,10 +2971,13 @@ vector<Stmt> LowererImplImperative::codeToInitializeDenseAcceleratorArrays(Where
     bitGuardSuffix = "_already_set";
   const std::string bitGuardName = temporary.getName() + bitGuardSuffix;
 
-  Expr bitGuardSize = getTemporarySize(where);
+  Expr indexListSize = getTemporarySize(where);
+  Expr bitGuardSize = getBitGuardSize(where);
   Expr maxThreads = ir::Call::make("omp_get_max_threads", {}, bitGuardSize.type());
-  if (parallel)
+  if (parallel) {
+    indexListSize = ir::Mul::make(indexListSize, maxThreads);
     bitGuardSize = ir::Mul::make(bitGuardSize, maxThreads);
+  }
 
   const Expr alreadySetArr = ir::Var::make(bitGuardName,
                                            bitGuardType,
@@ -1905,8 +3016,9 @@ vector<Stmt> LowererImplImperative::codeToInitializeDenseAcceleratorArrays(Where
     tempToBitGuard[temporary] = alreadySetArr;
   }
 
-  Stmt allocateIndexList = Allocate::make(indexListArr, bitGuardSize);
   if(should_use_CUDA_codegen()) {
+    Stmt allocateIndexList = isBitmap ? Stmt()
+                                      : Allocate::make(indexListArr, indexListSize);
     Stmt allocateAlreadySet = Allocate::make(alreadySetArr, bitGuardSize);
     Expr p = Var::make("p" + temporary.getName(), Int());
     Stmt guardZeroInit = Store::make(alreadySetArr, p, ir::Literal::zero(bitGuardType));
@@ -1915,15 +3027,68 @@ vector<Stmt> LowererImplImperative::codeToInitializeDenseAcceleratorArrays(Where
     Stmt inits = Block::make(alreadySetDecl, indexListDecl, allocateAlreadySet, allocateIndexList, zeroInitLoop);
     return {inits, freeTemps};
   } else {
-    Expr sizeOfElt = Sizeof::make(bitGuardType);
-    Expr callocAlreadySet = ir::Call::make("calloc", {bitGuardSize, sizeOfElt}, Int());
-    Stmt allocateAlreadySet = VarDecl::make(alreadySetArr, callocAlreadySet);
-    Stmt inits = Block::make(indexListDecl, allocateIndexList, allocateAlreadySet);
+    // Bit guards are reset after each use, so they only need to be cleared
+    // when they are allocated.  Hash table slots are empty when they hold
+    // coordinate -1.
+    Stmt allocateIndexList = isBitmap ? indexListDecl
+        : codeToAllocateWorkspace(indexListArr, indexListSize, true);
+    Expr emptyGuard = isHashed ? ir::Literal::make(-1)
+                               : ir::Literal::zero(bitGuardType);
+    Stmt allocateAlreadySet = codeToAllocateWorkspace(alreadySetArr,
+                                                      bitGuardSize, true,
+                                                      emptyGuard);
+    freeTemps = Block::make(codeToFreeWorkspace(indexListArr),
+                            codeToFreeWorkspace(alreadySetArr));
+    Stmt inits = Block::make(allocateIndexList, allocateAlreadySet);
     return {inits, freeTemps};
   }
 
 }
 
+Stmt LowererImplImperative::codeToAllocateWorkspace(Expr array, Expr size,
+                                                    bool declare, Expr fill) {
+  taco_iassert(!fill.defined() || isa<ir::Literal>(fill));
+  const bool fillZero = fill.defined() && to<ir::Literal>(fill)->equalsScalar(0);
+  const bool fillOnes = fill.defined() && to<ir::Literal>(fill)->equalsScalar(-1);
+
+  // The pool fills buffers bytewise, so it can only fill them with zeros or
+  // with ones (-1 for signed integers)
+  const int fillByte = fillZero ? 0 : (fillOnes ? 0xff : -1);
+  if (usePersistentWorkspaces &&
+      numPersistentWorkspaces[fillByte] < MAX_PERSISTENT_WORKSPACES &&
+      (!fill.defined() || fillZero || fillOnes)) {
+    const int slot = numPersistentWorkspaces[fillByte]++;
+    persistentWorkspaceSlots.insert({array, slot});
+    Expr bytes = ir::Mul::make(size, Sizeof::make(array.type()));
+    Expr acquire = ir::Call::make("taco_workspace_acquire",
+                                  {slot, bytes, fillByte}, array.type());
+    return declare ? VarDecl::make(array, acquire)
+                   : Assign::make(array, acquire);
+  }
+
+  if (fillZero) {
+    Expr callocArray = ir::Call::make("calloc",
+                                      {size, Sizeof::make(array.type())}, Int());
+    return declare ? VarDecl::make(array, callocArray)
+                   : Assign::make(array, callocArray);
+  }
+  Stmt decl = declare ? VarDecl::make(array, ir::Literal::make(0)) : Stmt();
+  Stmt allocate = Allocate::make(array, size);
+  Stmt initialize;
+  if (fill.defined()) {
+    Expr p = Var::make("p" + util::toString(array), Int());
+    initialize = For::make(p, 0, size, 1, Store::make(array, p, fill));
+  }
+  return Block::make(decl, allocate, initialize);
+}
+
+Stmt LowererImplImperative::codeToFreeWorkspace(Expr array) {
+  if (util::contains(persistentWorkspaceSlots, array)) {
+    return Stmt();
+  }
+  return Free::make(array);
+}
+
 // Returns true if the following conditions are met:
 // 1) The temporary is a dense vector
 // 2) There is only one value on the right hand side of the consumer
@@ -1986,8 +3151,15 @@ std::pair<bool,bool> LowererImplImperative::canAccelerateDenseTemp(Where where)
     return std::make_pair(false, false);
   }
 
-  // Only need to sort the workspace if the result needs to be ordered
-  return std::make_pair(true, varFmt.isOrdered());
+  // Only need to sort the workspace if the result needs to be ordered (bitmap
+  // workspaces are scanned in order)
+  return std::make_pair(true, varFmt.isOrdered() && 
+                              !util::contains(bitmapWorkspaces, temporary));
+}
+
+bool LowererImplImperative::isHashedWorkspace(TensorVar temporary) const {
+  return util::contains(hashedWorkspaces, temporary) && 
+         util::contains(tempToIndexList, temporary);
 }
 
 // Code to initialize the local temporary workspace from the shared workspace
@@ -1999,6 +3171,7 @@ vector<Stmt> LowererImplImperative::codeToInitializeLocalTemporaryParallel(Where
 
   Expr tempSize = getTemporarySize(where);
   Expr threadNum = ir::Call::make("omp_get_thread_num", {}, tempSize.type());
+  Expr bitGuardOffset = ir::Mul::make(getBitGuardSize(where), threadNum);
   tempSize = ir::Mul::make(tempSize, threadNum);
 
   bool accelerateDense = canAccelerateDenseTemp(where).first;
@@ -2040,14 +3213,16 @@ vector<Stmt> LowererImplImperative::codeToInitializeLocalTemporaryParallel(Where
     const Expr indexListSizeExpr = ir::Var::make(indexListName + "_size", taco::Int32, false, false);
 
     // Declare local already set array (bit guard)
-    // TODO: emit as uint64 and manually emit bit pack code
-    const Datatype bitGuardType = taco::Bool;
+    // TODO: emit other bit guards as uint64 too
+    const Datatype bitGuardType = 
+        util::contains(bitmapWorkspaces, temporary) ? UInt64 
+        : (util::contains(hashedWorkspaces, temporary) ? Int32 : taco::Bool);
     const std::string bitGuardName = temporary.getName() + "_already_set";
     const Expr alreadySetArr = ir::Var::make(bitGuardName,
                                              bitGuardType,
                                              true, false);
     Expr bitGuard_all = this->whereToBitGuardAll[where];
-    Expr bitGuardRhs = ir::Add::make(bitGuard_all, tempSize);
+    Expr bitGuardRhs = ir::Add::make(bitGuard_all, bitGuardOffset);
     Stmt bitGuardDecl = ir::VarDecl::make(alreadySetArr, bitGuardRhs);
     decls.push_back(bitGuardDecl);
 
@@ -2091,14 +3266,11 @@ vector<Stmt> LowererImplImperative::codeToInitializeTemporaryParallel(Where wher
     Expr sizeAll = ir::Mul::make(size, ir::Call::make("omp_get_max_threads", {}, size.type()));
 
     // no decl needed for shared memory
-    Stmt decl = Stmt();
-    if ((isa<Forall>(where.getProducer()) && inParallelLoopDepth == 0) || !should_use_CUDA_codegen()) {
-      decl = VarDecl::make(values, ir::Literal::make(0));
-    }
-    Stmt allocate = Allocate::make(values, sizeAll);
+    bool declare = (isa<Forall>(where.getProducer()) && inParallelLoopDepth == 0) || !should_use_CUDA_codegen();
+    Stmt allocate = codeToAllocateWorkspace(values, sizeAll, declare);
 
-    freeTemporary = Block::make(freeTemporary, Free::make(values));
-    initializeTemporary = Block::make(decl, initializeTemporary, allocate);
+    freeTemporary = Block::make(freeTemporary, codeToFreeWorkspace(values));
+    initializeTemporary = Block::make(initializeTemporary, allocate);
   }
   /// Make a struct object that lowerAssignment and lowerAccess can read
   /// temporary value arrays from.
@@ -2144,14 +3316,11 @@ vector<Stmt> LowererImplImperative::codeToInitializeTemporary(Where where) {
       Expr size = getTemporarySize(where);
 
       // no decl needed for shared memory
-      Stmt decl = Stmt();
-      if ((isa<Forall>(where.getProducer()) && inParallelLoopDepth == 0) || !should_use_CUDA_codegen()) {
-        decl = VarDecl::make(values, ir::Literal::make(0));
-      }
-      Stmt allocate = Allocate::make(values, size);
+      bool declare = (isa<Forall>(where.getProducer()) && inParallelLoopDepth == 0) || !should_use_CUDA_codegen();
+      Stmt allocate = codeToAllocateWorkspace(values, size, declare);
 
-      freeTemporary = Block::make(freeTemporary, Free::make(values));
-      initializeTemporary = Block::make(decl, initializeTemporary, allocate);
+      freeTemporary = Block::make(freeTemporary, codeToFreeWorkspace(values));
+      initializeTemporary = Block::make(initializeTemporary, allocate);
     }
 
     /// Make a struct object that lowerAssignment and lowerAccess can read
@@ -2320,6 +3489,18 @@ Stmt LowererImplImperative::lowerAssemble(Assemble assemble) {
       getResultAccesses(assemble.getCompute());
   const auto& queryResults = assemble.getAttrQueryResults();
 
+  // If the result is computed in parallel, then also insert edges of the
+  // result in parallel if its mode formats support it.
+  bool parallelAssemble = false;
+  if (!should_use_CUDA_codegen()) {
+    match(assemble.getCompute(),
+      function<void(const ForallNode*)>([&](const ForallNode* op) {
+        parallelAssemble = parallelAssemble ||
+                           op->parallel_unit == ParallelUnit::CPUThread;
+      })
+    );
+  }
+
   std::vector<Stmt> initAssembleStmts;
   for (const auto& resultAccess : resultAccesses) {
     Expr prevSize = 1;
@@ -2343,8 +3524,19 @@ Stmt LowererImplImperative::lowerAssemble(Assemble assemble) {
                                                           queryResults);
           initAssembleStmts.push_back(initEdges);
 
-          Stmt insertEdgeLoop = resultIterator.getSeqInsertEdge(
-              resultIterator.getParent().getPosVar(), coords, queryResults);
+          Stmt insertEdgeLoop;
+          Stmt finalizeEdges;
+          if (parallelAssemble) {
+            insertEdgeLoop = resultIterator.getParInsertEdge(
+                resultIterator.getParent().getPosVar(), coords, queryResults);
+            finalizeEdges = resultIterator.getParFinalizeEdges(prevSize,
+                                                               queryResults);
+          }
+          const bool parallelEdges = insertEdgeLoop.defined();
+          if (!parallelEdges) {
+            insertEdgeLoop = resultIterator.getSeqInsertEdge(
+                resultIterator.getParent().getPosVar(), coords, queryResults);
+          }
           auto locateCoords = coords;
           for (auto iter = resultIterator.getParent(); !iter.isRoot();
                iter = iter.getParent()) {
@@ -2354,14 +3546,21 @@ Stmt LowererImplImperative::lowerAssemble(Assemble assemble) {
                   resultModeOrdering[iter.getMode().getLevel() - 1]);
               Expr pos = iter.getPosVar();
               Stmt initPos = VarDecl::make(pos, iter.locate(locateCoords)[0]);
+              const bool parallelLoop = parallelEdges &&
+                                        iter.getParent().isRoot();
               insertEdgeLoop = For::make(coords.back(), 0, dim, 1,
-                                         Block::make(initPos, insertEdgeLoop));
+                                         Block::make(initPos, insertEdgeLoop),
+                                         parallelLoop ? LoopKind::Runtime
+                                                      : LoopKind::Serial,
+                                         parallelLoop ? ParallelUnit::CPUThread
+                                                      : ParallelUnit::NotParallel);
             } else {
               taco_not_supported_yet;
             }
             locateCoords.pop_back();
           }
           initAssembleStmts.push_back(insertEdgeLoop);
+          initAssembleStmts.push_back(finalizeEdges);
         }
 
         Stmt initCoords = resultIterator.getInitCoords(prevSize, queryResults);
@@ -2465,6 +3664,10 @@ Expr LowererImplImperative::lowerAccess(Access access) {
     return true;
   }
 
+  if (isHashedWorkspace(var)) {
+    return Load::make(vals, hashedWorkspaceSlots.at(var));
+  }
+
   return Load::make(vals, generateValueLocExpr(access));
 }
 
@@ -2993,8 +4196,8 @@ Stmt LowererImplImperative::declLocatePosVars(vector<Iterator> locators) {
 
     if (doLocate) {
       Iterator locateIterator = locator;
-      if (locateIterator.hasPosIter()) {
-        taco_iassert(!provGraph.isUnderived(locateIterator.getIndexVar()));
+      if (locateIterator.hasPosIter() && 
+          !provGraph.isUnderived(locateIterator.getIndexVar())) {
         continue; // these will be recovered with separate procedure
       }
       do {
@@ -3115,6 +4318,10 @@ Stmt LowererImplImperative::codeToInitializeIteratorVar(Iterator iterator, vecto
           }
           result.push_back(VarDecl::make(iterator.getBeginVar(), binarySearchTarget));
 
+          taco_uassert(iterator.getMode().getModePack().getArray(1).type() ==
+                       Int32) << error::search_requires_int32_index;
+          taco_uassert(hasUnitPosStride(iterator))
+              << error::strided_positions_not_supported;
           vector<Expr> binarySearchArgs = {
                   iterator.getMode().getModePack().getArray(1), // array
                   bounds[0], // arrayStart
@@ -3233,7 +4440,9 @@ Stmt LowererImplImperative::codeToIncIteratorVars(Expr coordinate, IndexVar coor
     Expr ivar = iterators[0].getIteratorVar();
 
     if (iterators[0].isUnique()) {
-      return compoundAssign(ivar, 1);
+      return compoundAssign(ivar, iterators[0].hasPosIter()
+          ? getPosStride(iterators[0].posBounds(iterators[0].getParent().getPosVar()))
+          : 1);
     }
 
     // If iterator is over bottommost coordinate hierarchy level with
@@ -3260,6 +4469,11 @@ Stmt LowererImplImperative::codeToIncIteratorVars(Expr coordinate, IndexVar coor
                      : ir::Cast::make(Eq::make(iterator.getCoordVar(),
                                                coordinate),
                                       ivar.type());
+      if (!hasUnitPosStride(iterator)) {
+        Expr parentPos = iterator.getParent().getPosVar();
+        increment = ir::Mul::make(increment, 
+                                  getPosStride(iterator.posBounds(parentPos)));
+      }
       result.push_back(compoundAssign(ivar, increment));
     } else if (!iterator.isLeaf()) {
       result.push_back(Assign::make(ivar, iterator.getSegendVar()));
@@ -3286,6 +4500,70 @@ Stmt LowererImplImperative::codeToIncIteratorVars(Expr coordinate, IndexVar coor
   return Block::make(result);
 }
 
+/// Returns the crd array that a position iterator loads its coordinates from,
+/// or an undefined expression if its coordinates are not loaded from an array.
+static Expr getGallopCrdArray(const ModeFunction& posAccess, Expr posVar) {
+  if (posAccess.compute().defined() || !isa<ir::Load>(posAccess[0])) {
+    return Expr();
+  }
+  const ir::Load* load = to<ir::Load>(posAccess[0]);
+  Expr loc = load->loc;
+  if (isa<ir::Mul>(loc) && isa<ir::Literal>(to<ir::Mul>(loc)->b) &&
+      to<ir::Literal>(to<ir::Mul>(loc)->b)->equalsScalar(1)) {
+    loc = to<ir::Mul>(loc)->a;
+  }
+  return (loc == posVar && load->arr.type() == Int32) ? load->arr : Expr();
+}
+
+bool LowererImplImperative::canGallop(MergeLattice pointLattice) {
+  MergePoint point = pointLattice.points().front();
+  vector<Iterator> mergers = point.mergers();
+  if (pointLattice.points().size() != 1 || mergers.size() < 2 ||
+      point.rangers().size() != mergers.size()) {
+    return false;
+  }
+  for (auto& iterator : point.iterators()) {
+    if (iterator.hasIndexSet() || iterator.isWindowed()) {
+      return false;
+    }
+  }
+  for (auto& merger : mergers) {
+    if (!merger.hasPosIter() || merger.hasBitmapIter() || 
+        !merger.isOrdered() || !merger.isUnique() || 
+        !hasUnitPosStride(merger)) {
+      return false;
+    }
+    ModeFunction posAccess = merger.posAccess(merger.getPosVar(),
+                                              coordinates(merger));
+    if (!getGallopCrdArray(posAccess, merger.getPosVar()).defined()) {
+      return false;
+    }
+  }
+  return true;
+}
+
+Stmt LowererImplImperative::codeToGallopIteratorVars(Expr coordinate, 
+                                                     vector<Iterator> mergers) {
+  vector<Expr> matches;
+  vector<Stmt> advance;
+  vector<Stmt> gallop;
+  for (auto& merger : mergers) {
+    Expr ivar = merger.getIteratorVar();
+    ModeFunction posAccess = merger.posAccess(merger.getPosVar(),
+                                              coordinates(merger));
+    Expr crd = getGallopCrdArray(posAccess, merger.getPosVar());
+    taco_iassert(crd.defined());
+
+    matches.push_back(Eq::make(merger.getCoordVar(), coordinate));
+    advance.push_back(compoundAssign(ivar, 1));
+    Expr next = Call::make("taco_gallop", {crd, ivar, merger.getEndVar(), 
+                                           coordinate}, ivar.type());
+    gallop.push_back(Assign::make(ivar, next));
+  }
+  return IfThenElse::make(taco::ir::conjunction(matches), 
+                          Block::make(advance), Block::make(gallop));
+}
+
 Stmt LowererImplImperative::codeToLoadCoordinatesFromPosIterators(vector<Iterator> iterators, bool declVars) {
   // Load coordinates from position iterators
   Stmt loadPosIterCoordinates;
@@ -3399,6 +4677,39 @@ Stmt LowererImplImperative::appendCoordinate(vector<Iterator> appenders, Expr co
 }
 
 
+Stmt LowererImplImperative::insertCoordinate(vector<Iterator> inserters, 
+                                             Expr coord) {
+  vector<Stmt> result;
+  for (auto& inserter : inserters) {
+    Stmt insertCoord = inserter.getInsertCoord(inserter.getPosVar(), {coord});
+    const int capacity = inserter.getMode().getModeFormat().getHashCapacity();
+    if (insertCoord.defined() && capacity > 0) {
+      // A new coordinate may not take the last empty slot of its segment,
+      // which locating coordinates that are not stored relies on
+      Expr crd = inserter.getMode().getModePack().getArray(1);
+      Expr segmentBegin = BitAnd::make(inserter.getPosVar(), ~(capacity - 1));
+      Expr fills = Call::make("taco_hashFills", {crd, segmentBegin, capacity,
+                                                inserter.getPosVar()}, Bool);
+      insertCoord = IfThenElse::make(fills, setStatus(KERNEL_HASH_TABLE_FULL),
+                                     insertCoord);
+    }
+    if (insertCoord.defined()) {
+      result.push_back(insertCoord);
+    }
+  }
+  return result.empty() ? Stmt() : Block::make(result);
+}
+
+
+Stmt LowererImplImperative::setStatus(KernelStatus flag) {
+  if (!status.defined()) {
+    status = Var::make("status", Int32);
+  }
+  return Assign::make(status, BitOr::make(status, (int)flag),
+                      inParallelLoopDepth > 0, ParallelUnit::CPUThread);
+}
+
+
 Stmt LowererImplImperative::generateAppendPositions(vector<Iterator> appenders) {
   vector<Stmt> result;
   if (generateAssembleCode()) {
@@ -3616,6 +4927,10 @@ bool LowererImplImperative::hasStores(Stmt stmt) {
 
 Expr LowererImplImperative::searchForStartOfWindowPosition(Iterator iterator, ir::Expr start, ir::Expr end) {
     taco_iassert(iterator.isWindowed());
+    taco_uassert(hasUnitPosStride(iterator))
+        << error::strided_positions_not_supported;
+    taco_uassert(iterator.getMode().getModePack().getArray(1).type() == Int32)
+        << error::search_requires_int32_index;
     vector<Expr> args = {
             // Search over the `crd` array of the level,
             iterator.getMode().getModePack().getArray(1),
@@ -3630,6 +4945,10 @@ Expr LowererImplImperative::searchForStartOfWindowPosition(Iterator iterator, ir
 
 Expr LowererImplImperative::searchForEndOfWindowPosition(Iterator iterator, ir::Expr start, ir::Expr end) {
     taco_iassert(iterator.isWindowed());
+    taco_uassert(hasUnitPosStride(iterator))
+        << error::strided_positions_not_supported;
+    taco_uassert(iterator.getMode().getModePack().getArray(1).type() == Int32)
+        << error::search_requires_int32_index;
     vector<Expr> args = {
             // Search over the `crd` array of the level,
             iterator.getMode().getModePack().getArray(1),
@@ -420,6 +420,16 @@ private:
     vector<Iterator> iterators;
     vector<Iterator> locators;
 
+    // Bitmap iterators are intersected by combining their words with bitwise
+    // AND, which is cheaper than iterating over one and locating into others.
+    iterators = combine(left.iterators(), right.iterators());
+    if (!iterators.empty() &&
+        all(iterators, [](Iterator it){ return it.hasBitmapIter(); })) {
+      locators = combine(left.locators(), right.locators());
+      vector<Iterator> results = combine(left.results(), right.results());
+      return MergePoint(iterators, locators, results);
+    }
+
     tie(iterators, locators) = split((locateLeft ? left : right).iterators(),
                                      [](Iterator it){return !it.hasLocate();});
     iterators = filter(iterators, [](Iterator it) {
@@ -106,9 +106,24 @@ ModePack::ModePack() : content(new Content) {
 }
 
 ModePack::ModePack(size_t numModes, ModeFormat modeType, ir::Expr tensor,
-                   int mode, int level) : ModePack() {
+                   int mode, int level, const vector<Datatype>& arrayTypes)
+    : ModePack() {
   content->numModes = numModes;
   content->arrays = modeType.impl->getArrays(tensor, mode, level);
+
+  // Retype index arrays whose elements are narrower (or wider) than the
+  // default 32-bit integers.
+  for (auto& array : content->arrays) {
+    const ir::GetProperty* prop = array.as<ir::GetProperty>();
+    if (prop == nullptr || prop->property != ir::TensorProperty::Indices ||
+        (size_t)prop->index >= arrayTypes.size() ||
+        arrayTypes[prop->index] == prop->type) {
+      continue;
+    }
+    array = ir::GetProperty::make(prop->tensor, prop->property, prop->mode,
+                                  prop->index, prop->name,
+                                  arrayTypes[prop->index]);
+  }
 }
 
 size_t ModePack::getNumModes() const {
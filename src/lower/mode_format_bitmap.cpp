@@ -0,0 +1,126 @@
+#include "taco/lower/mode_format_bitmap.h"
+
+#include "taco/util/strings.h"
+
+using namespace std;
+using namespace taco::ir;
+
+namespace taco {
+
+BitmapModeFormat::BitmapModeFormat() : BitmapModeFormat(false) {
+}
+
+BitmapModeFormat::BitmapModeFormat(bool isZeroless) :
+    ModeFormatImpl("bitmap", false, true, true, false, false, isZeroless,
+                   false, true, true, true, false, false, false, false) {
+}
+
+ModeFormat BitmapModeFormat::copy(
+    vector<ModeFormat::Property> properties) const {
+  bool isZeroless = this->isZeroless;
+  for (const auto property : properties) {
+    switch (property) {
+      case ModeFormat::ZEROLESS:
+        isZeroless = true;
+        break;
+      case ModeFormat::NOT_ZEROLESS:
+        isZeroless = false;
+        break;
+      default:
+        break;
+    }
+  }
+  return ModeFormat(std::make_shared<BitmapModeFormat>(isZeroless));
+}
+
+ModeFunction BitmapModeFormat::posIterBounds(Expr parentPos, Mode mode) const {
+  Expr pbegin = ir::Mul::make(parentPos, getWidth(mode));
+  Expr pend = ir::Add::make(pbegin, getSizeArray(mode.getModePack()));
+  return ModeFunction(Stmt(), {pbegin, pend});
+}
+
+ModeFunction BitmapModeFormat::posIterAccess(ir::Expr pos,
+                                             std::vector<ir::Expr> coords,
+                                             Mode mode) const {
+  Expr idx = ir::Rem::make(pos, getWidth(mode));
+  Expr word = Load::make(getBitsArray(mode.getModePack()), 
+                         ir::Div::make(pos, 64));
+  Expr bit = Call::make("taco_bit", {pos}, UInt64);
+  return ModeFunction(Stmt(), {idx, Neq::make(BitAnd::make(word, bit), 0)});
+}
+
+ModeFunction BitmapModeFormat::bitmapIterBounds(Expr parentPos, 
+                                                Mode mode) const {
+  Expr numWords = getNumWords(mode);
+  return ModeFunction(Stmt(), {getBitsArray(mode.getModePack()),
+                               ir::Mul::make(parentPos, numWords), numWords});
+}
+
+ModeFunction BitmapModeFormat::locate(ir::Expr parentPos,
+                                      std::vector<ir::Expr> coords,
+                                      Mode mode) const {
+  // Coordinates that are not stored locate to positions whose value is zero,
+  // so the position is always valid.
+  Expr pos = ir::Add::make(ir::Mul::make(parentPos, getWidth(mode)), 
+                           coords.back());
+  return ModeFunction(Stmt(), {pos, true});
+}
+
+Stmt BitmapModeFormat::getInsertCoord(Expr p, const std::vector<Expr>& i,
+                                      Mode mode) const {
+  Expr bitsArray = getBitsArray(mode.getModePack());
+  Expr word = ir::Div::make(p, 64);
+  Expr bit = Call::make("taco_bit", {p}, UInt64);
+  return Store::make(bitsArray, word, 
+                     BitOr::make(Load::make(bitsArray, word), bit));
+}
+
+Expr BitmapModeFormat::getWidth(Mode mode) const {
+  return ir::Mul::make(getNumWords(mode), 64);
+}
+
+Stmt BitmapModeFormat::getInsertInitCoords(Expr pBegin, Expr pEnd,
+                                           Mode mode) const {
+  return Stmt();
+}
+
+Stmt BitmapModeFormat::getInsertInitLevel(Expr szPrev, Expr sz,
+                                          Mode mode) const {
+  taco_uassert(!mode.getParentModeType().defined() ||
+               mode.getParentModeType().hasInsert()) <<
+      "Bitmap levels of results can only be stored below levels that support "
+      "insert";
+
+  Expr bitsArray = getBitsArray(mode.getModePack());
+  return Allocate::make(bitsArray, ir::Div::make(sz, 64), false, Expr(), true);
+}
+
+Stmt BitmapModeFormat::getInsertFinalizeLevel(Expr szPrev, Expr sz,
+                                              Mode mode) const {
+  return Stmt();
+}
+
+vector<Expr> BitmapModeFormat::getArrays(Expr tensor, int mode,
+                                         int level) const {
+  std::string arraysName = util::toString(tensor) + std::to_string(level);
+  return {GetProperty::make(tensor, TensorProperty::Dimension, mode),
+          GetProperty::make(tensor, TensorProperty::Indices,
+                            level - 1, 1, arraysName + "_bits", UInt64)};
+}
+
+Expr BitmapModeFormat::getSizeArray(ModePack pack) const {
+  return pack.getArray(0);
+}
+
+Expr BitmapModeFormat::getBitsArray(ModePack pack) const {
+  return pack.getArray(1);
+}
+
+Expr BitmapModeFormat::getNumWords(Mode mode) const {
+  if (mode.getSize().isFixed()) {
+    return (int)((mode.getSize().getSize() + 63) / 64);
+  }
+  return ir::Div::make(ir::Add::make(getSizeArray(mode.getModePack()), 63), 64);
+}
+
+}
@@ -231,6 +231,27 @@ Stmt CompressedModeFormat::getSeqInsertEdge(Expr parentPos,
   return Store::make(posArray, ir::Add::make(parentPos, 1), pos);
 }
 
+Stmt CompressedModeFormat::getParInsertEdge(Expr parentPos, 
+    std::vector<Expr> coords, std::vector<AttrQueryResult> queries, 
+    Mode mode) const {
+  // The parallel prefix sum is only implemented for 32-bit position arrays.
+  Expr posArray = getPosArray(mode.getModePack());
+  if (posArray.type() != Int32) {
+    return Stmt();
+  }
+  Expr nnz = queries[0].getResult(coords, "nnz");
+  return Store::make(posArray, parentPos, nnz);
+}
+
+Stmt CompressedModeFormat::getParFinalizeEdges(Expr prevSize, 
+    std::vector<AttrQueryResult> queries, Mode mode) const {
+  // Turn the per-segment counts into segment offsets with an exclusive
+  // prefix sum, and store the total number of coordinates at the end.
+  Expr posArray = getPosArray(mode.getModePack());
+  Expr total = Call::make("taco_prefixSum", {posArray, prevSize}, Int32);
+  return Store::make(posArray, prevSize, total);
+}
+
 Stmt CompressedModeFormat::getInitCoords(Expr prevSize, 
     std::vector<AttrQueryResult> queries, Mode mode) const {
   Expr posArray = getPosArray(mode.getModePack());
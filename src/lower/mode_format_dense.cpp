@@ -9,9 +9,12 @@ DenseModeFormat::DenseModeFormat() : DenseModeFormat(true, true, false) {
 }
 
 DenseModeFormat::DenseModeFormat(const bool isOrdered, const bool isUnique, 
-                                 const bool isZeroless) : 
+                                 const bool isZeroless, const int blockSize) : 
     ModeFormatImpl("dense", true, isOrdered, isUnique, false, true, isZeroless, 
-                   false, false, true, true, false, false, false, true) {
+                   false, false, true, true, false, false, false, true),
+    blockSize(blockSize) {
+  taco_uassert(blockSize >= 0)
+      << "Block sizes must be non-negative (0 means unblocked)";
 }
 
 ModeFormat DenseModeFormat::copy(
@@ -43,8 +46,8 @@ ModeFormat DenseModeFormat::copy(
         break;
     }
   }
-  return ModeFormat(
-      std::make_shared<DenseModeFormat>(isOrdered, isUnique, isZeroless));  
+  return ModeFormat(std::make_shared<DenseModeFormat>(isOrdered, isUnique, 
+                                                     isZeroless, blockSize));
 }
 
 ModeFunction DenseModeFormat::locate(ir::Expr parentPos,
@@ -60,6 +63,9 @@ Stmt DenseModeFormat::getInsertCoord(Expr p,
 }
 
 Expr DenseModeFormat::getWidth(Mode mode) const {
+  if (blockSize > 0) {
+    return blockSize;
+  }
   return (mode.getSize().isFixed() && mode.getSize().getSize() < 16) ?
          (int)mode.getSize().getSize() : 
          getSizeArray(mode.getModePack());
@@ -94,8 +100,17 @@ vector<Expr> DenseModeFormat::getArrays(Expr tensor, int mode,
   return {GetProperty::make(tensor, TensorProperty::Dimension, mode)};
 }
 
+int DenseModeFormat::getBlockSize() const {
+  return blockSize;
+}
+
 Expr DenseModeFormat::getSizeArray(ModePack pack) const {
   return pack.getArray(0);
 }
 
+bool DenseModeFormat::equals(const ModeFormatImpl& other) const {
+  return ModeFormatImpl::equals(other) &&
+         (dynamic_cast<const DenseModeFormat&>(other).blockSize == blockSize);
+}
+
 }
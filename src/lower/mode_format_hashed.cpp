@@ -0,0 +1,131 @@
+#include "taco/lower/mode_format_hashed.h"
+
+#include "taco/util/strings.h"
+
+using namespace std;
+using namespace taco::ir;
+
+namespace taco {
+
+HashedModeFormat::HashedModeFormat(int capacity) :
+    HashedModeFormat(true, false, capacity) {
+}
+
+HashedModeFormat::HashedModeFormat(bool isUnique, bool isZeroless,
+                                   int capacity) :
+    ModeFormatImpl("hashed", false, false, isUnique, false, false, isZeroless,
+                   false, true, true, true, false, false, false, false),
+    capacity(capacity) {
+  taco_uassert(capacity > 0 && (capacity & (capacity - 1)) == 0) <<
+      "Hash table capacities must be powers of two";
+}
+
+ModeFormat HashedModeFormat::copy(
+    vector<ModeFormat::Property> properties) const {
+  bool isUnique = this->isUnique;
+  bool isZeroless = this->isZeroless;
+  for (const auto property : properties) {
+    switch (property) {
+      case ModeFormat::UNIQUE:
+        isUnique = true;
+        break;
+      case ModeFormat::NOT_UNIQUE:
+        isUnique = false;
+        break;
+      case ModeFormat::ZEROLESS:
+        isZeroless = true;
+        break;
+      case ModeFormat::NOT_ZEROLESS:
+        isZeroless = false;
+        break;
+      default:
+        break;
+    }
+  }
+  return ModeFormat(std::make_shared<HashedModeFormat>(isUnique, isZeroless,
+                                                      capacity));
+}
+
+ModeFunction HashedModeFormat::posIterBounds(Expr parentPos, Mode mode) const {
+  Expr pbegin = ir::Mul::make(parentPos, capacity);
+  Expr pend = ir::Mul::make(ir::Add::make(parentPos, 1), capacity);
+  return ModeFunction(Stmt(), {pbegin, pend});
+}
+
+ModeFunction HashedModeFormat::posIterAccess(ir::Expr pos,
+                                             std::vector<ir::Expr> coords,
+                                             Mode mode) const {
+  Expr idx = Load::make(getCoordArray(mode.getModePack()), pos);
+  return ModeFunction(Stmt(), {idx, ir::Gte::make(idx, 0)});
+}
+
+ModeFunction HashedModeFormat::locate(ir::Expr parentPos,
+                                      std::vector<ir::Expr> coords,
+                                      Mode mode) const {
+  Expr crdArray = getCoordArray(mode.getModePack());
+  taco_uassert(crdArray.type() == Int32) <<
+      "Hashed levels must have 32-bit coordinate arrays";
+
+  // Coordinates that are not stored map to an empty slot, whose value is zero,
+  // so the position is always valid.
+  vector<Expr> args = {crdArray, ir::Mul::make(parentPos, capacity), capacity,
+                       coords.back()};
+  Expr pos = Call::make("taco_hashLocate", args, Int32);
+  return ModeFunction(Stmt(), {pos, true});
+}
+
+Stmt HashedModeFormat::getInsertCoord(Expr p, const std::vector<Expr>& i,
+                                      Mode mode) const {
+  return Store::make(getCoordArray(mode.getModePack()), p, i.back());
+}
+
+Expr HashedModeFormat::getWidth(Mode mode) const {
+  return capacity;
+}
+
+Stmt HashedModeFormat::getInsertInitCoords(Expr pBegin, Expr pEnd,
+                                           Mode mode) const {
+  return Stmt();
+}
+
+Stmt HashedModeFormat::getInsertInitLevel(Expr szPrev, Expr sz,
+                                          Mode mode) const {
+  taco_uassert(!mode.getParentModeType().defined() ||
+               mode.getParentModeType().hasInsert()) <<
+      "Hashed levels of results can only be stored below dense or hashed "
+      "levels";
+
+  Expr crdArray = getCoordArray(mode.getModePack());
+  Expr pVar = Var::make("p" + mode.getName(), Int());
+  Stmt clearSlot = Store::make(crdArray, pVar, -1);
+  return Block::make(Allocate::make(crdArray, sz),
+                     For::make(pVar, 0, sz, 1, clearSlot));
+}
+
+Stmt HashedModeFormat::getInsertFinalizeLevel(Expr szPrev, Expr sz,
+                                              Mode mode) const {
+  return Stmt();
+}
+
+vector<Expr> HashedModeFormat::getArrays(Expr tensor, int mode,
+                                         int level) const {
+  std::string arraysName = util::toString(tensor) + std::to_string(level);
+  return {Expr(),
+          GetProperty::make(tensor, TensorProperty::Indices,
+                            level - 1, 1, arraysName + "_crd")};
+}
+
+int HashedModeFormat::getCapacity() const {
+  return capacity;
+}
+
+Expr HashedModeFormat::getCoordArray(ModePack pack) const {
+  return pack.getArray(1);
+}
+
+bool HashedModeFormat::equals(const ModeFormatImpl& other) const {
+  return ModeFormatImpl::equals(other) &&
+         (dynamic_cast<const HashedModeFormat&>(other).capacity == capacity);
+}
+
+}
@@ -196,6 +196,23 @@ ModeFunction ModeFormatImpl::posIterAccess(ir::Expr pos,
   return ModeFunction();
 }
 
+ModeFunction ModeFormatImpl::bitmapIterBounds(ir::Expr parentPos,
+                                            Mode mode) const {
+  return ModeFunction();
+}
+
+ModeFunction ModeFormatImpl::chunkIterBounds(ir::Expr chunk, 
+                                            ir::Expr numSegments,
+                                            Mode mode) const {
+  return ModeFunction();
+}
+
+ModeFunction ModeFormatImpl::chunkIterAccess(ir::Expr chunk, ir::Expr lane,
+                                            ir::Expr numSegments,
+                                            Mode mode) const {
+  return ModeFunction();
+}
+
 ModeFunction ModeFormatImpl::locate(ir::Expr parentPos,
                                   std::vector<ir::Expr> coords,
                                   Mode mode) const {
@@ -269,6 +286,16 @@ Stmt ModeFormatImpl::getSeqInsertEdge(Expr parentPos, std::vector<Expr> coords,
   return Stmt();
 }
 
+Stmt ModeFormatImpl::getParInsertEdge(Expr parentPos, std::vector<Expr> coords,
+    std::vector<AttrQueryResult> queries, Mode mode) const {
+  return Stmt();
+}
+
+Stmt ModeFormatImpl::getParFinalizeEdges(Expr prevSize,
+    std::vector<AttrQueryResult> queries, Mode mode) const {
+  return Stmt();
+}
+
 Stmt ModeFormatImpl::getInitCoords(Expr prevSize, 
     std::vector<AttrQueryResult> queries, Mode mode) const {
   return Stmt();
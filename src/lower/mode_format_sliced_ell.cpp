@@ -0,0 +1,129 @@
+#include "taco/lower/mode_format_sliced_ell.h"
+
+#include "taco/util/strings.h"
+
+using namespace std;
+using namespace taco::ir;
+
+namespace taco {
+
+SlicedEllModeFormat::SlicedEllModeFormat(int chunkSize, int sortWindow) :
+    SlicedEllModeFormat(true, true, false, chunkSize, sortWindow) {
+}
+
+SlicedEllModeFormat::SlicedEllModeFormat(bool isOrdered, bool isUnique,
+                                         bool isZeroless, int chunkSize,
+                                         int sortWindow) :
+    ModeFormatImpl("sliced_ell", false, isOrdered, isUnique, false, false,
+                   isZeroless, false, true, false, false, false, false, false,
+                   false),
+    chunkSize(chunkSize), sortWindow(sortWindow) {
+  taco_uassert(chunkSize > 0) << "Chunk sizes must be positive";
+  taco_uassert(sortWindow > 0) << "Sort windows must be positive";
+}
+
+ModeFormat SlicedEllModeFormat::copy(
+    vector<ModeFormat::Property> properties) const {
+  bool isOrdered = this->isOrdered;
+  bool isUnique = this->isUnique;
+  bool isZeroless = this->isZeroless;
+  for (const auto property : properties) {
+    switch (property) {
+      case ModeFormat::ORDERED:
+        isOrdered = true;
+        break;
+      case ModeFormat::NOT_ORDERED:
+        isOrdered = false;
+        break;
+      case ModeFormat::UNIQUE:
+        isUnique = true;
+        break;
+      case ModeFormat::NOT_UNIQUE:
+        isUnique = false;
+        break;
+      case ModeFormat::ZEROLESS:
+        isZeroless = true;
+        break;
+      case ModeFormat::NOT_ZEROLESS:
+        isZeroless = false;
+        break;
+      default:
+        break;
+    }
+  }
+  return ModeFormat(std::make_shared<SlicedEllModeFormat>(isOrdered, isUnique,
+      isZeroless, chunkSize, sortWindow));
+}
+
+ModeFunction SlicedEllModeFormat::posIterBounds(Expr parentPos,
+                                                Mode mode) const {
+  Expr posArray = getPosArray(mode.getModePack());
+  Expr segment = ir::Mul::make(parentPos, 2);
+  Expr pbegin = Load::make(posArray, segment);
+  Expr pend = Load::make(posArray, ir::Add::make(segment, 1));
+  return ModeFunction(Stmt(), {pbegin, pend, chunkSize});
+}
+
+ModeFunction SlicedEllModeFormat::posIterAccess(ir::Expr pos,
+                                                std::vector<ir::Expr> coords,
+                                                Mode mode) const {
+  taco_iassert(mode.getPackLocation() == 0);
+  Expr idx = Load::make(getCoordArray(mode.getModePack()), pos);
+  return ModeFunction(Stmt(), {idx, true});
+}
+
+ModeFunction SlicedEllModeFormat::chunkIterBounds(Expr chunk, Expr numSegments,
+                                                  Mode mode) const {
+  Expr posArray = getPosArray(mode.getModePack());
+  Expr chunkPos = ir::Add::make(ir::Mul::make(numSegments, 2), chunk);
+  Expr pbegin = Load::make(posArray, chunkPos);
+  Expr pend = Load::make(posArray, ir::Add::make(chunkPos, 1));
+  return ModeFunction(Stmt(), {pbegin, pend});
+}
+
+ModeFunction SlicedEllModeFormat::chunkIterAccess(Expr chunk, Expr lane,
+                                                  Expr numSegments,
+                                                  Mode mode) const {
+  Expr posArray = getPosArray(mode.getModePack());
+  Expr numChunks = ir::Div::make(ir::Add::make(numSegments, chunkSize - 1),
+                                 chunkSize);
+  Expr lanes = ir::Add::make(ir::Add::make(ir::Mul::make(numSegments, 2),
+                                           numChunks), 1);
+  Expr laneIdx = ir::Add::make(ir::Mul::make(chunk, chunkSize), lane);
+  return ModeFunction(Stmt(), {Load::make(posArray, 
+                                          ir::Add::make(lanes, laneIdx))});
+}
+
+vector<Expr> SlicedEllModeFormat::getArrays(Expr tensor, int mode,
+                                            int level) const {
+  std::string arraysName = util::toString(tensor) + std::to_string(level);
+  return {GetProperty::make(tensor, TensorProperty::Indices,
+                            level - 1, 0, arraysName + "_pos"),
+          GetProperty::make(tensor, TensorProperty::Indices,
+                            level - 1, 1, arraysName + "_crd")};
+}
+
+int SlicedEllModeFormat::getChunkSize() const {
+  return chunkSize;
+}
+
+int SlicedEllModeFormat::getSortWindow() const {
+  return sortWindow;
+}
+
+Expr SlicedEllModeFormat::getPosArray(ModePack pack) const {
+  return pack.getArray(0);
+}
+
+Expr SlicedEllModeFormat::getCoordArray(ModePack pack) const {
+  return pack.getArray(1);
+}
+
+bool SlicedEllModeFormat::equals(const ModeFormatImpl& other) const {
+  auto& otherFormat = dynamic_cast<const SlicedEllModeFormat&>(other);
+  return ModeFormatImpl::equals(other) &&
+         (otherFormat.chunkSize == chunkSize) &&
+         (otherFormat.sortWindow == sortWindow);
+}
+
+}
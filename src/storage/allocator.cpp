@@ -0,0 +1,742 @@
+#include "taco/storage/allocator.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <unistd.h>
+
+#if USE_OPENMP
+#include <omp.h>
+#endif
+
+#ifdef __linux__
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#endif
+
+#include "taco/tensor.h"
+#include "taco/codegen/module.h"
+#include "taco/error.h"
+#include "taco/util/uncopyable.h"
+
+using namespace std;
+
+namespace taco {
+
+static void* systemAllocate(void* context, size_t size) {
+  return malloc(size);
+}
+
+static void* systemCallocate(void* context, size_t num, size_t size) {
+  return calloc(num, size);
+}
+
+static void* systemReallocate(void* context, void* ptr, size_t size) {
+  return realloc(ptr, size);
+}
+
+static void systemDeallocate(void* context, void* ptr) {
+  free(ptr);
+}
+
+static const taco_allocator_t systemAllocator = {
+  systemAllocate, systemCallocate, systemReallocate, systemDeallocate, nullptr
+};
+
+static atomic<const taco_allocator_t*> activeAllocator(&systemAllocator);
+
+static atomic<bool> trackingEnabled(false);
+
+static atomic<size_t> bytesAllocated(0);
+static atomic<size_t> numAllocations(0);
+static atomic<size_t> numDeallocations(0);
+static atomic<long long> bytesInUse(0);
+static atomic<size_t> peakBytesInUse(0);
+
+/// The innermost allocation scope of each thread.
+static thread_local AllocationScope* innermostScope = nullptr;
+
+/// The scope that includes the taco threads, for the taco threads of the
+/// parallel regions started from the scope.
+static thread_local AllocationScope* launchingScope = nullptr;
+
+static void updatePeak(atomic<size_t>& peak, long long bytes) {
+  size_t value = (size_t)std::max(bytes, 0ll);
+  size_t current = peak.load(memory_order_relaxed);
+  while (value > current &&
+         !peak.compare_exchange_weak(current, value, memory_order_relaxed)) {
+  }
+}
+
+/// Tracks the allocation statistics and the allocation scopes, with atomic
+/// counters so that threads that allocate concurrently do not serialize.
+struct AllocationTracker {
+  /// Records that the bytes in use changed by `change`, of which `allocated`
+  /// bytes were requested by an allocation or reallocation.
+  static void track(long long change, size_t allocated) {
+    updatePeak(peakBytesInUse,
+               bytesInUse.fetch_add(change, memory_order_relaxed) + change);
+    AllocationScope* scope = (innermostScope != nullptr) ? innermostScope
+                                                         : launchingScope;
+    if (scope != nullptr) {
+      updatePeak(scope->peakBytes,
+                 scope->bytesInUse.fetch_add(change, memory_order_relaxed) +
+                 change);
+      scope->bytesAllocated.fetch_add(allocated, memory_order_relaxed);
+    }
+  }
+
+  /// Sets the launching scope of the taco threads other than the calling one.
+  static void setLaunchingScope(AllocationScope* scope) {
+#if USE_OPENMP
+    #pragma omp parallel num_threads(taco_get_num_threads())
+    if (omp_get_thread_num() != 0) {
+      launchingScope = scope;
+    }
+#endif
+  }
+};
+
+AllocationScope::AllocationScope(bool includeThreads)
+    : parent(innermostScope), includeThreads(includeThreads && trackingEnabled),
+      bytesInUse(0), peakBytes(0), bytesAllocated(0) {
+  innermostScope = this;
+  if (this->includeThreads) {
+    AllocationTracker::setLaunchingScope(this);
+  }
+}
+
+AllocationScope::~AllocationScope() {
+  taco_iassert(innermostScope == this) << "Allocation scopes must nest";
+  if (includeThreads) {
+    AllocationTracker::setLaunchingScope(nullptr);
+  }
+  innermostScope = parent;
+  if (parent != nullptr) {
+    updatePeak(parent->peakBytes, parent->bytesInUse + (long long)peakBytes);
+    parent->bytesInUse += bytesInUse;
+    parent->bytesAllocated += bytesAllocated;
+  }
+}
+
+size_t AllocationScope::getBytesAllocated() const {
+  return bytesAllocated;
+}
+
+size_t AllocationScope::getPeakBytes() const {
+  return peakBytes;
+}
+
+void setMemoryTracking(bool enabled) {
+  trackingEnabled = enabled;
+}
+
+bool isMemoryTrackingEnabled() {
+  return trackingEnabled;
+}
+
+/// Taco allocations are preceded by a header of one cache line, which keeps
+/// the alignment of the memory that allocators return.  Arena allocations are
+/// aligned to cache lines and preceded by a header of the same size.
+static const size_t ALIGNMENT = 64;
+
+/// The header of taco allocations, which lets deallocations update the
+/// statistics without looking up the sizes of live allocations.
+struct AllocationHeader {
+  size_t size;
+  bool   tracked;  // whether the allocation is counted in the statistics
+  bool   mapped;   // whether taco mapped the memory to interleave its pages
+};
+
+static AllocationHeader* headerOf(void* ptr) {
+  return (AllocationHeader*)((char*)ptr - ALIGNMENT);
+}
+
+/// Initializes the header of new memory of `size` bytes after the header, and
+/// returns the memory after the header.
+static void* initAllocation(void* memory, size_t size, bool mapped) {
+  if (memory == nullptr) {
+    return nullptr;
+  }
+  AllocationHeader* header = (AllocationHeader*)memory;
+  header->size = size;
+  header->mapped = mapped;
+  header->tracked = trackingEnabled.load(memory_order_relaxed);
+  if (header->tracked) {
+    bytesAllocated.fetch_add(size, memory_order_relaxed);
+    numAllocations.fetch_add(1, memory_order_relaxed);
+    AllocationTracker::track(size, size);
+  }
+  return (char*)memory + ALIGNMENT;
+}
+
+static size_t alignUp(size_t size, size_t alignment) {
+  return (size + alignment - 1) / alignment * alignment;
+}
+
+static atomic<NumaPlacement> numaPlacement(NumaPlacement::Default);
+
+/// Allocations smaller than this are not placed, since they span few pages.
+static const size_t NUMA_PLACEMENT_THRESHOLD = 1 << 20;
+
+static size_t getPageSize() {
+  static const size_t pageSize = sysconf(_SC_PAGESIZE);
+  return pageSize;
+}
+
+/// Returns whether the calling thread runs in a parallel region, such as those
+/// of generated kernels, where pages are not placed in parallel.
+static bool inParallelRegion() {
+#if USE_OPENMP
+  return omp_in_parallel();
+#else
+  return false;
+#endif
+}
+
+/// Calls `f` with the part of each page that the memory spans, from the taco
+/// threads.  The threads partition the pages with taco's parallel schedule,
+/// like parallel loops of generated kernels partition their iterations.
+template <typename F>
+static void forEachPage(void* ptr, size_t size, F f) {
+  const size_t pageSize = getPageSize();
+  const size_t begin = (size_t)ptr;
+  const size_t end = begin + size;
+  const size_t firstPage = begin / pageSize * pageSize;
+  long numPages = (long)((end - firstPage + pageSize - 1) / pageSize);
+#if USE_OPENMP
+  omp_sched_t existingSched;
+  int existingChunkSize;
+  ParallelSchedule tacoSched;
+  int tacoChunkSize;
+  omp_get_schedule(&existingSched, &existingChunkSize);
+  taco_get_parallel_schedule(&tacoSched, &tacoChunkSize);
+  omp_set_schedule(tacoSched == ParallelSchedule::Dynamic ? omp_sched_dynamic
+                                                          : omp_sched_static,
+                   tacoChunkSize);
+  #pragma omp parallel for schedule(runtime) num_threads(taco_get_num_threads())
+#endif
+  for (long page = 0; page < numPages; page++) {
+    size_t pageBegin = std::max(firstPage + page * pageSize, begin);
+    size_t pageEnd = std::min(firstPage + (page + 1) * pageSize, end);
+    f((char*)pageBegin, pageEnd - pageBegin);
+  }
+#if USE_OPENMP
+  omp_set_schedule(existingSched, existingChunkSize);
+#endif
+}
+
+/// Touches the pages of the memory from the taco threads, so that the pages
+/// are placed on the nodes of the threads.  Pages that were touched before
+/// keep their place.
+static void touchPages(void* ptr, size_t size) {
+  forEachPage(ptr, size, [](char* page, size_t) {
+    volatile char* byte = page;
+    *byte = *byte;
+  });
+}
+
+/// Zeroes the memory, from the taco threads like `touchPages` unless the
+/// calling thread runs in a parallel region.
+static void zeroPages(void* ptr, size_t size) {
+  if (inParallelRegion()) {
+    memset(ptr, 0, size);
+    return;
+  }
+  forEachPage(ptr, size, [](char* page, size_t pageSize) {
+    memset(page, 0, pageSize);
+  });
+}
+
+#if defined(__linux__) && defined(SYS_mbind)
+/// Returns the mask of the online NUMA nodes, or an empty mask if the system
+/// has only one node.
+static vector<unsigned long> getNumaNodeMask() {
+  vector<unsigned long> mask;
+  ifstream online("/sys/devices/system/node/online");
+  string ranges;
+  if (!getline(online, ranges)) {
+    return mask;
+  }
+  int numNodes = 0;
+  stringstream rangeStream(ranges);
+  string range;
+  while (getline(rangeStream, range, ',')) {
+    size_t dash = range.find('-');
+    int first = stoi(range.substr(0, dash));
+    int last = (dash == string::npos) ? first : stoi(range.substr(dash + 1));
+    for (int node = first; node <= last; node++) {
+      const size_t bits = 8 * sizeof(unsigned long);
+      mask.resize(std::max(mask.size(), node / bits + 1), 0);
+      mask[node / bits] |= 1ul << (node % bits);
+      numNodes++;
+    }
+  }
+  return (numNodes > 1) ? mask : vector<unsigned long>();
+}
+#endif
+
+/// Maps `size` bytes of memory whose pages are interleaved across the NUMA
+/// nodes when they are first touched.  Returns null if the system has one node
+/// or the memory cannot be mapped.
+static void* mapInterleaved(size_t size) {
+#if defined(__linux__) && defined(SYS_mbind)
+  static const vector<unsigned long> nodeMask = getNumaNodeMask();
+  if (nodeMask.empty()) {
+    return nullptr;
+  }
+  void* memory = mmap(nullptr, size, PROT_READ | PROT_WRITE,
+                      MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+  if (memory == MAP_FAILED) {
+    return nullptr;
+  }
+  const int interleave = 3;  // MPOL_INTERLEAVE
+  syscall(SYS_mbind, memory, size, interleave, nodeMask.data(),
+          nodeMask.size() * 8 * sizeof(unsigned long) + 1, 0);
+  return memory;
+#else
+  return nullptr;
+#endif
+}
+
+/// Returns whether taco maps the memory of allocations of `size` bytes from
+/// the allocator to interleave their pages.  Only memory that taco maps itself
+/// is interleaved, so other allocators place their memory themselves.
+static bool mapsInterleaved(const taco_allocator_t* allocator, size_t size) {
+  return size >= NUMA_PLACEMENT_THRESHOLD && allocator == &systemAllocator &&
+         numaPlacement.load(memory_order_relaxed) == NumaPlacement::Interleave;
+}
+
+/// Allocates memory for `size` bytes after an allocation header, zeroed if
+/// `zero` is true.
+static void* allocateMemory(const taco_allocator_t* allocator, size_t size,
+                            bool zero, bool* mapped) {
+  *mapped = false;
+  if (mapsInterleaved(allocator, size)) {
+    // Fresh mappings are zeroed by the operating system.
+    void* memory = mapInterleaved(ALIGNMENT + size);
+    if (memory != nullptr) {
+      *mapped = true;
+      return memory;
+    }
+  }
+  if (!zero) {
+    return allocator->allocate(allocator->context, ALIGNMENT + size);
+  }
+  // Zeroing first touches the pages, so it follows the NUMA placement.
+  if (allocator->callocate != nullptr &&
+      (size < NUMA_PLACEMENT_THRESHOLD ||
+       numaPlacement.load(memory_order_relaxed) != NumaPlacement::FirstTouch)) {
+    return allocator->callocate(allocator->context, 1, ALIGNMENT + size);
+  }
+  void* memory = allocator->allocate(allocator->context, ALIGNMENT + size);
+  if (memory != nullptr) {
+    zeroPages((char*)memory + ALIGNMENT, size);
+  }
+  return memory;
+}
+
+/// Frees memory that `allocateMemory` allocated.
+static void freeMemory(const taco_allocator_t* allocator,
+                       AllocationHeader* header) {
+#ifdef __linux__
+  if (header->mapped) {
+    munmap(header, ALIGNMENT + header->size);
+    return;
+  }
+#endif
+  allocator->deallocate(allocator->context, header);
+}
+
+/// Places the pages of bytes [begin, size) of a new or grown allocation by
+/// first touch, if that is the NUMA placement.  Allocations made in parallel
+/// regions are not placed, since that would nest parallel regions.
+static void* placePages(void* ptr, size_t begin, size_t size) {
+  if (ptr == nullptr || size < NUMA_PLACEMENT_THRESHOLD || begin >= size ||
+      numaPlacement.load(memory_order_relaxed) != NumaPlacement::FirstTouch ||
+      inParallelRegion()) {
+    return ptr;
+  }
+  touchPages((char*)ptr + begin, size - begin);
+  return ptr;
+}
+
+void setNumaPlacement(NumaPlacement placement) {
+  numaPlacement = placement;
+}
+
+NumaPlacement getNumaPlacement() {
+  return numaPlacement;
+}
+
+void setAllocator(const taco_allocator_t* allocator) {
+  // Pooled workspaces are freed with the allocator that allocated them, so
+  // they are released while it is still active.
+  ir::Module::releaseWorkspaces();
+  activeAllocator = (allocator != nullptr) ? allocator : &systemAllocator;
+}
+
+const taco_allocator_t* getAllocator() {
+  return activeAllocator;
+}
+
+void* allocate(size_t size) {
+  const taco_allocator_t* allocator = activeAllocator;
+  bool mapped;
+  void* memory = allocateMemory(allocator, size, false, &mapped);
+  return placePages(initAllocation(memory, size, mapped), 0, size);
+}
+
+void* callocate(size_t num, size_t size) {
+  const taco_allocator_t* allocator = activeAllocator;
+  size_t bytes = num * size;
+  bool mapped;
+  void* memory = allocateMemory(allocator, bytes, true, &mapped);
+  return initAllocation(memory, bytes, mapped);
+}
+
+void* reallocate(void* ptr, size_t size) {
+  if (ptr == nullptr) {
+    return allocate(size);
+  }
+  const taco_allocator_t* allocator = activeAllocator;
+  AllocationHeader* header = headerOf(ptr);
+  const AllocationHeader old = *header;
+  void* memory;
+  bool mapped = false;
+  if (old.mapped || mapsInterleaved(allocator, size)) {
+    // Mapped memory, and memory that grows large while pages are interleaved,
+    // moves to new memory.
+    memory = allocateMemory(allocator, size, false, &mapped);
+    if (memory != nullptr) {
+      memcpy((char*)memory + ALIGNMENT, ptr, std::min(old.size, size));
+      freeMemory(allocator, header);
+    }
+  } else {
+    memory = allocator->reallocate(allocator->context, header,
+                                   ALIGNMENT + size);
+  }
+  // A failed reallocation leaves the old memory allocated.
+  if (memory == nullptr) {
+    return nullptr;
+  }
+  if (old.tracked) {
+    AllocationTracker::track(-(long long)old.size, 0);
+  }
+  // The pages of the old memory were placed before, or copied to new memory.
+  return placePages(initAllocation(memory, size, mapped), old.size, size);
+}
+
+void deallocate(void* ptr) {
+  deallocate(activeAllocator, ptr);
+}
+
+void deallocate(const taco_allocator_t* allocator, void* ptr) {
+  if (ptr == nullptr) {
+    return;
+  }
+  AllocationHeader* header = headerOf(ptr);
+  if (header->tracked) {
+    numDeallocations.fetch_add(1, memory_order_relaxed);
+    AllocationTracker::track(-(long long)header->size, 0);
+  }
+  freeMemory(allocator, header);
+}
+
+static void* kernelAllocate(void* context, size_t size) {
+  return allocate(size);
+}
+
+static void* kernelCallocate(void* context, size_t num, size_t size) {
+  return callocate(num, size);
+}
+
+static void* kernelReallocate(void* context, void* ptr, size_t size) {
+  return reallocate(ptr, size);
+}
+
+static void kernelDeallocate(void* context, void* ptr) {
+  deallocate(ptr);
+}
+
+taco_allocator_t* getKernelAllocator() {
+  static taco_allocator_t kernelAllocator = {
+    kernelAllocate, kernelCallocate, kernelReallocate, kernelDeallocate, nullptr
+  };
+  return &kernelAllocator;
+}
+
+AllocatorStats getAllocatorStats() {
+  AllocatorStats stats;
+  stats.bytesAllocated = bytesAllocated;
+  stats.numAllocations = numAllocations;
+  stats.numDeallocations = numDeallocations;
+  stats.bytesInUse = (size_t)std::max(bytesInUse.load(), 0ll);
+  stats.peakBytesInUse = peakBytesInUse;
+  return stats;
+}
+
+void resetAllocatorStats() {
+  bytesAllocated = 0;
+  numAllocations = 0;
+  numDeallocations = 0;
+  peakBytesInUse = (size_t)std::max(bytesInUse.load(), 0ll);
+}
+
+
+// class ArenaAllocator
+struct ArenaAllocator::Content : util::Uncopyable {
+  struct Block {
+    char*  memory;
+    char*  begin;
+    size_t capacity;
+  };
+
+  size_t         blockSize;
+  mutable mutex  lock;
+  vector<Block>  blocks;
+  size_t         offset = 0;
+  char*          last = nullptr;
+  taco_allocator_t functions;
+
+  ~Content() {
+    ir::Module::releaseWorkspaces();
+    for (auto& block : blocks) {
+      free(block.memory);
+    }
+  }
+
+  static size_t& sizeOf(void* ptr) {
+    return *(size_t*)((char*)ptr - ALIGNMENT);
+  }
+
+  void* allocate(size_t size) {
+    size_t needed = ALIGNMENT + alignUp(size, ALIGNMENT);
+    if (blocks.empty() || offset + needed > blocks.back().capacity) {
+      Block block;
+      block.capacity = std::max(blockSize, needed);
+      block.memory = (char*)malloc(block.capacity + ALIGNMENT);
+      if (block.memory == nullptr) {
+        return nullptr;
+      }
+      block.begin = (char*)alignUp((size_t)block.memory, ALIGNMENT);
+      blocks.push_back(block);
+      offset = 0;
+    }
+    last = blocks.back().begin + offset + ALIGNMENT;
+    sizeOf(last) = size;
+    offset += needed;
+    return last;
+  }
+
+  void* reallocate(void* ptr, size_t size) {
+    if (ptr == nullptr) {
+      return allocate(size);
+    }
+    // The most recent allocation grows in place if its block has room.
+    if (ptr == last) {
+      size_t begin = (char*)ptr - blocks.back().begin;
+      if (begin + alignUp(size, ALIGNMENT) <= blocks.back().capacity) {
+        sizeOf(ptr) = size;
+        offset = begin + alignUp(size, ALIGNMENT);
+        return ptr;
+      }
+    }
+    size_t oldSize = sizeOf(ptr);
+    void* newPtr = allocate(size);
+    if (newPtr != nullptr) {
+      memcpy(newPtr, ptr, std::min(oldSize, size));
+    }
+    return newPtr;
+  }
+
+  void deallocate(void* ptr) {
+    // Only the most recent allocation can be returned to the arena.
+    if (ptr != nullptr && ptr == last) {
+      offset = ((char*)ptr - ALIGNMENT) - blocks.back().begin;
+      last = nullptr;
+    }
+  }
+
+  static void* allocate(void* context, size_t size) {
+    Content* content = (Content*)context;
+    lock_guard<mutex> guard(content->lock);
+    return content->allocate(size);
+  }
+
+  static void* reallocate(void* context, void* ptr, size_t size) {
+    Content* content = (Content*)context;
+    lock_guard<mutex> guard(content->lock);
+    return content->reallocate(ptr, size);
+  }
+
+  static void deallocate(void* context, void* ptr) {
+    Content* content = (Content*)context;
+    lock_guard<mutex> guard(content->lock);
+    content->deallocate(ptr);
+  }
+};
+
+ArenaAllocator::ArenaAllocator(size_t blockSize) : content(new Content) {
+  taco_uassert(blockSize > 0) << "Arena blocks must not be empty";
+  content->blockSize = blockSize;
+  content->functions = {Content::allocate, nullptr, Content::reallocate,
+                        Content::deallocate, content.get()};
+}
+
+void ArenaAllocator::reset() {
+  // Pooled workspaces may be allocated from the arena, and deallocating them
+  // locks the arena.
+  ir::Module::releaseWorkspaces();
+  lock_guard<mutex> guard(content->lock);
+  for (size_t i = 1; i < content->blocks.size(); i++) {
+    free(content->blocks[i].memory);
+  }
+  content->blocks.resize(std::min(content->blocks.size(), (size_t)1));
+  content->offset = 0;
+  content->last = nullptr;
+}
+
+size_t ArenaAllocator::getReservedBytes() const {
+  lock_guard<mutex> guard(content->lock);
+  size_t reserved = 0;
+  for (auto& block : content->blocks) {
+    reserved += block.capacity;
+  }
+  return reserved;
+}
+
+const taco_allocator_t* ArenaAllocator::getAllocator() const {
+  return &content->functions;
+}
+
+
+// class HugePageAllocator
+#if defined(__linux__) && defined(MADV_HUGEPAGE)
+#define TACO_HUGE_PAGES 1
+static const size_t HUGE_PAGE_SIZE = 2 << 20;
+#else
+#define TACO_HUGE_PAGES 0
+#endif
+
+struct HugePageAllocator::Content : util::Uncopyable {
+  /// The header that precedes each allocation
+  struct Header {
+    size_t size;
+    size_t mapped;  // size of the huge page mapping, or 0 if malloc'ed
+  };
+
+  size_t threshold;
+  taco_allocator_t functions;
+
+  static Header* headerOf(void* ptr) {
+    return (Header*)((char*)ptr - ALIGNMENT);
+  }
+
+  void* allocate(size_t size) const {
+#if TACO_HUGE_PAGES
+    if (size >= threshold) {
+      // Over-map by a huge page and trim the mapping to huge page boundaries.
+      size_t mapped = alignUp(ALIGNMENT + size, HUGE_PAGE_SIZE);
+      char* memory = (char*)mmap(nullptr, mapped + HUGE_PAGE_SIZE,
+                                 PROT_READ | PROT_WRITE,
+                                 MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (memory != MAP_FAILED) {
+        char* begin = (char*)alignUp((size_t)memory, HUGE_PAGE_SIZE);
+        if (begin != memory) {
+          munmap(memory, begin - memory);
+        }
+        munmap(begin + mapped, (memory + HUGE_PAGE_SIZE) - begin);
+        madvise(begin, mapped, MADV_HUGEPAGE);
+        Header* header = (Header*)begin;
+        header->size = size;
+        header->mapped = mapped;
+        return begin + ALIGNMENT;
+      }
+    }
+#endif
+    void* memory = nullptr;
+    if (posix_memalign(&memory, ALIGNMENT, ALIGNMENT + size) != 0) {
+      return nullptr;
+    }
+    Header* header = (Header*)memory;
+    header->size = size;
+    header->mapped = 0;
+    return (char*)memory + ALIGNMENT;
+  }
+
+  void* callocate(size_t num, size_t size) const {
+    void* ptr = allocate(num * size);
+    // Fresh mappings are zeroed by the operating system.
+    if (ptr != nullptr && headerOf(ptr)->mapped == 0) {
+      memset(ptr, 0, num * size);
+    }
+    return ptr;
+  }
+
+  void* reallocate(void* ptr, size_t size) const {
+    if (ptr == nullptr) {
+      return allocate(size);
+    }
+    Header* header = headerOf(ptr);
+    if (header->mapped >= ALIGNMENT + size && size >= threshold) {
+      header->size = size;
+      return ptr;
+    }
+    void* newPtr = allocate(size);
+    if (newPtr != nullptr) {
+      memcpy(newPtr, ptr, std::min(header->size, size));
+      deallocate(ptr);
+    }
+    return newPtr;
+  }
+
+  static void deallocate(void* ptr) {
+    if (ptr == nullptr) {
+      return;
+    }
+    Header* header = headerOf(ptr);
+#if TACO_HUGE_PAGES
+    if (header->mapped > 0) {
+      munmap(header, header->mapped);
+      return;
+    }
+#endif
+    free(header);
+  }
+
+  static void* allocate(void* context, size_t size) {
+    return ((Content*)context)->allocate(size);
+  }
+
+  static void* callocate(void* context, size_t num, size_t size) {
+    return ((Content*)context)->callocate(num, size);
+  }
+
+  static void* reallocate(void* context, void* ptr, size_t size) {
+    return ((Content*)context)->reallocate(ptr, size);
+  }
+
+  static void deallocate(void* context, void* ptr) {
+    deallocate(ptr);
+  }
+};
+
+HugePageAllocator::HugePageAllocator(size_t threshold) : content(new Content) {
+  content->threshold = threshold;
+  content->functions = {Content::allocate, Content::callocate,
+                        Content::reallocate, Content::deallocate,
+                        content.get()};
+}
+
+const taco_allocator_t* HugePageAllocator::getAllocator() const {
+  return &content->functions;
+}
+
+}
@@ -5,6 +5,7 @@
 
 #include "taco/type.h"
 #include "taco/error.h"
+#include "taco/storage/allocator.h"
 #include "taco/util/uncopyable.h"
 #include "taco/util/strings.h"
 #include "taco/cuda.h"
@@ -15,9 +16,10 @@ namespace taco {
 
 struct Array::Content : util::Uncopyable {
   Datatype   type;
-  void*  data;
-  size_t size;
+  void*  data = nullptr;
+  size_t size = 0;
   Policy policy = Array::UserOwns;
+  const taco_allocator_t* allocator = nullptr;
 
   ~Content() {
     switch (policy) {
@@ -32,6 +34,9 @@ struct Array::Content : util::Uncopyable {
           free(data);
         }
         break;
+      case Deallocate:
+        deallocate(allocator, data);
+        break;
       case Delete:
         switch (type.getKind()) {
           case Datatype::Bool:
@@ -96,6 +101,9 @@ Array::Array(Datatype type, void* data, size_t size, Policy policy) : Array() {
   content->data = data;
   content->size = size;
   content->policy = policy;
+  if (policy == Deallocate) {
+    content->allocator = getAllocator();
+  }
 }
 
 const Datatype& Array::getType() const {
@@ -106,6 +114,10 @@ size_t Array::getSize() const {
   return content->size;
 }
 
+Array::Policy Array::getPolicy() const {
+  return content->policy;
+}
+
 const void* Array::getData() const {
   return content->data;
 }
@@ -205,6 +217,9 @@ std::ostream& operator<<(std::ostream& os, Array::Policy policy) {
     case Array::Delete:
       os << "delete";
       break;
+    case Array::Deallocate:
+      os << "deallocate";
+      break;
   }
   return os;
 }
@@ -214,7 +229,8 @@ Array makeArray(Datatype type, size_t size) {
     return Array(type, cuda_unified_alloc(size * type.getNumBytes()), size, Array::Free);
   }
   else {
-    return Array(type, malloc(size * type.getNumBytes()), size, Array::Free);
+    return Array(type, allocate(size * type.getNumBytes()), size,
+                 Array::Deallocate);
   }
 }
 
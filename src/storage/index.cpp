@@ -59,6 +59,14 @@ size_t Index::getSize() const {
       size *= modeIndex.getIndexArray(0).get(0).getAsIndex();
     } else if (modeType.getName() == Sparse.getName()) {
       size = modeIndex.getIndexArray(0).get(size).getAsIndex();
+    } else if (modeType.getChunkSize() > 0) {
+      const size_t chunkSize = modeType.getChunkSize();
+      const size_t numChunks = (size + chunkSize - 1) / chunkSize;
+      size = modeIndex.getIndexArray(0).get(2*size + numChunks).getAsIndex();
+    } else if (modeType.getHashCapacity() > 0) {
+      size *= modeType.getHashCapacity();
+    } else if (modeType.isBitmap()) {
+      size = modeIndex.getIndexArray(1).getSize() * 64;
     } else {
       taco_not_supported_yet;
     }
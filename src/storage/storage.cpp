@@ -15,6 +15,9 @@ using namespace std;
 
 namespace taco {
 
+/// The index arrays of a level that are passed to kernels
+enum LevelArrays { SizeArray, PosAndCrdArrays, CrdArray };
+
 // class Storage
 struct TensorStorage::Content {
   Datatype      componentType;
@@ -22,6 +25,8 @@ struct TensorStorage::Content {
   Format        format;
 
   taco_tensor_t *tensorData;
+  vector<taco_mode_t> modeTypes;
+  vector<LevelArrays> levelArrays;
 
   Index         index;
   Array         values;
@@ -37,17 +42,22 @@ struct TensorStorage::Content {
         "must match the tensor order (" << dimensions.size() << ").";
     vector<int32_t> dimensionsInt32(order);
     vector<int32_t> modeOrdering(order);
-    vector<taco_mode_t> modeTypes(order);
+    modeTypes.resize(order);
     for (int i=0; i < order; ++i) {
       dimensionsInt32[i] = dimensions[i];
       modeOrdering[i] = format.getModeOrdering()[i];
       auto modeType  = format.getModeFormats()[i];
       if (modeType.getName() == Dense.getName()) {
         modeTypes[i] = taco_mode_dense;
-      } else if (modeType.getName() == Sparse.getName()) {
+        levelArrays.push_back(SizeArray);
+      } else if (modeType.getName() == Sparse.getName() ||
+                 modeType.getChunkSize() > 0) {
         modeTypes[i] = taco_mode_sparse;
-      } else if (modeType.getName() == Singleton.getName()) {
+        levelArrays.push_back(PosAndCrdArrays);
+      } else if (modeType.getName() == Singleton.getName() ||
+                 modeType.getHashCapacity() > 0 || modeType.isBitmap()) {
         modeTypes[i] = taco_mode_sparse;
+        levelArrays.push_back(CrdArray);
       } else {
         taco_not_supported_yet;
       }
@@ -115,57 +125,86 @@ size_t TensorStorage::getSizeInBytes() {
   return indexSizeInBytes + values.getSize() * values.getType().getNumBytes();
 }
 
-TensorStorage::operator struct taco_tensor_t*() const {
-  taco_tensor_t* tensorData = content->tensorData;
+/// Points `binding` to `data`.  Pointers that are already bound are not
+/// written, so that kernels that run concurrently on shared operands only
+/// read the operands' taco_tensor_t.
+static inline void bind(uint8_t*& binding, const void* data) {
+  if (binding != (uint8_t*)data) {
+    binding = (uint8_t*)data;
+  }
+}
 
-  taco_iassert(getComponentType().getNumBits() <= INT_MAX);
-  int order = getOrder();
-  Format format = getFormat();
-  Index index = getIndex();
-
-  for (int i = 0; i < order; i++) {
-    auto modeType  = format.getModeFormats()[i];
-    auto modeIndex = index.getModeIndex(i);
-
-    // Dense modes don't have indices (they iterate over mode sizes)
-    if (modeType.getName() == Dense.getName()) {
-      // TODO Uncomment assertion and remove code in this conditional
-      // taco_iassert(modeIndex.numIndexArrays() == 0)
-      //     << modeIndex.numIndexArrays();
-      const Array& size = modeIndex.getIndexArray(0);
-      tensorData->indices[i][0] = (uint8_t*)size.getData();
-    }
-    // Sparse levels have two indices (pos and idx)
-    else if (modeType.getName() == Sparse.getName()) {
-      // TODO Uncomment assert and remove conditional
-      // taco_iassert(modeIndex.numIndexArrays() == 2)
-      //     << modeIndex.numIndexArrays();
-      if (modeIndex.numIndexArrays() > 0) {
-        const Array& pos = modeIndex.getIndexArray(0);
-        const Array& idx = modeIndex.getIndexArray(1);
-        tensorData->indices[i][0] = (uint8_t*)pos.getData();
-        tensorData->indices[i][1] = (uint8_t*)idx.getData();
+/// Points the index and value arrays of the taco_tensor_t to those of the
+/// storage.  This only reads the index through references and does not
+/// allocate, since it is on the path of every kernel call.
+static void bindArrays(const vector<LevelArrays>& levelArrays,
+                       const Index& index, const Array& values,
+                       taco_tensor_t* tensorData) {
+  for (size_t i = 0; i < levelArrays.size(); i++) {
+    const ModeIndex& modeIndex = index.getModeIndex(i);
+
+    switch (levelArrays[i]) {
+      // Dense modes don't have indices (they iterate over mode sizes)
+      case SizeArray: {
+        // TODO Uncomment assertion and remove code in this conditional
+        // taco_iassert(modeIndex.numIndexArrays() == 0)
+        //     << modeIndex.numIndexArrays();
+        const Array& size = modeIndex.getIndexArray(0);
+        bind(tensorData->indices[i][0], size.getData());
+        break;
       }
-    }
-    else if (modeType.getName() == Singleton.getName()) {
-      // TODO Uncomment assert and remove conditional
-      // taco_iassert(modeIndex.numIndexArrays() == 2)
-      //     << modeIndex.numIndexArrays();
-      if (modeIndex.numIndexArrays() > 0) {
-        const Array& idx = modeIndex.getIndexArray(1);
-        tensorData->indices[i][1] = (uint8_t*)idx.getData();
-      }
-    }
-    else {
-      taco_not_supported_yet;
+      // Sparse and sliced ELLPACK levels have two indices (pos and idx)
+      case PosAndCrdArrays:
+        // TODO Uncomment assert and remove conditional
+        // taco_iassert(modeIndex.numIndexArrays() == 2)
+        //     << modeIndex.numIndexArrays();
+        if (modeIndex.numIndexArrays() > 0) {
+          const Array& pos = modeIndex.getIndexArray(0);
+          const Array& idx = modeIndex.getIndexArray(1);
+          bind(tensorData->indices[i][0], pos.getData());
+          bind(tensorData->indices[i][1], idx.getData());
+        }
+        break;
+      // Singleton, hashed and bitmap levels only pass their second index
+      case CrdArray:
+        // TODO Uncomment assert and remove conditional
+        // taco_iassert(modeIndex.numIndexArrays() == 2)
+        //     << modeIndex.numIndexArrays();
+        if (modeIndex.numIndexArrays() > 0) {
+          const Array& idx = modeIndex.getIndexArray(1);
+          bind(tensorData->indices[i][1], idx.getData());
+        }
+        break;
     }
   }
+  bind(tensorData->vals, values.getData());
+}
 
-  tensorData->vals  = (uint8_t*)getValues().getData();
-
+TensorStorage::operator struct taco_tensor_t*() const {
+  bind();
   return content->tensorData;
 }
 
+void TensorStorage::bind() const {
+  taco_iassert(getComponentType().getNumBits() <= INT_MAX);
+  bindArrays(content->levelArrays, getIndex(), getValues(), content->tensorData);
+}
+
+taco_tensor_t* TensorStorage::makeTacoTensorT() const {
+  int order = getOrder();
+  vector<int32_t> dimensions(content->dimensions.begin(),
+                             content->dimensions.end());
+  vector<int32_t> modeOrdering(getFormat().getModeOrdering().begin(),
+                               getFormat().getModeOrdering().end());
+  vector<taco_mode_t> modeTypes = content->modeTypes;
+  taco_tensor_t* tensorData =
+      init_taco_tensor_t(order, getComponentType().getNumBits(),
+                         dimensions.data(), modeOrdering.data(),
+                         modeTypes.data());
+  bindArrays(content->levelArrays, getIndex(), getValues(), tensorData);
+  return tensorData;
+}
+
 void TensorStorage::setIndex(const Index& index) {
   content->index = index;
 }
@@ -0,0 +1,199 @@
+#include "taco/util/trace.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <unistd.h>
+
+#include "taco/util/env.h"
+#include "taco/util/files.h"
+
+using namespace std;
+
+namespace taco {
+namespace util {
+
+struct TraceEvent {
+  const char* name;
+  const char* category;
+  int64_t timestamp;  // nanoseconds since the trace epoch
+  int threadId;
+  char phase;         // 'B' (begin) or 'E' (end)
+};
+
+/// A ring buffer of events.  Only the thread that holds the buffer writes
+/// events, and it publishes them by incrementing the event count.
+struct TraceBuffer {
+  static const size_t CAPACITY = 1 << 16;
+
+  TraceBuffer() : numEvents(0), events(CAPACITY) {}
+
+  void record(int threadId, const char* name, const char* category,
+              char phase) {
+    size_t n = numEvents.load(memory_order_relaxed);
+    TraceEvent& event = events[n % CAPACITY];
+    event.name = name;
+    event.category = category;
+    event.timestamp = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+    event.threadId = threadId;
+    event.phase = phase;
+    numEvents.store(n + 1, memory_order_release);
+  }
+
+  atomic<size_t> numEvents;
+  vector<TraceEvent> events;
+};
+
+/// The buffers of the threads that recorded events.  The buffer of a thread
+/// that exits is recycled for a new thread, so the trace keeps the events of
+/// finished threads until new threads overwrite them, and there are only as
+/// many buffers as threads that recorded events at once.
+struct TraceRegistry {
+  mutex buffersMutex;
+  vector<unique_ptr<TraceBuffer>> buffers;
+  vector<TraceBuffer*> freeBuffers;
+  int numThreads;
+  atomic<bool> enabled;
+  int64_t epoch;
+  string filename;
+
+  TraceRegistry() : numThreads(0), enabled(false) {
+    epoch = chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()).count();
+    filename = getFromEnv("TACO_TRACE", "");
+    if (filename != "") {
+      enabled = true;
+      atexit([]() {
+        writeTrace(getRegistry().filename);
+      });
+    }
+  }
+
+  /// Returns a buffer for a new thread, and the id of the thread.
+  TraceBuffer* acquireBuffer(int* threadId) {
+    lock_guard<mutex> lock(buffersMutex);
+    *threadId = numThreads++;
+    if (!freeBuffers.empty()) {
+      TraceBuffer* buffer = freeBuffers.back();
+      freeBuffers.pop_back();
+      return buffer;
+    }
+    buffers.emplace_back(new TraceBuffer());
+    return buffers.back().get();
+  }
+
+  void releaseBuffer(TraceBuffer* buffer) {
+    lock_guard<mutex> lock(buffersMutex);
+    freeBuffers.push_back(buffer);
+  }
+
+  // The registry is never destroyed, so that threads and the exit handler can
+  // record and write events during static destruction.
+  static TraceRegistry& getRegistry() {
+    static TraceRegistry* registry = new TraceRegistry();
+    return *registry;
+  }
+};
+
+/// The buffer that a thread records events into, which is released when the
+/// thread exits.
+struct ThreadTrace {
+  ThreadTrace() {
+    buffer = TraceRegistry::getRegistry().acquireBuffer(&threadId);
+  }
+
+  ~ThreadTrace() {
+    TraceRegistry::getRegistry().releaseBuffer(buffer);
+  }
+
+  TraceBuffer* buffer;
+  int threadId;
+};
+
+// Reads TACO_TRACE when the library is loaded, so that programs that record
+// no events still write a trace.
+static const bool traceInitialized = (TraceRegistry::getRegistry(), true);
+
+static void record(const char* name, const char* category, char phase) {
+  thread_local ThreadTrace thread;
+  thread.buffer->record(thread.threadId, name, category, phase);
+}
+
+void setTracing(bool enabled) {
+  TraceRegistry::getRegistry().enabled = enabled;
+}
+
+bool isTracing() {
+  return TraceRegistry::getRegistry().enabled.load(memory_order_relaxed);
+}
+
+void traceBegin(const char* name, const char* category) {
+  if (isTracing()) {
+    record(name, category, 'B');
+  }
+}
+
+void traceEnd(const char* name, const char* category) {
+  if (isTracing()) {
+    record(name, category, 'E');
+  }
+}
+
+static void writeEscaped(ostream& stream, const char* str) {
+  for (; *str != '\0'; str++) {
+    if (*str == '"' || *str == '\\') {
+      stream << '\\';
+    }
+    stream << *str;
+  }
+}
+
+void writeTrace(ostream& stream) {
+  TraceRegistry& registry = TraceRegistry::getRegistry();
+  lock_guard<mutex> lock(registry.buffersMutex);
+  const int pid = getpid();
+  stream << "{\"traceEvents\":[";
+  bool first = true;
+  for (auto& buffer : registry.buffers) {
+    size_t end = buffer->numEvents.load(memory_order_acquire);
+    size_t begin = (end > TraceBuffer::CAPACITY) ? end - TraceBuffer::CAPACITY
+                                                 : 0;
+    for (size_t i = begin; i < end; i++) {
+      const TraceEvent& event = buffer->events[i % TraceBuffer::CAPACITY];
+      stream << (first ? "\n" : ",\n") << "{\"name\":\"";
+      writeEscaped(stream, event.name);
+      stream << "\",\"cat\":\"";
+      writeEscaped(stream, event.category);
+      // Timestamps are in microseconds.
+      int64_t timestamp = event.timestamp - registry.epoch;
+      stream << "\",\"ph\":\"" << event.phase << "\""
+             << ",\"ts\":" << timestamp / 1000 << "."
+             << setw(3) << setfill('0') << timestamp % 1000 << setfill(' ')
+             << ",\"pid\":" << pid << ",\"tid\":" << event.threadId << "}";
+      first = false;
+    }
+  }
+  stream << "\n],\"displayTimeUnit\":\"ms\"}" << endl;
+}
+
+void writeTrace(string filename) {
+  fstream stream;
+  openStream(stream, filename, fstream::out);
+  writeTrace(stream);
+}
+
+void clearTrace() {
+  TraceRegistry& registry = TraceRegistry::getRegistry();
+  lock_guard<mutex> lock(registry.buffersMutex);
+  for (auto& buffer : registry.buffers) {
+    buffer->numEvents = 0;
+  }
+}
+
+}}
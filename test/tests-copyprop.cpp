@@ -13,6 +13,13 @@ using taco::ir::Neg;
 using taco::ir::Add;
 using taco::ir::While;
 using taco::ir::Scope;
+using taco::ir::For;
+using taco::ir::Load;
+using taco::ir::Store;
+using taco::ir::Mul;
+using taco::ir::Stmt;
+using taco::ir::hoistLoopInvariants;
+using taco::Float64;
 
 TEST(expr, simplify_copy) {
   auto a = Var::make("a", Int32), 
@@ -76,3 +83,77 @@ TEST(expr, simplify_dont_copy_loop_dependent_var) {
   ASSERT_EQ(simplifiedInc->lhs, b);
   ASSERT_EQ(simplifiedInc->rhs.as<Add>()->a, b);
 }
+
+TEST(expr, hoist_loop_invariants) {
+  auto i = Var::make("i", Int32),
+       j = Var::make("j", Int32),
+       n = Var::make("n", Int32),
+       jA = Var::make("jA", Int32),
+       A = Var::make("A", Float64, true),
+       pos = Var::make("pos", Int32, true);
+
+  // for (i = 0; i < n; i++)
+  //   for (j = 0; j < pos[i+1]; j++)
+  //     A[i*n + j] = 0
+  auto jADecl = VarDecl::make(jA, Add::make(Mul::make(i, n), j)),
+       store = Store::make(A, jA, 0.0),
+       inner = For::make(j, 0, Load::make(pos, Add::make(i, 1)), 1,
+                         Block::make(jADecl, store)),
+       outer = For::make(i, 0, n, 1, inner);
+
+  // The product and the loop bound are hoisted out of the inner loop, but not
+  // out of the outer loop, which defines `i`
+  auto hoisted = hoistLoopInvariants(outer);
+  auto *hoistedOuter = hoisted.as<For>();
+  ASSERT_NE(hoistedOuter, nullptr);
+  auto *outerBody = hoistedOuter->contents.as<Scope>()->scopedStmt.as<Block>();
+  ASSERT_NE(outerBody, nullptr);
+  ASSERT_EQ(outerBody->contents.size(), size_t(3));
+
+  auto *productDecl = outerBody->contents[0].as<VarDecl>();
+  ASSERT_NE(productDecl->rhs.as<Mul>(), nullptr);
+  auto *endDecl = outerBody->contents[1].as<VarDecl>();
+  ASSERT_NE(endDecl->rhs.as<Load>(), nullptr);
+
+  auto *hoistedInner = outerBody->contents[2].as<For>();
+  ASSERT_EQ(hoistedInner->end, endDecl->var);
+  auto *innerBody = hoistedInner->contents.as<Scope>()->scopedStmt.as<Block>();
+  auto *hoistedJADecl = innerBody->contents[0].as<VarDecl>();
+  ASSERT_EQ(hoistedJADecl->rhs.as<Add>()->a, productDecl->var);
+}
+
+TEST(expr, hoist_dont_hoist_written_loads) {
+  auto j = Var::make("j", Int32),
+       pos = Var::make("pos", Int32, true);
+
+  // for (j = 0; j < pos[1]; j++)
+  //   pos[0] = j
+  auto loop = For::make(j, 0, Load::make(pos, 1), 1, Store::make(pos, 0, j));
+
+  auto hoisted = hoistLoopInvariants(loop);
+  ASSERT_EQ(hoisted, loop);
+}
+
+TEST(expr, eliminate_common_subexpressions) {
+  auto i = Var::make("i", Int32),
+       n = Var::make("n", Int32),
+       a = Var::make("a", Int32),
+       b = Var::make("b", Int32),
+       c = Var::make("c", Int32),
+       d = Var::make("d", Int32);
+
+  auto aDecl = VarDecl::make(a, Mul::make(i, n)),
+       bDecl = VarDecl::make(b, Mul::make(i, n)),
+       dDecl = VarDecl::make(d, Add::make(b, 1)),
+       iInc = Assign::make(i, Add::make(i, 1)),
+       cDecl = VarDecl::make(c, Mul::make(i, n));
+  auto block = Block::make(aDecl, bDecl, dDecl, iInc, cDecl);
+
+  // `b` is replaced by `a`, but `c` is not since `i` is incremented in between
+  auto eliminated = hoistLoopInvariants(block);
+  auto *eliminatedBlock = eliminated.as<Block>();
+  ASSERT_EQ(eliminatedBlock->contents.size(), size_t(4));
+  ASSERT_EQ(eliminatedBlock->contents[1].as<VarDecl>()->var, d);
+  ASSERT_EQ(eliminatedBlock->contents[1].as<VarDecl>()->rhs.as<Add>()->a, a);
+  ASSERT_NE(eliminatedBlock->contents[3].as<VarDecl>()->rhs.as<Mul>(), nullptr);
+}
@@ -72,3 +72,305 @@ TEST(format, dense) {
   A.pack();
   ASSERT_COMPONENTS_EQUALS({{{3}}, {{3}}}, {0,2,0, 0,0,0, 3,0,4}, A);
 }
+
+TEST(format, bcsr) {
+  Tensor<double> A("A", {4, 6}, CSR);
+  A.insert({0, 0}, 1.0);
+  A.insert({1, 1}, 2.0);
+  A.insert({0, 5}, 3.0);
+  A.insert({3, 2}, 4.0);
+  A.pack();
+
+  Tensor<double> B = A.block({2, 3}, BCSR(2, 3));
+  ASSERT_EQ(std::vector<int>({2, 2, 2, 3}), B.getDimensions());
+  ASSERT_COMPONENTS_EQUALS({{{2}}, {{0,2,3}, {0,1,0}}, {{2}}, {{3}}},
+                           {1,0,0, 0,2,0, 0,0,3, 0,0,0, 0,0,0, 0,0,4}, B);
+
+  Tensor<double> x("x", {6}, Dense);
+  for (int j = 0; j < 6; ++j) {
+    x.insert({j}, (double)(j + 1));
+  }
+  x.pack();
+  Tensor<double> xb = x.block({3}, Format({Dense, DenseBlock(3)}));
+
+  IndexVar i("i"), j("j"), ib("ib"), jb("jb"), ii("ii"), ji("ji");
+  Tensor<double> y("y", {4}, Dense);
+  y(i) = A(i,j) * x(j);
+  y.evaluate();
+
+  Tensor<double> yb("yb", {2, 2}, Format({Dense, DenseBlock(2)}));
+  yb(ib,ii) = B(ib,jb,ii,ji) * xb(jb,ji);
+  yb.evaluate();
+  ASSERT_EQ(std::string::npos, yb.getSource().find("B3_dimension"));
+  ASSERT_EQ(std::string::npos, yb.getSource().find("B4_dimension"));
+
+  for (int row = 0; row < 4; ++row) {
+    ASSERT_DOUBLE_EQ(y.at({row}), yb.at({row / 2, row % 2}));
+  }
+}
+
+TEST(format, sell) {
+  Tensor<double> A("A", {5, 6}, SELL(2, 4));
+  A.insert({0, 1}, 1.0);
+  A.insert({0, 4}, 2.0);
+  A.insert({1, 0}, 3.0);
+  A.insert({2, 2}, 4.0);
+  A.insert({2, 3}, 5.0);
+  A.insert({2, 5}, 6.0);
+  A.insert({4, 1}, 7.0);
+  A.pack();
+
+  // Rows 2 and 0 form the first chunk, rows 1 and 3 the second, and row 4 the
+  // third; each row is stored with stride 2 and chunks are padded with zeros.
+  // The row bounds are followed by the chunk bounds and the row of each lane.
+  auto modeIndex = A.getStorage().getIndex().getModeIndex(1);
+  auto pos = modeIndex.getIndexArray(0);
+  auto crd = modeIndex.getIndexArray(1);
+  ASSERT_ARRAY_EQ(std::vector<int>({1,5, 6,8, 0,6, 7,7, 8,10, 0,6,8,10, 
+                                    2,0,1,3,4}),
+                  {(int*)pos.getData(), pos.getSize()});
+  ASSERT_ARRAY_EQ(std::vector<int>({2,1,3,4,5,0, 0,0, 1,0}),
+                  {(int*)crd.getData(), crd.getSize()});
+  auto vals = A.getStorage().getValues();
+  ASSERT_ARRAY_EQ(std::vector<double>({4,1,5,2,6,0, 3,0, 7,0}),
+                  {(double*)vals.getData(), vals.getSize()});
+  ASSERT_DOUBLE_EQ(5.0, A.at({2, 3}));
+  ASSERT_DOUBLE_EQ(0.0, A.at({3, 3}));
+
+  Tensor<double> B("B", {5, 6}, CSR);
+  for (auto& component : A) {
+    B.insert(component.first.toVector(), component.second);
+  }
+  B.pack();
+
+  Tensor<double> x("x", {6}, Dense);
+  for (int j = 0; j < 6; ++j) {
+    x.insert({j}, (double)(j + 1));
+  }
+  x.pack();
+
+  IndexVar i("i"), j("j");
+  Tensor<double> y("y", {5}, Dense);
+  y(i) = A(i,j) * x(j);
+  y.evaluate();
+  ASSERT_NE(std::string::npos, y.getSource().find("i_chunk"));
+  ASSERT_EQ(std::string::npos, y.getSource().find("jA += 2"));
+
+  Tensor<double> expected("expected", {5}, Dense);
+  expected(i) = B(i,j) * x(j);
+  expected.evaluate();
+  ASSERT_TENSOR_EQ(expected, y);
+}
+
+TEST(format, sell_chunks) {
+  // 37 rows leave a partial last chunk, and the sort window spans two chunks.
+  Tensor<double> A("A", {37, 50}, SELL(4, 8));
+  Tensor<double> B("B", {37, 50}, CSR);
+  for (int i = 0; i < 37; ++i) {
+    for (int j = (i * 7) % 5; j < 50; j += 1 + (i + j) % 9) {
+      A.insert({i, j}, (double)(i - j));
+      B.insert({i, j}, (double)(i - j));
+    }
+  }
+  A.pack();
+  B.pack();
+
+  Tensor<double> x("x", {50}, Dense);
+  for (int j = 0; j < 50; ++j) {
+    x.insert({j}, (double)(j % 7) - 3.0);
+  }
+  x.pack();
+  Tensor<double> z("z", {37}, Dense);
+  for (int i = 0; i < 37; ++i) {
+    z.insert({i}, (double)(i % 3));
+  }
+  z.pack();
+
+  // Row sums are lowered to chunk loops, and transposed products and sums
+  // that depend on the row to strided position loops.
+  IndexVar i("i"), j("j");
+  Tensor<double> y("y", {37}, Dense);
+  y(i) = -(A(i,j) * x(j)) * 2;
+  y.evaluate();
+  ASSERT_NE(std::string::npos, y.getSource().find("i_chunk"));
+  Tensor<double> expectedY("expectedY", {37}, Dense);
+  expectedY(i) = -(B(i,j) * x(j)) * 2;
+  expectedY.evaluate();
+  ASSERT_TENSOR_EQ(expectedY, y);
+
+  Tensor<double> w("w", {50}, Dense);
+  w(j) = A(i,j) * z(i);
+  w.evaluate();
+  ASSERT_EQ(std::string::npos, w.getSource().find("i_chunk"));
+  Tensor<double> expectedW("expectedW", {50}, Dense);
+  expectedW(j) = B(i,j) * z(i);
+  expectedW.evaluate();
+  ASSERT_TENSOR_EQ(expectedW, w);
+
+  Tensor<double> v("v", {37}, Dense);
+  v(i) = A(i,j) * x(j) * z(i);
+  v.evaluate();
+  ASSERT_EQ(std::string::npos, v.getSource().find("i_chunk"));
+  Tensor<double> expectedV("expectedV", {37}, Dense);
+  expectedV(i) = B(i,j) * x(j) * z(i);
+  expectedV.evaluate();
+  ASSERT_TENSOR_EQ(expectedV, v);
+}
+
+TEST(format, bitmap) {
+  Tensor<double> A("A", {4, 100}, {Dense, Bitmap});
+  Tensor<double> B("B", {4, 100}, {Dense, Bitmap});
+  Tensor<double> CA("CA", {4, 100}, CSR);
+  Tensor<double> CB("CB", {4, 100}, CSR);
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 100; ++j) {
+      if ((i + j) % 3 == 0) {
+        A.insert({i, j}, (double)(i + j));
+        CA.insert({i, j}, (double)(i + j));
+      }
+      if ((i * j) % 4 == 1) {
+        B.insert({i, j}, (double)(j - i));
+        CB.insert({i, j}, (double)(j - i));
+      }
+    }
+  }
+  A.pack();
+  B.pack();
+  CA.pack();
+  CB.pack();
+
+  // Every row is padded to two 64-bit words.
+  auto bits = A.getStorage().getIndex().getModeIndex(1).getIndexArray(1);
+  ASSERT_EQ(8u, bits.getSize());
+  ASSERT_EQ(0x9249249249249249ull, ((uint64_t*)bits.getData())[0]);
+  ASSERT_DOUBLE_EQ(6.0, A.at({2, 4}));
+  ASSERT_DOUBLE_EQ(0.0, A.at({2, 3}));
+
+  Tensor<double> x("x", {100}, Dense);
+  for (int j = 0; j < 100; ++j) {
+    x.insert({j}, (double)(j + 1));
+  }
+  x.pack();
+
+  IndexVar i("i"), j("j");
+  Tensor<double> y("y", {4}, Dense);
+  y(i) = A(i,j) * x(j);
+  y.evaluate();
+  ASSERT_NE(std::string::npos, y.getSource().find("taco_ctz"));
+  Tensor<double> expectedY("expectedY", {4}, Dense);
+  expectedY(i) = CA(i,j) * x(j);
+  expectedY.evaluate();
+  ASSERT_TENSOR_EQ(expectedY, y);
+
+  // Bitmap operands are intersected and unioned a word at a time.
+  Tensor<double> C("C", {4, 100}, {Dense, Bitmap});
+  C(i,j) = A(i,j) * B(i,j);
+  C.evaluate();
+  ASSERT_NE(std::string::npos, C.getSource().find("A2_bits["));
+  ASSERT_NE(std::string::npos, C.getSource().find("] & "));
+  Tensor<double> expectedC("expectedC", {4, 100}, CSR);
+  expectedC(i,j) = CA(i,j) * CB(i,j);
+  expectedC.evaluate();
+  Tensor<double> convertedC("convertedC", {4, 100}, CSR);
+  convertedC(i,j) = C(i,j) * 1;
+  convertedC.evaluate();
+  ASSERT_TENSOR_EQ(expectedC, convertedC);
+
+  Tensor<double> D("D", {4, 100}, CSR);
+  D(i,j) = A(i,j) + B(i,j);
+  D.evaluate();
+  ASSERT_NE(std::string::npos, D.getSource().find("] | "));
+  Tensor<double> expectedD("expectedD", {4, 100}, CSR);
+  expectedD(i,j) = CA(i,j) + CB(i,j);
+  expectedD.evaluate();
+  ASSERT_TENSOR_EQ(expectedD, D);
+}
+
+TEST(format, hashed) {
+  Tensor<double> A("A", {4, 100}, {Dense, Hashed(8)});
+  A.insert({0, 97}, 1.0);
+  A.insert({0, 3}, 2.0);
+  A.insert({1, 50}, 3.0);
+  A.insert({3, 0}, 4.0);
+  A.insert({3, 64}, 5.0);
+  A.insert({3, 99}, 6.0);
+  A.pack();
+
+  // Every row is a hash table with 8 slots; empty slots store coordinate -1.
+  auto crd = A.getStorage().getIndex().getModeIndex(1).getIndexArray(1);
+  ASSERT_EQ(32u, crd.getSize());
+  int stored = 0;
+  for (size_t p = 0; p < crd.getSize(); ++p) {
+    stored += (((int*)crd.getData())[p] >= 0);
+  }
+  ASSERT_EQ(6, stored);
+  ASSERT_DOUBLE_EQ(5.0, A.at({3, 64}));
+  ASSERT_DOUBLE_EQ(0.0, A.at({2, 64}));
+
+  Tensor<double> B("B", {4, 100}, CSR);
+  for (auto& component : A) {
+    B.insert(component.first.toVector(), component.second);
+  }
+  B.pack();
+
+  Tensor<double> x("x", {100}, Dense);
+  for (int j = 0; j < 100; ++j) {
+    x.insert({j}, (double)(j + 1));
+  }
+  x.pack();
+
+  IndexVar i("i"), j("j");
+  Tensor<double> y("y", {4}, Dense);
+  y(i) = A(i,j) * x(j);
+  y.evaluate();
+
+  Tensor<double> expected("expected", {4}, Dense);
+  expected(i) = B(i,j) * x(j);
+  expected.evaluate();
+  ASSERT_TENSOR_EQ(expected, y);
+
+  // Results stored in hashed levels are assembled by inserting coordinates.
+  Tensor<double> C("C", {4, 100}, {Dense, Hashed(8)});
+  C(i,j) = B(i,j) * 2;
+  C.evaluate();
+  ASSERT_DOUBLE_EQ(12.0, C.at({3, 99}));
+  ASSERT_DOUBLE_EQ(0.0, C.at({2, 99}));
+
+  // Hashed levels are unordered, so convert to CSR by iterating and packing.
+  Tensor<double> D("D", {4, 100}, CSR);
+  for (auto& component : C) {
+    D.insert(component.first.toVector(), component.second);
+  }
+  D.pack();
+  Tensor<double> expectedD("expectedD", {4, 100}, CSR);
+  expectedD(i,j) = B(i,j) * 2;
+  expectedD.evaluate();
+  ASSERT_TENSOR_EQ(expectedD, D);
+}
+
+TEST(format, hashed_full) {
+  // A segment of capacity 8 holds at most 7 coordinates.
+  Tensor<double> A("A", {2, 100}, {Dense, Hashed(8)});
+  for (int j = 0; j < 7; ++j) {
+    A.insert({0, 10 * j}, 1.0);
+  }
+  A.pack();
+  ASSERT_DOUBLE_EQ(1.0, A.at({0, 60}));
+  ASSERT_DOUBLE_EQ(0.0, A.at({0, 61}));
+
+  Tensor<double> B("B", {2, 100}, {Dense, Hashed(8)});
+  for (int j = 0; j < 12; ++j) {
+    B.insert({1, 3 * j}, 1.0);
+  }
+  ASSERT_THROW(B.pack(), taco::TacoException);
+
+  Tensor<double> C("C", {2, 100}, CSR);
+  for (int j = 0; j < 12; ++j) {
+    C.insert({1, 3 * j}, 1.0);
+  }
+  C.pack();
+  IndexVar i("i"), j("j");
+  Tensor<double> D("D", {2, 100}, {Dense, Hashed(8)});
+  D(i,j) = C(i,j) * 2;
+  ASSERT_THROW(D.evaluate(), taco::TacoException);
+}
@@ -2,6 +2,9 @@
 #include "test_tensors.h"
 
 #include <cmath>
+#include <thread>
+#include <functional>
+#include <sstream>
 
 #include "taco/lower/lower.h"
 #include "taco/ir/ir.h"
@@ -9,6 +12,7 @@
 #include "taco/index_notation/index_notation_rewriter.h"
 #include "taco/index_notation/index_notation_nodes.h"
 #include "taco/index_notation/kernel.h"
+#include "taco/index_notation/transformations.h"
 #include "taco/codegen/module.h"
 #include "taco/storage/storage.h"
 #include "taco/storage/pack.h"
@@ -1556,4 +1560,101 @@ TEST_STMT(vector_not,
   }
 )
 
+/// Calls the kernel from several threads at once, each computing into its own
+/// result from the shared operands, and returns the number of calls whose
+/// values differ from those of a call on one thread.
+static int countConcurrentMismatches(Kernel kernel,
+                                     std::function<TensorStorage()> makeResult,
+                                     vector<TensorStorage> operands) {
+  auto run = [&](TensorStorage result) {
+    vector<TensorStorage> arguments = {result};
+    arguments.insert(arguments.end(), operands.begin(), operands.end());
+    return kernel(arguments);
+  };
+  TensorStorage expected = makeResult();
+  taco_iassert(run(expected));
+  const size_t numValues = expected.getValues().getSize();
+  const double* expectedValues = (const double*)expected.getValues().getData();
+
+  const int numThreads = 8;
+  const int numCalls = 100;
+  vector<int> mismatches(numThreads, 0);
+  vector<std::thread> threads;
+  for (int t = 0; t < numThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int call = 0; call < numCalls; call++) {
+        TensorStorage result = makeResult();
+        const double* values = run(result)
+            ? (const double*)result.getValues().getData() : nullptr;
+        if (values == nullptr || result.getValues().getSize() != numValues ||
+            !std::equal(values, values + numValues, expectedValues)) {
+          mismatches[t]++;
+        }
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  int numMismatches = 0;
+  for (int count : mismatches) {
+    numMismatches += count;
+  }
+  return numMismatches;
+}
+
+TEST(lower, concurrent_kernel_calls) {
+  const int N = 64;
+  Tensor<double> B("B", {N, N}, CSR);
+  Tensor<double> C("C", {N, N}, CSR);
+  Tensor<double> c("c", {N}, Dense);
+  for (int i = 0; i < N; i++) {
+    B.insert({i, i}, 2.0);
+    B.insert({i, (i * 7 + 1) % N}, 1.0);
+    C.insert({i, (i * 3 + 2) % N}, 3.0);
+    C.insert({(i * 5) % N, i}, 1.0);
+    c.insert({i}, (double)i);
+  }
+  B.pack();
+  C.pack();
+  c.pack();
+
+  IndexVar i("i"), j("j"), k("k");
+  TensorVar Bv = B.getTensorVar(), Cv = C.getTensorVar(), cv = c.getTensorVar();
+
+  // A kernel without temporaries
+  Tensor<double> a("a", {N}, Dense);
+  TensorVar av = a.getTensorVar();
+  IndexStmt spmv =
+      makeConcreteNotation(makeReductionNotation(av(i) = Bv(i,j) * cv(j)));
+  auto makeVector = [&]() {
+    TensorStorage result(Float64, {N}, Format({Dense}));
+    result.setIndex(Index(Format({Dense}), {ModeIndex({makeArray({N})})}));
+    return result;
+  };
+  ASSERT_EQ(0, countConcurrentMismatches(compile(spmv), makeVector,
+                                         {B.getStorage(), c.getStorage()}));
+
+  // A kernel that precomputes each row of the result in a workspace, which
+  // every thread acquires from its own pool
+  Tensor<double> A("A", {N, N}, Format({Dense, Dense}));
+  TensorVar Av = A.getTensorVar();
+  IndexStmt spgemm = reorderLoopsTopologically(makeConcreteNotation(
+      makeReductionNotation(Av(i,j) = Bv(i,k) * Cv(k,j))));
+  TensorVar w("w", Type(Float64, {N}), Dense);
+  spgemm = spgemm.precompute(Bv(i,k) * Cv(k,j), j, j, w);
+  Kernel workspaceKernel = compile(spgemm);
+  std::stringstream source;
+  source << workspaceKernel;
+  ASSERT_NE(std::string::npos, source.str().find("taco_workspace_acquire("));
+  auto makeMatrix = [&]() {
+    Format format({Dense, Dense});
+    TensorStorage result(Float64, {N, N}, format);
+    result.setIndex(Index(format, {ModeIndex({makeArray({N})}),
+                                   ModeIndex({makeArray({N})})}));
+    return result;
+  };
+  ASSERT_EQ(0, countConcurrentMismatches(workspaceKernel, makeMatrix,
+                                         {B.getStorage(), C.getStorage()}));
+}
 }}
@@ -64,7 +64,8 @@ IndexStmt scheduleSpMMCPU(IndexStmt stmt, Tensor<double> A, int CHUNK_SIZE=16, i
           .parallelize(k, ParallelUnit::CPUVector, OutputRaceStrategy::IgnoreRaces);
 }
 
-IndexStmt scheduleSpGEMMCPU(IndexStmt stmt, bool doPrecompute) {
+IndexStmt scheduleSpGEMMCPU(IndexStmt stmt, bool doPrecompute,
+                            ModeFormat workspaceFormat = Dense) {
   Assignment assign = stmt.as<Forall>().getStmt().as<Forall>().getStmt()
                           .as<Forall>().getStmt().as<Assignment>();
   TensorVar result = assign.getLhs().getTensorVar();
@@ -73,7 +74,7 @@ IndexStmt scheduleSpGEMMCPU(IndexStmt stmt, bool doPrecompute) {
   if (doPrecompute) {
     IndexVar j = assign.getLhs().getIndexVars()[1];
     TensorVar w("w", Type(result.getType().getDataType(), 
-                {result.getType().getShape().getDimension(1)}), taco::dense);
+                {result.getType().getShape().getDimension(1)}), workspaceFormat);
     stmt = stmt.precompute(assign.getRhs(), j, j, w);
   }
   stmt = stmt.assemble(result, AssembleStrategy::Insert, true);
@@ -596,6 +597,20 @@ TEST(scheduling_eval, spmmCPU) {
   ASSERT_TENSOR_EQ(expected, C);
 }
 
+/// Inserts a small integer value into each component of the matrix with
+/// probability `sparsity`, plus `offset`, and packs the matrix.
+void fillSparseMatrix(Tensor<double> matrix, float sparsity, double offset=0) {
+  for (int i = 0; i < matrix.getDimension(0); i++) {
+    for (int j = 0; j < matrix.getDimension(1); j++) {
+      float rand_float = (float)rand()/(float)(RAND_MAX);
+      if (rand_float < sparsity) {
+        matrix.insert({i, j}, (double) ((int) (rand_float*3/sparsity)) + offset);
+      }
+    }
+  }
+  matrix.pack();
+}
+
 struct spgemm : public TestWithParam<std::tuple<Format,Format,bool>> {};
 
 TEST_P(spgemm, scheduling_eval) {
@@ -616,36 +631,136 @@ TEST_P(spgemm, scheduling_eval) {
   Tensor<double> C("C", {NUM_I, NUM_K}, CSR);
 
   srand(75883);
-  for (int i = 0; i < NUM_I; i++) {
-    for (int j = 0; j < NUM_J; j++) {
-      float rand_float = (float)rand()/(float)(RAND_MAX);
-      if (rand_float < SPARSITY) {
-        A.insert({i, j}, (double) ((int) (rand_float*3/SPARSITY)));
-      }
-    }
+  fillSparseMatrix(A, SPARSITY);
+  fillSparseMatrix(B, SPARSITY);
+
+  C(i, k) = A(i, j) * B(j, k);
+  IndexStmt stmt = C.getAssignment().concretize();
+  stmt = scheduleSpGEMMCPU(stmt, doPrecompute);
+
+  C.compile(stmt);
+  C.assemble();
+  C.compute();
+
+  Tensor<double> expected("expected", {NUM_I, NUM_K}, {Dense, Dense});
+  expected(i, k) = A(i, j) * B(j, k);
+  expected.compile();
+  expected.assemble();
+  expected.compute();
+  ASSERT_TENSOR_EQ(expected, C);
+}
+
+TEST(scheduling_eval, spgemmBitmapWorkspaceCPU) {
+  if (should_use_CUDA_codegen()) {
+    return;
+  }
+
+  int NUM_I = 100;
+  int NUM_J = 100;
+  int NUM_K = 100;
+  float SPARSITY = .03;
+  Tensor<double> A("A", {NUM_I, NUM_J}, CSR);
+  Tensor<double> B("B", {NUM_J, NUM_K}, CSR);
+  Tensor<double> C("C", {NUM_I, NUM_K}, CSR);
+
+  srand(75883);
+  fillSparseMatrix(A, SPARSITY);
+  fillSparseMatrix(B, SPARSITY);
+
+  C(i, k) = A(i, j) * B(j, k);
+  IndexStmt stmt = C.getAssignment().concretize();
+  stmt = scheduleSpGEMMCPU(stmt, true, Bitmap);
+
+  // The bitmap workspace is scanned in order, so it does not need sorting.
+  C.compile(stmt);
+  ASSERT_EQ(std::string::npos, C.getSource().find("qsort"));
+  ASSERT_NE(std::string::npos, C.getSource().find("taco_ctz"));
+  C.assemble();
+  C.compute();
+
+  Tensor<double> expected("expected", {NUM_I, NUM_K}, {Dense, Dense});
+  expected(i, k) = A(i, j) * B(j, k);
+  expected.compile();
+  expected.assemble();
+  expected.compute();
+  ASSERT_TENSOR_EQ(expected, C);
+}
+
+TEST(scheduling_eval, spgemmBitmapWorkspaceReusedCPU) {
+  if (should_use_CUDA_codegen()) {
+    return;
+  }
+
+  // Each round compiles the same statement, so it runs the cached module of
+  // the first round.  The assemble and compute functions of that module
+  // acquire pooled workspaces with different fills, which must not share
+  // buffers across calls.
+  int NUM_I = 60;
+  int NUM_J = 60;
+  int NUM_K = 60;
+  float SPARSITY = .05;
+  for (int round = 0; round < 4; round++) {
+    Tensor<double> A("A", {NUM_I, NUM_J}, CSR);
+    Tensor<double> B("B", {NUM_J, NUM_K}, CSR);
+    Tensor<double> C("C", {NUM_I, NUM_K}, CSR);
+
+    srand(1931 + round);
+    fillSparseMatrix(A, SPARSITY, 1);
+    fillSparseMatrix(B, SPARSITY, 1);
+
+    C(i, k) = A(i, j) * B(j, k);
+    IndexStmt stmt = C.getAssignment().concretize();
+    stmt = scheduleSpGEMMCPU(stmt, true, Bitmap);
+    C.compile(stmt);
+    C.assemble();
+    C.compute();
+
+    Tensor<double> expected("expected", {NUM_I, NUM_K}, {Dense, Dense});
+    expected(i, k) = A(i, j) * B(j, k);
+    expected.compile();
+    expected.assemble();
+    expected.compute();
+    ASSERT_TENSOR_EQ(expected, C);
+  }
+}
+
+TEST(scheduling_eval, spgemmHashedWorkspaceCPU) {
+  if (should_use_CUDA_codegen()) {
+    return;
   }
 
+  // Too many columns for a dense workspace per thread, but few nonzeros in 
+  // each row of the result.
+  int NUM_I = 100;
+  int NUM_J = 100;
+  int NUM_K = 1000000;
+  float SPARSITY = .03;
+  Tensor<double> A("A", {NUM_I, NUM_J}, CSR);
+  Tensor<double> B("B", {NUM_J, NUM_K}, CSR);
+  Tensor<double> C("C", {NUM_I, NUM_K}, CSR);
+
+  srand(75883);
+  fillSparseMatrix(A, SPARSITY);
   for (int j = 0; j < NUM_J; j++) {
-    for (int k = 0; k < NUM_K; k++) {
-      float rand_float = (float)rand()/(float)(RAND_MAX);
-      if (rand_float < SPARSITY) {
-        B.insert({j, k}, (double) ((int) (rand_float*3/SPARSITY)));
-      }
+    for (int nz = 0; nz < 4; nz++) {
+      B.insert({j, (int) (rand() % NUM_K)}, (double) (nz + 1));
     }
   }
-
-  A.pack();
   B.pack();
 
   C(i, k) = A(i, j) * B(j, k);
   IndexStmt stmt = C.getAssignment().concretize();
-  stmt = scheduleSpGEMMCPU(stmt, doPrecompute);
+  stmt = scheduleSpGEMMCPU(stmt, true, Hashed(256));
 
+  // The workspace holds 256 values and coordinates rather than NUM_K, and its
+  // coordinates are sorted since C is ordered.
   C.compile(stmt);
+  ASSERT_NE(std::string::npos, C.getSource().find("taco_hashLocate(w_"));
+  ASSERT_NE(std::string::npos, C.getSource().find("qsort"));
   C.assemble();
   C.compute();
 
-  Tensor<double> expected("expected", {NUM_I, NUM_K}, {Dense, Dense});
+  Tensor<double> expected("expected", {NUM_I, NUM_K}, CSR);
   expected(i, k) = A(i, j) * B(j, k);
   expected.compile();
   expected.assemble();
@@ -653,6 +768,46 @@ TEST_P(spgemm, scheduling_eval) {
   ASSERT_TENSOR_EQ(expected, C);
 }
 
+TEST(scheduling_eval, spgemmHashedWorkspaceFullCPU) {
+  if (should_use_CUDA_codegen()) {
+    return;
+  }
+
+  // The first row of the result has more nonzeros than the hash table of the
+  // workspace can hold.
+  int NUM_I = 4;
+  int NUM_J = 4;
+  int NUM_K = 100;
+  Tensor<double> A("A", {NUM_I, NUM_J}, CSR);
+  Tensor<double> B("B", {NUM_J, NUM_K}, CSR);
+  Tensor<double> C("C", {NUM_I, NUM_K}, CSR);
+  A.insert({0, 0}, 1.0);
+  A.insert({0, 1}, 2.0);
+  for (int k = 0; k < 10; k++) {
+    B.insert({0, 2 * k}, 1.0);
+    B.insert({1, 2 * k + 1}, 1.0);
+  }
+  A.pack();
+  B.pack();
+
+  C(i, k) = A(i, j) * B(j, k);
+  IndexStmt stmt = C.getAssignment().concretize();
+  stmt = scheduleSpGEMMCPU(stmt, true, Hashed(16));
+  C.compile(stmt);
+  ASSERT_THROW(C.assemble(), taco::TacoException);
+
+  Tensor<double> D("D", {NUM_I, NUM_K}, CSR);
+  D(i, k) = A(i, j) * B(j, k);
+  stmt = scheduleSpGEMMCPU(D.getAssignment().concretize(), true, Hashed(32));
+  D.compile(stmt);
+  D.assemble();
+  D.compute();
+  Tensor<double> expected("expected", {NUM_I, NUM_K}, CSR);
+  expected(i, k) = A(i, j) * B(j, k);
+  expected.evaluate();
+  ASSERT_TENSOR_EQ(expected, D);
+}
+
 INSTANTIATE_TEST_CASE_P(spgemm, spgemm,
                         Values(std::make_tuple(CSR, CSR, true),
                                std::make_tuple(DCSR, CSR, true),
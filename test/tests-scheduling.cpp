@@ -9,6 +9,7 @@
 #include "taco/lower/lower.h"
 
 #include <functional>
+#include <unistd.h>
 
 using namespace taco;
 const IndexVar i("i"), j("j"), k("k");
@@ -535,6 +536,424 @@ TEST(scheduling, parallelizeTemporaryReduction) {
 //  codegen->compile(compute, true);
 }
 
+TEST(scheduling, parallelizeTemporaryScatter) {
+  if (should_use_CUDA_codegen()) {
+    return;
+  }
+
+  // Small outputs are privatized per thread, while larger outputs are 
+  // updated with atomics.
+  for (int NUM_J : {100, (1 << 20) + 1}) {
+    const int NUM_I = 100;
+    Tensor<double> A("A", {NUM_I, NUM_J}, CSR);
+    Tensor<double> x("x", {NUM_I}, Format({Dense}));
+    Tensor<double> y("y", {NUM_J}, Format({Dense}));
+
+    for (int i = 0; i < NUM_I; i++) {
+      for (int j = 0; j < 100; j++) {
+        if ((i * 3 + j) % 7 == 0) {
+          A.insert({i, j * (NUM_J / 100)}, (double) (j + 1));
+        }
+      }
+      x.insert({i}, (double) (i + 1));
+    }
+
+    A.pack();
+    x.pack();
+
+    y(j) = A(i, j) * x(i);
+
+    IndexStmt stmt = y.getAssignment().concretize();
+    stmt = stmt.reorder({i, j})
+               .parallelize(i, ParallelUnit::CPUThread, 
+                            OutputRaceStrategy::Temporary);
+
+    y.compile(stmt);
+    const bool privatized = 
+        (y.getSource().find("y_private") != std::string::npos);
+    const bool atomic = 
+        (y.getSource().find("omp atomic") != std::string::npos);
+    ASSERT_EQ(NUM_J == 100, privatized);
+    ASSERT_EQ(NUM_J != 100, atomic);
+    y.assemble();
+    y.compute();
+
+    Tensor<double> expected("expected", {NUM_J}, Format({Dense}));
+    expected(j) = A(i, j) * x(i);
+    expected.compile();
+    expected.assemble();
+    expected.compute();
+    ASSERT_TENSOR_EQ(expected, y);
+  }
+}
+
+TEST(scheduling, parallelizeAtomicsReduction) {
+  if (should_use_CUDA_codegen()) {
+    return;
+  }
+
+  // Scalar outputs are summed with a reduction clause, while small outputs 
+  // are privatized per thread, so neither needs atomics.
+  const int NUM_I = 1000;
+  const int NUM_J = 100;
+  Tensor<double> A("A", {NUM_I, NUM_J}, CSR);
+  Tensor<double> b("b", {NUM_I}, Format({Sparse}));
+  Tensor<double> x("x", {NUM_I}, Format({Dense}));
+  for (int i = 0; i < NUM_I; i++) {
+    for (int j = 0; j < NUM_J; j++) {
+      if ((i * 3 + j) % 7 == 0) {
+        A.insert({i, j}, (double) (j + 1));
+      }
+    }
+    if (i % 3 == 0) {
+      b.insert({i}, (double) (i + 2));
+    }
+    x.insert({i}, (double) (i + 1));
+  }
+  A.pack();
+  b.pack();
+  x.pack();
+
+  Tensor<double> c("c");
+  c = b(i) * x(i);
+  IndexStmt dot = c.getAssignment().concretize()
+                   .parallelize(i, ParallelUnit::CPUThread, 
+                                OutputRaceStrategy::Atomics);
+  c.compile(dot);
+  ASSERT_NE(std::string::npos, c.getSource().find("reduction(+:"));
+  ASSERT_EQ(std::string::npos, c.getSource().find("omp atomic"));
+  c.assemble();
+  c.compute();
+
+  Tensor<double> expectedC("expectedC");
+  expectedC = b(i) * x(i);
+  expectedC.compile();
+  expectedC.assemble();
+  expectedC.compute();
+  ASSERT_TENSOR_EQ(expectedC, c);
+
+  Tensor<double> y("y", {NUM_J}, Format({Dense}));
+  y(j) = A(i, j) * x(i);
+  IndexStmt spmv = y.getAssignment().concretize().reorder({i, j})
+                    .parallelize(i, ParallelUnit::CPUThread, 
+                                 OutputRaceStrategy::Atomics);
+  y.compile(spmv);
+  ASSERT_NE(std::string::npos, y.getSource().find("y_private"));
+  ASSERT_EQ(std::string::npos, y.getSource().find("omp atomic"));
+  y.assemble();
+  y.compute();
+
+  Tensor<double> expectedY("expectedY", {NUM_J}, Format({Dense}));
+  expectedY(j) = A(i, j) * x(i);
+  expectedY.compile();
+  expectedY.assemble();
+  expectedY.compute();
+  ASSERT_TENSOR_EQ(expectedY, y);
+}
+
+TEST(scheduling, parallelizeMergePath) {
+  if (should_use_CUDA_codegen()) {
+    return;
+  }
+
+  // A matrix with a few rows that are much longer than the others, which 
+  // are split between merge-path tiles.
+  const int NUM_I = 2000;
+  const int NUM_J = 6000;
+  Tensor<double> A("A", {NUM_I, NUM_J}, CSR);
+  Tensor<double> x("x", {NUM_J}, Format({Dense}));
+  Tensor<double> expected("expected", {NUM_I}, Format({Dense}));
+  std::vector<double> sums(NUM_I, 0.0);
+  for (int j = 0; j < NUM_J; j++) {
+    x.insert({j}, (double) (j % 5 + 1));
+  }
+  for (int i = 0; i < NUM_I; i++) {
+    const int rowLength = (i == 3 || i == 1500) ? NUM_J : (i % 3);
+    for (int j = 0; j < rowLength; j++) {
+      const int col = (i == 3 || i == 1500) ? j : (i * 7 + j * 13) % NUM_J;
+      A.insert({i, col}, (double) (i % 4 + 1));
+      sums[i] += (i % 4 + 1) * (col % 5 + 1);
+    }
+    if (sums[i] != 0.0) {
+      expected.insert({i}, sums[i]);
+    }
+  }
+  A.pack();
+  x.pack();
+  expected.pack();
+
+  Tensor<double> y("y", {NUM_I}, Format({Dense}));
+  y(i) = A(i, j) * x(j);
+  IndexStmt stmt = y.getAssignment().concretize()
+                    .parallelize(i, ParallelUnit::CPUThreadMergePath, 
+                                 OutputRaceStrategy::NoRaces);
+  y.compile(stmt);
+  ASSERT_NE(std::string::npos, y.getSource().find("taco_mergePathSearch"));
+  y.assemble();
+  y.compute();
+  ASSERT_TENSOR_EQ(expected, y);
+
+  // Skewed operands are balanced by default.
+  Tensor<double> z("z", {NUM_I}, Format({Dense}));
+  z(i) = A(i, j) * x(j);
+  z.compile();
+  ASSERT_NE(std::string::npos, z.getSource().find("taco_mergePathSearch"));
+  z.assemble();
+  z.compute();
+  ASSERT_TENSOR_EQ(expected, z);
+
+  // Merge paths only partition loops over the rows of CSR matrices.
+  Tensor<double> B("B", {NUM_I, NUM_J}, Format({Dense, Dense}));
+  Tensor<double> w("w", {NUM_I}, Format({Dense}));
+  w(i) = B(i, j) * x(j);
+  ASSERT_THROW(w.getAssignment().concretize()
+                .parallelize(i, ParallelUnit::CPUThreadMergePath, 
+                             OutputRaceStrategy::NoRaces), 
+               taco::TacoException);
+}
+
+TEST(scheduling, mergebyGallop) {
+  // A long vector that stores the even coordinates and a short vector whose
+  // coordinates are spread out, so that only some of them intersect.
+  const int NUM_I = 10000;
+  Tensor<double> a("a", {NUM_I}, Format({Sparse}));
+  Tensor<double> b("b", {NUM_I}, Format({Sparse}));
+  Tensor<double> expected("expected", {NUM_I}, Format({Sparse}));
+  for (int i = 0; i < NUM_I; i += 2) {
+    a.insert({i}, (double) (i % 7 + 1));
+  }
+  for (int i = 0; i < NUM_I; i += 251) {
+    b.insert({i}, 2.0);
+    if (i % 2 == 0) {
+      expected.insert({i}, 2.0 * (i % 7 + 1));
+    }
+  }
+  b.insert({NUM_I - 2}, 3.0);
+  expected.insert({NUM_I - 2}, 3.0 * ((NUM_I - 2) % 7 + 1));
+  a.pack();
+  b.pack();
+  expected.pack();
+
+  Tensor<double> c("c", {NUM_I}, Format({Sparse}));
+  c(i) = a(i) * b(i);
+  IndexStmt stmt = c.getAssignment().concretize()
+                    .mergeby(i, MergeStrategy::Gallop);
+  c.compile(stmt);
+  ASSERT_NE(std::string::npos, c.getSource().find("= taco_gallop("));
+  c.assemble();
+  c.compute();
+  ASSERT_TENSOR_EQ(expected, c);
+
+  // Unbalanced intersections gallop by default.
+  Tensor<double> d("d", {NUM_I}, Format({Sparse}));
+  d(i) = b(i) * a(i);
+  d.compile();
+  ASSERT_NE(std::string::npos, d.getSource().find("= taco_gallop("));
+  d.assemble();
+  d.compute();
+  ASSERT_TENSOR_EQ(expected, d);
+
+  // Unions do not gallop.
+  Tensor<double> e("e", {NUM_I}, Format({Sparse}));
+  e(i) = a(i) + b(i);
+  stmt = e.getAssignment().concretize().mergeby(i, MergeStrategy::Gallop);
+  e.compile(stmt);
+  ASSERT_EQ(std::string::npos, e.getSource().find("= taco_gallop("));
+
+  // Sparse matrix times short sparse vector gallops over the rows.
+  const int NUM_J = 50;
+  Tensor<double> A("A", {NUM_J, NUM_I}, CSR);
+  Tensor<double> y("y", {NUM_J}, Format({Dense}));
+  Tensor<double> yExpected("yExpected", {NUM_J}, Format({Dense}));
+  for (int row = 0; row < NUM_J; row++) {
+    double sum = 0.0;
+    for (int col = row % 3; col < NUM_I; col += 3) {
+      A.insert({row, col}, 1.0);
+      if (col % 251 == 0) {
+        sum += 2.0;
+      }
+      else if (col == NUM_I - 2) {
+        sum += 3.0;
+      }
+    }
+    yExpected.insert({row}, sum);
+  }
+  A.pack();
+  yExpected.pack();
+  y(i) = A(i, j) * b(j);
+  stmt = y.getAssignment().concretize().mergeby(j, MergeStrategy::Gallop);
+  y.compile(stmt);
+  ASSERT_NE(std::string::npos, y.getSource().find("= taco_gallop("));
+  y.assemble();
+  y.compute();
+  ASSERT_TENSOR_EQ(yExpected, y);
+}
+
+/// Sets whether large gathers are prefetched for the duration of a scope.
+struct PrefetchLargeGathers {
+  explicit PrefetchLargeGathers(bool enabled = true)
+      : previous(taco_get_prefetch_large_gathers()) {
+    taco_set_prefetch_large_gathers(enabled);
+  }
+  ~PrefetchLargeGathers() {
+    taco_set_prefetch_large_gathers(previous);
+  }
+  bool previous;
+};
+
+/// Returns the number of bytes that the last-level cache holds.
+static size_t getLastLevelCacheSize() {
+#ifdef _SC_LEVEL3_CACHE_SIZE
+  if (sysconf(_SC_LEVEL3_CACHE_SIZE) > 0) {
+    return sysconf(_SC_LEVEL3_CACHE_SIZE);
+  }
+#endif
+  return 32 << 20;
+}
+
+TEST(scheduling, prefetchGathers) {
+  const int NUM_I = 100;
+  const int NUM_J = 1000;
+  const int NUM_K = 4;
+  Tensor<double> A("A", {NUM_I, NUM_J}, CSR);
+  Tensor<double> x("x", {NUM_J}, Format({Dense}));
+  Tensor<double> B("B", {NUM_J, NUM_K}, Format({Dense, Dense}));
+  Tensor<double> yExpected("yExpected", {NUM_I}, Format({Dense}));
+  Tensor<double> CExpected("CExpected", {NUM_I, NUM_K}, Format({Dense, Dense}));
+  for (int col = 0; col < NUM_J; col++) {
+    x.insert({col}, (double) (col % 5 + 1));
+    for (int l = 0; l < NUM_K; l++) {
+      B.insert({col, l}, (double) (col % 3 + l));
+    }
+  }
+  for (int row = 0; row < NUM_I; row++) {
+    double sum = 0.0;
+    vector<double> sums(NUM_K, 0.0);
+    for (int col = (row * 7) % 13; col < NUM_J; col += 13 + row % 50) {
+      A.insert({row, col}, 2.0);
+      sum += 2.0 * (col % 5 + 1);
+      for (int l = 0; l < NUM_K; l++) {
+        sums[l] += 2.0 * (col % 3 + l);
+      }
+    }
+    yExpected.insert({row}, sum);
+    for (int l = 0; l < NUM_K; l++) {
+      CExpected.insert({row, l}, sums[l]);
+    }
+  }
+  A.pack();
+  x.pack();
+  B.pack();
+  yExpected.pack();
+  CExpected.pack();
+
+  Tensor<double> y("y", {NUM_I}, Format({Dense}));
+  y(i) = A(i, j) * x(j);
+  IndexStmt stmt = y.getAssignment().concretize().prefetch(j, 8);
+  y.compile(stmt);
+  ASSERT_NE(std::string::npos, y.getSource().find("__builtin_prefetch(&x_vals["));
+  y.assemble();
+  y.compute();
+  ASSERT_TENSOR_EQ(yExpected, y);
+
+  // The rows of a dense matrix are prefetched from their first component.
+  Tensor<double> C("C", {NUM_I, NUM_K}, Format({Dense, Dense}));
+  C(i, k) = A(i, j) * B(j, k);
+  stmt = C.getAssignment().concretize().prefetch(j, 4);
+  C.compile(stmt);
+  ASSERT_NE(std::string::npos, C.getSource().find("__builtin_prefetch(&B_vals["));
+  C.assemble();
+  C.compute();
+  ASSERT_TENSOR_EQ(CExpected, C);
+
+  // Without a schedule, gathers are prefetched only if large gathers are
+  // prefetched, and then only from operands that do not fit in the last-level
+  // cache.
+  PrefetchLargeGathers prefetchLargeGathers;
+  Tensor<double> z("z", {NUM_I}, Format({Dense}));
+  z(i) = A(i, j) * x(j);
+  z.compile();
+  ASSERT_EQ(std::string::npos, z.getSource().find("__builtin_prefetch("));
+
+  const int LARGE_J = getLastLevelCacheSize() / sizeof(double) + 1;
+  Tensor<double> L("L", {NUM_I, LARGE_J}, CSR);
+  Tensor<double> w("w", {LARGE_J}, Format({Dense}));
+  L.insert({0, LARGE_J - 1}, 3.0);
+  L.insert({1, 0}, 2.0);
+  w.insert({0}, 5.0);
+  w.insert({LARGE_J - 1}, 7.0);
+  L.pack();
+  w.pack();
+  Tensor<double> u("u", {NUM_I}, Format({Dense}));
+  u(i) = L(i, j) * w(j);
+  {
+    PrefetchLargeGathers disabled(false);
+    u.compile();
+  }
+  ASSERT_EQ(std::string::npos, u.getSource().find("__builtin_prefetch("));
+  Tensor<double> v("v", {NUM_I}, Format({Dense}));
+  v(i) = L(i, j) * w(j);
+  v.compile();
+  ASSERT_NE(std::string::npos, v.getSource().find("__builtin_prefetch(&w_vals["));
+  v.assemble();
+  v.compute();
+  ASSERT_EQ(21.0, v.at({0}));
+  ASSERT_EQ(10.0, v.at({1}));
+
+  ASSERT_THROW(y.getAssignment().concretize().prefetch(k, 8),
+               taco::TacoException);
+  ASSERT_THROW(y.getAssignment().concretize().prefetch(j, 0),
+               taco::TacoException);
+}
+
+TEST(scheduling, parallelizeSparseAssembly) {
+  if (should_use_CUDA_codegen()) {
+    return;
+  }
+
+  // Enough rows that the prefix sum over row counts is itself parallelized.
+  const int NUM_I = 70000;
+  const int NUM_J = 10;
+  Tensor<double> A("A", {NUM_I, NUM_J}, CSR);
+  Tensor<double> B("B", {NUM_I, NUM_J}, CSR);
+  Tensor<double> C("C", {NUM_I, NUM_J}, CSR);
+
+  for (int i = 0; i < NUM_I; i++) {
+    for (int j = 0; j < NUM_J; j++) {
+      if ((i + j) % 3 == 0) {
+        A.insert({i, j}, (double) (i + j));
+      }
+      if ((i * j) % 5 == 1) {
+        B.insert({i, j}, (double) (i - j));
+      }
+    }
+  }
+
+  A.pack();
+  B.pack();
+
+  C(i, j) = A(i, j) + B(i, j);
+
+  // Parallelizing the row loop of an appended result switches to two-phase
+  // assembly, which counts and inserts the nonzeros of each row in parallel.
+  IndexStmt stmt = C.getAssignment().concretize();
+  stmt = stmt.parallelize(i, ParallelUnit::CPUThread, 
+                          OutputRaceStrategy::NoRaces);
+  ASSERT_TRUE(isa<Assemble>(stmt));
+
+  C.compile(stmt);
+  ASSERT_NE(std::string::npos, C.getSource().find("taco_prefixSum"));
+  C.assemble();
+  C.compute();
+
+  Tensor<double> expected("expected", {NUM_I, NUM_J}, CSR);
+  expected(i, j) = A(i, j) + B(i, j);
+  expected.compile();
+  expected.assemble();
+  expected.compute();
+  ASSERT_TENSOR_EQ(expected, C);
+}
+
 TEST(scheduling, multilevel_tiling) {
   Tensor<double> A("A", {8}, Format({Sparse}));
   Tensor<double> B("B", {8}, Format({Sparse}));
@@ -990,3 +1409,117 @@ TEST(scheduling, divide) {
     return stmt.fuse(i, j, f).pos(f, fpos, A(i, j)).divide(fpos, f0, f1, 4).split(f1, i1, i2, 16).split(i2, i3, i4, 8);
   });
 }
+
+TEST(scheduling, tailStrategies) {
+  IndexVar i("i"), i0("i0"), i1("i1"), j("j"), f("f"), fpos("fpos"), f0("f0"), f1("f1");
+
+  auto test = [&](int dim, std::function<IndexStmt(IndexStmt, Access)> schedule) {
+    Tensor<double> A("A", {dim, dim}, CSR);
+    Tensor<double> x("x", {dim}, Format({Dense}));
+    for (int row = 0; row < dim; row++) {
+      x.insert({row}, (double) (row % 7 + 1));
+      for (int col = row % 3; col < dim; col += 4) {
+        A.insert({row, col}, (double) (row + col));
+      }
+    }
+    A.pack();
+    x.pack();
+
+    Tensor<double> y("y", {dim}, Format({Dense}));
+    y(i) = A(i, j) * x(j);
+    y.compile(schedule(y.getAssignment().concretize(), A(i, j)));
+    y.assemble();
+    y.compute();
+    Tensor<double> expected("expected", {dim}, Format({Dense}));
+    expected(i) = A(i, j) * x(j);
+    expected.evaluate();
+    EXPECT_TRUE(equals(expected, y)) << expected << endl << y << endl;
+    return y.getSource();
+  };
+  auto count = [](const std::string& source, const std::string& pattern) {
+    size_t n = 0;
+    for (size_t pos = source.find(pattern); pos != std::string::npos;
+         pos = source.find(pattern, pos + 1)) {
+      n++;
+    }
+    return n;
+  };
+
+  // Guard checks every iteration of the inner loop.
+  std::string source = test(37, [&](IndexStmt stmt, Access access) {
+    return stmt.split(i, i0, i1, 4);
+  });
+  ASSERT_NE(std::string::npos, source.find("if (i >= A1_dimension)"));
+
+  // Peel only checks full strips, which run in an unguarded copy of the loop.
+  source = test(37, [&](IndexStmt stmt, Access access) {
+    return stmt.split(i, i0, i1, 4, TailStrategy::Peel);
+  });
+  ASSERT_NE(std::string::npos, source.find("if (i >= A1_dimension)"));
+  ASSERT_EQ(2u, count(source, "for (int32_t i1 = 0; i1 < 4; i1++)"));
+
+  // RoundUp emits no guards, so the dimension must be a multiple of the factor.
+  source = test(36, [&](IndexStmt stmt, Access access) {
+    return stmt.split(i, i0, i1, 4, TailStrategy::RoundUp)
+               .parallelize(i1, ParallelUnit::CPUVector, OutputRaceStrategy::IgnoreRaces);
+  });
+  ASSERT_EQ(std::string::npos, source.find("if (i >= A1_dimension)"));
+  ASSERT_EQ(1u, count(source, "for (int32_t i1 = 0; i1 < 4; i1++)"));
+
+  // Kernels check that the dimension is a multiple of the factor before they
+  // run, and fail if it is not.
+  {
+    Tensor<double> A("A", {37, 37}, CSR);
+    Tensor<double> x("x", {37}, Format({Dense}));
+    for (int row = 0; row < 37; row++) {
+      x.insert({row}, 1.0);
+      A.insert({row, (row * 5) % 37}, 2.0);
+    }
+    A.pack();
+    x.pack();
+    Tensor<double> y("y", {37}, Format({Dense}));
+    y(i) = A(i, j) * x(j);
+    y.compile(y.getAssignment().concretize()
+                  .split(i, i0, i1, 4, TailStrategy::RoundUp));
+    ASSERT_THROW({
+      y.assemble();
+      y.compute();
+    }, taco::TacoException);
+  }
+
+  // Predicate clamps the trip count of the last strip instead.
+  source = test(37, [&](IndexStmt stmt, Access access) {
+    return stmt.split(i, i0, i1, 4, TailStrategy::Predicate)
+               .parallelize(i1, ParallelUnit::CPUVector, OutputRaceStrategy::IgnoreRaces);
+  });
+  ASSERT_EQ(1u, count(source, "i1 < TACO_MIN(4,"));
+  ASSERT_EQ(std::string::npos, source.find("if (i >= A1_dimension)"));
+
+  source = test(37, [&](IndexStmt stmt, Access access) {
+    return stmt.fuse(i, j, f).pos(f, fpos, access).split(fpos, f0, f1, 8, TailStrategy::Predicate);
+  });
+  ASSERT_NE(std::string::npos, source.find("f1 < TACO_MIN(8,"));
+  ASSERT_EQ(std::string::npos, source.find("continue;"));
+
+  test(37, [&](IndexStmt stmt, Access access) {
+    return stmt.divide(i, i0, i1, 3, TailStrategy::Predicate);
+  });
+  test(37, [&](IndexStmt stmt, Access access) {
+    return stmt.divide(i, i0, i1, 3, TailStrategy::Peel);
+  });
+
+  // Inner variables that are transformed further fall back to guards.
+  test(37, [&](IndexStmt stmt, Access access) {
+    IndexVar i2("i2"), i3("i3");
+    return stmt.fuse(i, j, f).pos(f, fpos, access).divide(fpos, f0, f1, 2, TailStrategy::Predicate)
+               .split(f1, i2, i3, 4);
+  });
+
+  Tensor<double> a("a", {8}, Format({Dense}));
+  Tensor<double> b("b", {8}, Format({Dense}));
+  a(i) = b(i);
+  IndexStmt peeled = a.getAssignment().concretize().split(i, i0, i1, 4, TailStrategy::Peel);
+  IndexStmt guarded = a.getAssignment().concretize().split(i, i0, i1, 4);
+  ASSERT_FALSE(equals(peeled, guarded));
+  ASSERT_NE(std::string::npos, util::toString(peeled).find("split(i, i0, i1, 4, Peel)"));
+}
@@ -1,3 +1,6 @@
+#include <algorithm>
+#include <atomic>
+
 #include "test.h"
 #include "test_tensors.h"
 
@@ -5,6 +8,7 @@
 #include "taco/index_notation/index_notation.h"
 #include "taco/index_notation/index_notation_nodes.h"
 #include "taco/storage/storage.h"
+#include "taco/storage/allocator.h"
 #include "taco/lower/mode_format_dense.h"
 #include "taco/lower/mode_format_compressed.h"
 
@@ -115,4 +119,216 @@ INSTANTIATE_TEST_CASE_P(vector_add, alloc,
     )
 );
 
+/// Restores the system allocator when a test ends.
+struct SystemAllocatorGuard {
+  ~SystemAllocatorGuard() {
+    setAllocator(nullptr);
+  }
+};
+
+/// Enables memory tracking for the duration of a test.
+struct MemoryTrackingGuard {
+  MemoryTrackingGuard() {
+    setMemoryTracking(true);
+  }
+  ~MemoryTrackingGuard() {
+    setMemoryTracking(false);
+  }
+};
+
+TEST(alloc, arena_allocator) {
+  ArenaAllocator arena(1 << 16);
+  {
+    SystemAllocatorGuard guard;
+    MemoryTrackingGuard tracking;
+    setAllocator(arena.getAllocator());
+    resetAllocatorStats();
+    Tensor<double> a("a", {100}, Sparse);
+    Tensor<double> b("b", {100}, Sparse);
+    Tensor<double> c("c", {100}, Sparse);
+    for (int k = 0; k < 100; k += 3) {
+      b.insert({k}, 1.0);
+      c.insert({k / 2}, 2.0);
+    }
+    b.pack();
+    c.pack();
+    a(i) = b(i) + c(i);
+    a.evaluate();
+    AllocatorStats stats = getAllocatorStats();
+    ASSERT_NE(std::string::npos, a.getSource().find("taco_malloc("));
+    ASSERT_LT(0u, stats.numAllocations);
+    ASSERT_LT(0u, stats.bytesAllocated);
+    ASSERT_LT(0u, arena.getReservedBytes());
+    ASSERT_DOUBLE_EQ(3.0, a(0));
+    ASSERT_DOUBLE_EQ(2.0, a(1));
+    ASSERT_DOUBLE_EQ(1.0, a(99));
+  }
+  arena.reset();
+  ASSERT_EQ(size_t(1 << 16), arena.getReservedBytes());
+}
+
+/// An allocator that counts the blocks it holds.
+struct CountingAllocator {
+  CountingAllocator() : numBlocks(0) {
+    functions = {allocate, callocate, reallocate, deallocate, this};
+  }
+
+  static void* allocate(void* context, size_t size) {
+    ((CountingAllocator*)context)->numBlocks++;
+    return malloc(size);
+  }
+  static void* callocate(void* context, size_t num, size_t size) {
+    ((CountingAllocator*)context)->numBlocks++;
+    return calloc(num, size);
+  }
+  static void* reallocate(void* context, void* ptr, size_t size) {
+    if (ptr == nullptr) {
+      ((CountingAllocator*)context)->numBlocks++;
+    }
+    return realloc(ptr, size);
+  }
+  static void deallocate(void* context, void* ptr) {
+    ((CountingAllocator*)context)->numBlocks--;
+    free(ptr);
+  }
+
+  taco_allocator_t functions;
+  std::atomic<long> numBlocks;
+};
+
+TEST(alloc, pooled_workspaces) {
+  const int N = 40;
+  CountingAllocator counting;
+  SystemAllocatorGuard guard;
+  setAllocator(&counting.functions);
+  Tensor<double> B("B", {N, N}, CSR);
+  Tensor<double> C("C", {N, N}, CSR);
+  for (int r = 0; r < N; r++) {
+    B.insert({r, (7 * r) % N}, 1.0);
+    C.insert({r, (3 * r) % N}, 2.0);
+  }
+  B.pack();
+  C.pack();
+  Tensor<double> A("A", {N, N}, CSR);
+  A(i,j) = B(i,k) * C(k,j);
+  A.evaluate();
+  ASSERT_NE(std::string::npos, A.getSource().find("taco_workspace_acquire("));
+  ASSERT_LT(0u, A.getKernelMemoryStats().workspaceBytes);
+
+  // Changing the allocator hands the pooled workspaces back to the
+  // allocator that allocated them.
+  long numBlocks = counting.numBlocks;
+  setAllocator(nullptr);
+  ASSERT_EQ(0u, A.getKernelMemoryStats().workspaceBytes);
+  ASSERT_GT(numBlocks, counting.numBlocks);
+}
+
+TEST(alloc, huge_page_allocator) {
+  HugePageAllocator hugePages(1 << 12);
+  SystemAllocatorGuard guard;
+  setAllocator(hugePages.getAllocator());
+  const size_t size = 1 << 22;
+  char* small = (char*)allocate(16);
+  char* large = (char*)callocate(size, 1);
+  bool zeroed = (large[0] == 0 && large[size - 1] == 0);
+  large[0] = 1;
+  large[size - 1] = 2;
+  large = (char*)reallocate(large, 2 * size);
+  bool copied = (large[0] == 1 && large[size - 1] == 2);
+  large[2 * size - 1] = 3;
+  deallocate(large);
+  deallocate(small);
+  Array array = makeArray(Float64, 1 << 20);
+  ((double*)array.getData())[(1 << 20) - 1] = 1.0;
+  ASSERT_TRUE(zeroed);
+  ASSERT_TRUE(copied);
+}
+
+TEST(alloc, memory_accounting) {
+  ASSERT_FALSE(isMemoryTrackingEnabled());
+  void* untracked = allocate(1000);
+  MemoryTrackingGuard tracking;
+  resetAllocatorStats();
+  size_t bytesInUse = getAllocatorStats().bytesInUse;
+  deallocate(untracked);
+  ASSERT_EQ(bytesInUse, getAllocatorStats().bytesInUse);
+  ASSERT_EQ(0u, getAllocatorStats().numDeallocations);
+  {
+    AllocationScope scope;
+    void* a = allocate(1000);
+    ASSERT_EQ(bytesInUse + 1000, getAllocatorStats().bytesInUse);
+    a = reallocate(a, 2000);
+    ASSERT_EQ(bytesInUse + 2000, getAllocatorStats().bytesInUse);
+    deallocate(a);
+    void* b = callocate(10, 50);
+    deallocate(b);
+    ASSERT_EQ(3500u, scope.getBytesAllocated());
+    ASSERT_EQ(2000u, scope.getPeakBytes());
+  }
+  AllocatorStats stats = getAllocatorStats();
+  ASSERT_EQ(bytesInUse, stats.bytesInUse);
+  ASSERT_LE(bytesInUse + 2000, stats.peakBytesInUse);
+
+  Tensor<double> a("a", {100}, Sparse);
+  Tensor<double> b("b", {100}, Sparse);
+  Tensor<double> c("c", {100}, Sparse);
+  for (int k = 0; k < 100; k += 3) {
+    b.insert({k}, 1.0);
+    c.insert({k / 2}, 2.0);
+  }
+  b.pack();
+  c.pack();
+  a(i) = b(i) + c(i);
+  a.evaluate();
+  KernelMemoryStats kernelStats = a.getKernelMemoryStats();
+  ASSERT_LE(1u, kernelStats.numCalls);
+  ASSERT_LT(0u, kernelStats.bytesAllocated);
+  ASSERT_LT(0u, kernelStats.peakBytes);
+  ASSERT_LE(kernelStats.peakBytes, kernelStats.bytesAllocated);
+}
+
+struct NumaPlacementGuard {
+  ~NumaPlacementGuard() {
+    setNumaPlacement(NumaPlacement::Default);
+  }
+};
+
+TEST(alloc, numa_placement) {
+  NumaPlacementGuard guard;
+  const int n = 1 << 18;
+  for (NumaPlacement placement : {NumaPlacement::FirstTouch,
+                                  NumaPlacement::Interleave}) {
+    setNumaPlacement(placement);
+    ASSERT_EQ(placement, getNumaPlacement());
+    const size_t size = 1 << 22;
+    char* zeroes = (char*)callocate(size, 1);
+    bool zeroed = std::all_of(zeroes, zeroes + size,
+                              [](char c) { return c == 0; });
+    deallocate(zeroes);
+    ASSERT_TRUE(zeroed);
+
+    // The result arrays grow past the placement threshold during assembly.
+    Tensor<double> a("a", {n}, Sparse);
+    Tensor<double> b("b", {n}, Sparse);
+    Tensor<double> c("c", {n}, Sparse);
+    for (int k = 0; k < n; k += 2) {
+      b.insert({k}, 1.0);
+    }
+    for (int k = 0; k < n; k += 3) {
+      c.insert({k}, 2.0);
+    }
+    b.pack();
+    c.pack();
+    a(i) = b(i) + c(i);
+    a.evaluate();
+    ASSERT_LT(size_t(1 << 20), a.getStorage().getValues().getSize() *
+                               sizeof(double));
+    ASSERT_DOUBLE_EQ(3.0, a(0));
+    ASSERT_DOUBLE_EQ(1.0, a(2));
+    ASSERT_DOUBLE_EQ(2.0, a(3));
+    ASSERT_DOUBLE_EQ(0.0, a(1));
+    ASSERT_DOUBLE_EQ(2.0, a(n - 1));
+  }
+}
+
 }
@@ -494,3 +494,320 @@ TEST(tensor, cache) {
   // ability to answer a request for the first query.
   c(i, j) = a(i, j); c.evaluate();
 }
+
+TEST(tensor, call_plan) {
+  IndexVar i("i"), j("j");
+  Tensor<double> A("A", {3, 4}, CSR);
+  Tensor<double> x("x", {4}, Format({Dense}));
+  Tensor<double> y("y", {3}, Format({Dense}));
+  A(0, 1) = 2.0;
+  A(2, 0) = 3.0;
+  A(2, 3) = 4.0;
+  for (int k = 0; k < 4; k++) {
+    x(k) = 1.0;
+  }
+  A.pack();
+  x.pack();
+
+  y(i) = A(i, j) * x(j);
+  ASSERT_THROW(CallPlan{y}, taco::TacoException);
+  y.compile();
+  CallPlan plan(y);
+  ASSERT_TRUE(plan.defined());
+  ASSERT_FALSE(CallPlan().defined());
+
+  plan.evaluate();
+  ASSERT_FALSE(y.needsCompute());
+  ASSERT_DOUBLE_EQ(2.0, y(0));
+  ASSERT_DOUBLE_EQ(7.0, y(2));
+
+  // Operand values that are updated in place are seen by later calls, which
+  // allocate no memory.
+  double* xVals = (double*)x.getStorage().getValues().getData();
+  for (int round = 1; round < 4; round++) {
+    xVals[0] = round;
+    xVals[3] = 2 * round;
+    setMemoryTracking(true);
+    AllocatorStats before = getAllocatorStats();
+    plan.compute();
+    AllocatorStats after = getAllocatorStats();
+    setMemoryTracking(false);
+    ASSERT_EQ(before.numAllocations, after.numAllocations);
+    ASSERT_EQ(before.bytesAllocated, after.bytesAllocated);
+    ASSERT_DOUBLE_EQ(2.0, y(0));
+    ASSERT_DOUBLE_EQ(0.0, y(1));
+    ASSERT_DOUBLE_EQ(3.0 * round + 8.0 * round, y(2));
+  }
+
+  // Expressions that read the result are computed before a call overwrites it.
+  Tensor<double> z("z", {3}, Format({Dense}));
+  z(i) = 2.0 * y(i);
+  xVals[0] = 10.0;
+  plan.compute();
+  ASSERT_DOUBLE_EQ(30.0 + 24.0, y(2));
+  ASSERT_DOUBLE_EQ(2.0 * 33.0, z(2));
+
+  // Sparse results are reassembled by the plan.
+  Tensor<double> B("B", {3, 4}, CSR);
+  Tensor<double> C("C", {3, 4}, CSR);
+  C(i, j) = A(i, j) + B(i, j);
+  C.compile();
+  CallPlan sum(C);
+  sum.evaluate();
+  Tensor<double> expected("expected", {3, 4}, CSR);
+  expected(i, j) = A(i, j);
+  expected.evaluate();
+  ASSERT_TENSOR_EQ(expected, C);
+
+  // Results that reuse their storage are not reassembled, and checking that
+  // their structure is unchanged allocates no memory.
+  C.setReuseStorage(true);
+  sum.evaluate();
+  for (int round = 1; round < 3; round++) {
+    setMemoryTracking(true);
+    AllocatorStats before = getAllocatorStats();
+    sum.evaluate();
+    AllocatorStats after = getAllocatorStats();
+    setMemoryTracking(false);
+    ASSERT_EQ(before.numAllocations, after.numAllocations);
+    ASSERT_TENSOR_EQ(expected, C);
+  }
+}
+
+TEST(tensor, reuse_storage) {
+  IndexVar i("i"), j("j");
+  Tensor<double> A("A", {3, 4}, CSR);
+  Tensor<double> x("x", {4}, Format({Dense}));
+  Tensor<double> Y("Y", {3, 4}, Format({Dense, Dense}));
+  A(0, 1) = 2.0;
+  A(2, 0) = 3.0;
+  A(2, 3) = 4.0;
+  for (int k = 0; k < 4; k++) {
+    x(k) = 1.0;
+  }
+  A.pack();
+  x.pack();
+
+  Y.setReuseStorage(true);
+  Y(i, j) = A(i, j) * x(j);
+  Y.evaluate();
+  const void* yVals = Y.getStorage().getValues().getData();
+  ASSERT_DOUBLE_EQ(2.0, Y(0, 1));
+
+  // Reevaluations compute into the value array of the first evaluation.
+  double* xVals = (double*)x.getStorage().getValues().getData();
+  for (int round = 1; round < 4; round++) {
+    xVals[3] = round;
+    Y(i, j) = A(i, j) * x(j);
+    Y.evaluate();
+    ASSERT_EQ(yVals, Y.getStorage().getValues().getData());
+    ASSERT_DOUBLE_EQ(4.0 * round, Y(2, 3));
+  }
+
+  // Components that a new expression does not write are zeroed.
+  Tensor<double> B("B", {3, 4}, CSR);
+  B(1, 2) = 5.0;
+  B.pack();
+  Y(i, j) = B(i, j);
+  Y.evaluate();
+  ASSERT_EQ(yVals, Y.getStorage().getValues().getData());
+  Tensor<double> expected("expected", {3, 4}, Format({Dense, Dense}));
+  expected(1, 2) = 5.0;
+  expected.pack();
+  ASSERT_TENSOR_EQ(expected, Y);
+}
+
+TEST(tensor, reuse_storage_unchanged_pattern) {
+  IndexVar i("i"), j("j");
+  Tensor<double> A("A", {3, 4}, CSR);
+  Tensor<double> B("B", {3, 4}, CSR);
+  Tensor<double> C("C", {3, 4}, CSR);
+  A(0, 1) = 2.0;
+  A(2, 3) = 4.0;
+  B(1, 1) = 1.0;
+  A.pack();
+  B.pack();
+
+  C.setReuseStorage(true);
+  C(i, j) = A(i, j) + B(i, j);
+  C.evaluate();
+  const void* cPos = C.getStorage().getIndex().getModeIndex(1)
+                      .getIndexArray(0).getData();
+  const void* cVals = C.getStorage().getValues().getData();
+
+  // Repacking an operand with new values but the same pattern only computes.
+  A(0, 1) = 1.0;
+  A.pack();
+  C(i, j) = A(i, j) + B(i, j);
+  C.evaluate();
+  ASSERT_EQ(cPos, C.getStorage().getIndex().getModeIndex(1)
+                   .getIndexArray(0).getData());
+  ASSERT_EQ(cVals, C.getStorage().getValues().getData());
+  ASSERT_DOUBLE_EQ(3.0, C(0, 1));
+  ASSERT_DOUBLE_EQ(4.0, C(2, 3));
+
+  // A new pattern is assembled again.
+  B(2, 0) = 5.0;
+  B.pack();
+  C(i, j) = A(i, j) + B(i, j);
+  C.evaluate();
+  Tensor<double> expected("expected", {3, 4}, CSR);
+  expected(0, 1) = 3.0;
+  expected(1, 1) = 1.0;
+  expected(2, 0) = 5.0;
+  expected(2, 3) = 4.0;
+  expected.pack();
+  ASSERT_TENSOR_EQ(expected, C);
+
+  // Changing an index array in place changes the pattern too.
+  int* bCrd = (int*)B.getStorage().getIndex().getModeIndex(1)
+                     .getIndexArray(1).getData();
+  ASSERT_EQ(0, bCrd[1]);
+  bCrd[1] = 2;
+  C(i, j) = A(i, j) + B(i, j);
+  C.evaluate();
+  Tensor<double> expectedMoved("expectedMoved", {3, 4}, CSR);
+  expectedMoved(0, 1) = 3.0;
+  expectedMoved(1, 1) = 1.0;
+  expectedMoved(2, 2) = 5.0;
+  expectedMoved(2, 3) = 4.0;
+  expectedMoved.pack();
+  ASSERT_TENSOR_EQ(expectedMoved, C);
+}
+
+TEST(tensor, memory_usage) {
+  Tensor<double> A("A", {10,10}, CSR);
+  A.insert({0,1}, 1.0);
+  A.insert({2,3}, 2.0);
+  A.insert({9,9}, 3.0);
+  ASSERT_LE(3 * (2*sizeof(int) + sizeof(double)),
+            A.getMemoryUsage().coordinateBuffer);
+  A.pack();
+  TensorMemoryUsage usage = A.getMemoryUsage();
+  ASSERT_EQ((1 + 11) * sizeof(int), usage.pos);
+  ASSERT_EQ(3 * sizeof(int), usage.crd);
+  ASSERT_EQ(3 * sizeof(double), usage.vals);
+  ASSERT_EQ(usage.pos + usage.crd + usage.vals + usage.coordinateBuffer,
+            usage.total());
+
+  double vals[] = {1.0, 2.0};
+  Tensor<double> b("b", {2}, Dense);
+  b.getStorage().setValues(makeArray(vals, 2));
+  ASSERT_EQ(2 * sizeof(double), b.getMemoryUsage().userOwned);
+}
+
+TEST(tensor, evaluate_async) {
+  const int n = 50;
+  Tensor<double> x("x", {n}, Dense);
+  for (int j = 0; j < n; j++) {
+    x.insert({j}, (double)j);
+  }
+  x.pack();
+  std::vector<Tensor<double>> A;
+  std::vector<Tensor<double>> y;
+  IndexVar i("i"), j("j");
+  for (int k = 0; k < 3; k++) {
+    A.push_back(Tensor<double>("A" + std::to_string(k), {n,n}, CSR));
+    y.push_back(Tensor<double>("y" + std::to_string(k), {n}, Dense));
+    for (int r = 0; r < n; r++) {
+      A[k].insert({r, (r + k) % n}, (double)(k + 1));
+    }
+    A[k].pack();
+    y[k](i) = A[k](i,j) * x(j);
+  }
+  Tensor<double> z("z", {n}, Dense);
+  z(i) = y[0](i) + y[1](i) + y[2](i);
+
+  int numThreads = taco_get_num_threads();
+  taco_set_num_threads(4);
+  auto futures = evaluateAsync({z, y[1]});
+  taco_set_num_threads(numThreads);
+  ASSERT_EQ(2u, futures.size());
+  TensorBase result = futures[0].get();
+  futures[1].wait();
+  ASSERT_TRUE(result == z);
+  ASSERT_FALSE(z.needsCompute());
+  ASSERT_FALSE(y[0].needsCompute());
+  for (int r = 0; r < n; r++) {
+    ASSERT_DOUBLE_EQ((double)((r + 1) % n) * 2, y[1](r));
+    ASSERT_DOUBLE_EQ(r + ((r + 1) % n) * 2.0 + ((r + 2) % n) * 3.0, z(r));
+  }
+
+  // Results without pending assignments are ready at once.
+  auto ready = evaluateAsync(x);
+  ASSERT_EQ(std::future_status::ready,
+            ready.wait_for(std::chrono::seconds(0)));
+}
+
+TEST(tensor, dependent_tensors) {
+  const int n = 10;
+  Tensor<double> A("A", {n,n}, CSR);
+  Tensor<double> x("x", {n}, Dense);
+  for (int r = 0; r < n; r++) {
+    A.insert({r, r}, 2.0);
+    x.insert({r}, (double)r);
+  }
+  A.pack();
+  x.pack();
+
+  // Expressions that are destroyed before they are computed do not stay
+  // registered, and writing the operand does not compute them.
+  IndexVar i("i"), j("j");
+  for (int k = 0; k < 200; k++) {
+    Tensor<double> t("t", {n}, Dense);
+    t(i) = A(i,j) * x(j);
+  }
+  ASSERT_TRUE(A.getDependentTensors().empty());
+
+  // Reassigning an expression registers it once.
+  Tensor<double> y("y", {n}, Dense);
+  y(i) = A(i,j) * x(j);
+  y(i) = A(i,j) * x(j);
+  ASSERT_EQ(1u, A.getDependentTensors().size());
+
+  // Writing the operand computes the expression from the old values first.
+  A.insert({0, 0}, 1.0);
+  ASSERT_TRUE(A.getDependentTensors().empty());
+  ASSERT_FALSE(y.needsCompute());
+  for (int r = 0; r < n; r++) {
+    ASSERT_DOUBLE_EQ(2.0 * r, y(r));
+  }
+}
+
+TEST(tensor, freeze) {
+  const int n = 10;
+  Tensor<double> A("A", {n,n}, CSR);
+  Tensor<double> x("x", {n}, Dense);
+  for (int r = 0; r < n; r++) {
+    A.insert({r, r}, 2.0);
+    x.insert({r}, (double)r);
+  }
+  x.pack();
+
+  // Freezing packs the pending inserts.
+  A.freeze();
+  ASSERT_TRUE(A.isFrozen());
+  ASSERT_FALSE(A.needsPack());
+
+  IndexVar i("i"), j("j");
+  Tensor<double> y("y", {n}, Dense);
+  y(i) = A(i,j) * x(j);
+  ASSERT_TRUE(A.getDependentTensors().empty());
+  ASSERT_THROW(A.insert({0, 0}, 1.0), taco::TacoException);
+  ASSERT_THROW(A.insert(std::vector<int>({0, 0}), 1.0), taco::TacoException);
+  ASSERT_THROW(A(i,j) = A(i,j), taco::TacoException);
+  ASSERT_THROW(A.setStorage(A.getStorage()), taco::TacoException);
+  ASSERT_THROW(A.setAssignment(Assignment()), taco::TacoException);
+  for (int r = 0; r < n; r++) {
+    ASSERT_DOUBLE_EQ(2.0 * r, y(r));
+  }
+
+  // Call plans created before the result was frozen cannot write it.
+  Tensor<double> z("z", {n}, Dense);
+  z(i) = A(i,j) * x(j);
+  z.compile();
+  CallPlan plan(z);
+  z.freeze();
+  ASSERT_THROW(plan.assemble(), taco::TacoException);
+  ASSERT_THROW(plan.compute(), taco::TacoException);
+}
@@ -421,3 +421,48 @@ TEST(DISABLED_tensor_types, coordinate_types) {
   }
 
 }
+
+TEST(tensor_types, narrow_coordinate_types) {
+  Format csr16({Dense, Sparse});
+  csr16.setLevelArrayTypes({{Int32}, {Int32, UInt16}});
+  ASSERT_NE(CSR, csr16);
+
+  Tensor<double> A("A", {3, 4}, csr16);
+  A.insert({0, 1}, 1.0);
+  A.insert({0, 3}, 2.0);
+  A.insert({2, 0}, 3.0);
+  A.pack();
+  ASSERT_EQ(UInt16, A.getStorage().getIndex().getModeIndex(1).getIndexArray(1).getType());
+
+  Tensor<double> x("x", {4}, Format({Dense}));
+  for (int c = 0; c < 4; ++c) {
+    x.insert({c}, (double)(c + 1));
+  }
+  x.pack();
+
+  Tensor<double> y("y", {3}, Format({Dense}));
+  y(i) = A(i,j) * x(j);
+  y.evaluate();
+  ASSERT_NE(std::string::npos, y.getSource().find("uint16_t*"));
+
+  Tensor<double> expected("expected", {3}, Format({Dense}));
+  expected.insert({0}, 10.0);
+  expected.insert({2}, 3.0);
+  expected.pack();
+  ASSERT_TRUE(equals(y, expected));
+
+  // Assemble a sparse result whose coordinates are stored in 8 bits.
+  Format csr8({Dense, Sparse});
+  csr8.setLevelArrayTypes({{Int32}, {Int32, UInt8}});
+  Tensor<double> B("B", {3, 4}, csr8);
+  B(i,j) = A(i,j) + A(i,j);
+  B.evaluate();
+  ASSERT_EQ(UInt8, B.getStorage().getIndex().getModeIndex(1).getIndexArray(1).getType());
+
+  Tensor<double> expectedB("expectedB", {3, 4}, CSR);
+  expectedB.insert({0, 1}, 2.0);
+  expectedB.insert({0, 3}, 4.0);
+  expectedB.insert({2, 0}, 6.0);
+  expectedB.pack();
+  ASSERT_TRUE(equals(B, expectedB));
+}
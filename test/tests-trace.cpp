@@ -0,0 +1,75 @@
+#include "test.h"
+#include "test_tensors.h"
+
+#include <sstream>
+#include <string>
+#include <thread>
+
+#include "taco/tensor.h"
+#include "taco/util/trace.h"
+
+using namespace taco;
+
+namespace trace_tests {
+
+static size_t count(const std::string& str, const std::string& pattern) {
+  size_t n = 0;
+  for (size_t pos = str.find(pattern); pos != std::string::npos;
+       pos = str.find(pattern, pos + 1)) {
+    n++;
+  }
+  return n;
+}
+
+TEST(trace, pipeline_events) {
+  bool tracing = util::isTracing();
+  util::setTracing(true);
+  util::clearTrace();
+
+  Tensor<double> a("a", {8}, Sparse);
+  Tensor<double> b("b", {8}, Sparse);
+  Tensor<double> c("c", {8}, Sparse);
+  b.insert({1}, 1.0);
+  c.insert({2}, 2.0);
+  b.pack();
+  c.pack();
+  IndexVar i("i");
+  a(i) = b(i) + c(i);
+  a.compile();
+  a.assemble();
+  a.compute();
+  std::thread thread([]() {
+    util::TraceScope scope("thread event");
+  });
+  thread.join();
+  // The next thread reuses the buffer of the finished thread.
+  std::thread nextThread([]() {
+    util::TraceScope scope("next thread event");
+  });
+  nextThread.join();
+
+  std::stringstream trace;
+  util::writeTrace(trace);
+  util::setTracing(tracing);
+  util::clearTrace();
+
+  std::string json = trace.str();
+  ASSERT_EQ(0u, json.find("{\"traceEvents\":["));
+  ASSERT_EQ(4u, count(json, "\"name\":\"pack\""));
+  ASSERT_EQ(2u, count(json, "\"name\":\"compile\""));
+  ASSERT_EQ(2u, count(json, "\"name\":\"assemble\""));
+  ASSERT_EQ(2u, count(json, "\"name\":\"compute\""));
+  ASSERT_EQ(2u, count(json, "\"name\":\"thread event\""));
+  ASSERT_EQ(2u, count(json, "\"name\":\"next thread event\""));
+  ASSERT_EQ(count(json, "\"ph\":\"B\""), count(json, "\"ph\":\"E\""));
+  std::string threadEvent = json.substr(json.find("\"name\":\"thread event\""));
+  std::string nextThreadEvent =
+      json.substr(json.find("\"name\":\"next thread event\""));
+  std::string computeEvent = json.substr(json.find("\"name\":\"compute\""));
+  ASSERT_NE(threadEvent.substr(threadEvent.find("\"tid\":"), 8),
+            computeEvent.substr(computeEvent.find("\"tid\":"), 8));
+  ASSERT_NE(threadEvent.substr(threadEvent.find("\"tid\":"), 8),
+            nextThreadEvent.substr(nextThreadEvent.find("\"tid\":"), 8));
+}
+
+}
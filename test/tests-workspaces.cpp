@@ -606,3 +606,68 @@ TEST(workspaces, tile_dotProduct_3) {
   expected.compute();
   ASSERT_TENSOR_EQ(expected, A);
 }
+
+// Disables persistent workspaces for the lifetime of the guard
+struct PersistentWorkspacesDisabled {
+  PersistentWorkspacesDisabled() : enabled(shouldUsePersistentWorkspaces()) {
+    setPersistentWorkspacesEnabled(false);
+  }
+  ~PersistentWorkspacesDisabled() {
+    setPersistentWorkspacesEnabled(enabled);
+  }
+  bool enabled;
+};
+
+TEST(workspaces, persistentWorkspaces) {
+  const int N = 40;
+  IndexVar i("i"), j("j"), k("k");
+
+  // Each round calls the same kernel on operands with different nonzeros, so
+  // the workspace arrays acquired in earlier rounds must be left reset.
+  std::string source;
+  for (int round = 0; round < 3; round++) {
+    Tensor<double> B("B", {N, N}, CSR);
+    Tensor<double> C("C", {N, N}, CSR);
+    for (int r = 0; r < N; r++) {
+      for (int c = 0; c < N; c++) {
+        if ((7 * r + 3 * c + round) % 5 == 0) {
+          B.insert({r, c}, (double)(r + c + round));
+        }
+        if ((3 * r + 5 * c + round) % 7 == 0) {
+          C.insert({r, c}, (double)(r - c));
+        }
+      }
+    }
+    B.pack();
+    C.pack();
+
+    Tensor<double> A("A", {N, N}, CSR);
+    A(i,j) = B(i,k) * C(k,j);
+    A.evaluate();
+
+    Tensor<double> expected("expected", {N, N}, Format{Dense, Dense});
+    expected(i,j) = B(i,k) * C(k,j);
+    expected.evaluate();
+    ASSERT_TENSOR_EQ(expected, A);
+    ASSERT_LT(0u, A.getKernelMemoryStats().workspaceBytes);
+    source = A.getSource();
+  }
+  ASSERT_NE(source.find("= taco_workspace_acquire("), std::string::npos);
+  ASSERT_EQ(source.find("free(w_already_set)"), std::string::npos);
+
+  Tensor<double> B("B", {N + 1, N + 1}, CSR);
+  Tensor<double> C("C", {N + 1, N + 1}, CSR);
+  B.insert({0, 1}, 2.0);
+  C.insert({1, 3}, 3.0);
+  B.pack();
+  C.pack();
+  Tensor<double> A("A", {N + 1, N + 1}, CSR);
+  A(i,j) = B(i,k) * C(k,j);
+  {
+    PersistentWorkspacesDisabled disabled;
+    A.evaluate();
+  }
+  ASSERT_DOUBLE_EQ(6.0, A.at({0, 3}));
+  ASSERT_EQ(A.getSource().find("= taco_workspace_acquire("), std::string::npos);
+  ASSERT_NE(A.getSource().find("free(w_already_set)"), std::string::npos);
+}
@@ -229,10 +229,15 @@ static void printSchedulingHelp() {
               "index variable `f` that iterates over the product of the "
               "coordinates `i` and `j`.");
     cout << endl;
-    printFlag("s=split(i, i0, i1, factor)", "Splits (strip-mines) an index "
-              "variable `i` into two nested index variables `i0` and `i1`. The "
-              "size of the inner index variable `i1` is then held constant at "
-              "`factor`, which must be a positive integer.");
+    printFlag("s=split(i, i0, i1, factor, tail)", "Splits (strip-mines) an "
+              "index variable `i` into two nested index variables `i0` and `i1`. "
+              "The size of the inner index variable `i1` is then held constant at "
+              "`factor`, which must be a positive integer.  The optional `tail` "
+              "strategy handles the last strip when `factor` does not divide the "
+              "size of `i`: Guard (default) guards every iteration, Peel runs "
+              "full strips without guards, RoundUp assumes that the size is a "
+              "multiple of `factor`, and Predicate clamps the trip count of the "
+              "last strip.");
     cout << endl;
     printFlag("s=precompute(expr, i, iw)", "Leverages scratchpad memories and "
               "reorders computations to increase locality.  Given a subexpression "
@@ -257,6 +262,11 @@ static void printSchedulingHelp() {
               "index variable `i` by `factor` number of iterations, where "
               "`factor` is a positive integer.");
     cout << endl;
+    printFlag("s=prefetch(index, distance)", "Prefetches the components that "
+              "the loop over the positions corresponding to an index variable "
+              "`i` gathers from dense operands `distance` iterations ahead, "
+              "where `distance` is a positive integer.");
+    cout << endl;
     printFlag("s=parallelize(i, u, strat)", "tags an index variable `i` for "
               "parallel execution on hardware type `u`. Data races are handled by "
               "an output race strategy `strat`. Since the other transformations "
@@ -308,6 +318,18 @@ static void printCommandLine(ostream& os, int argc, char* argv[]) {
   }
 }
 
+static TailStrategy parseTailStrategy(string name) {
+  for (TailStrategy strategy : {TailStrategy::Guard, TailStrategy::Peel,
+                                TailStrategy::RoundUp,
+                                TailStrategy::Predicate}) {
+    if (name == TailStrategy_NAMES[(int)strategy]) {
+      return strategy;
+    }
+  }
+  taco_uerror << "Tail strategy " << name << " not defined.";
+  return TailStrategy::Guard;
+}
+
 static bool setSchedulingCommands(vector<vector<string>> scheduleCommands, parser::Parser& parser, IndexStmt& stmt) {
   auto findVar = [&stmt](string name) {
     ProvenanceGraph graph(stmt);
@@ -353,8 +375,8 @@ static bool setSchedulingCommands(vector<vector<string>> scheduleCommands, parse
       stmt = stmt.fuse(findVar(i), findVar(j), fused);
 
     } else if (command == "split") {
-      taco_uassert(scheduleCommand.size() == 4)
-          << "'split' scheduling directive takes 4 parameters: split(i, i1, i2, splitFactor)";
+      taco_uassert(scheduleCommand.size() == 4 || scheduleCommand.size() == 5)
+          << "'split' scheduling directive takes 4 or 5 parameters: split(i, i1, i2, splitFactor[, tailStrategy])";
       string i, i1, i2;
       size_t splitFactor;
       i = scheduleCommand[0];
@@ -363,12 +385,17 @@ static bool setSchedulingCommands(vector<vector<string>> scheduleCommands, parse
       taco_uassert(sscanf(scheduleCommand[3].c_str(), "%zu", &splitFactor) == 1)
           << "failed to parse fourth parameter to `split` directive as a size_t";
 
+      TailStrategy tailStrategy = TailStrategy::Guard;
+      if (scheduleCommand.size() == 5) {
+        tailStrategy = parseTailStrategy(scheduleCommand[4]);
+      }
+
       IndexVar split1(i1);
       IndexVar split2(i2);
-      stmt = stmt.split(findVar(i), split1, split2, splitFactor);
+      stmt = stmt.split(findVar(i), split1, split2, splitFactor, tailStrategy);
     } else if (command == "divide") {
-      taco_uassert(scheduleCommand.size() == 4)
-          << "'divide' scheduling directive takes 4 parameters: divide(i, i1, i2, divFactor)";
+      taco_uassert(scheduleCommand.size() == 4 || scheduleCommand.size() == 5)
+          << "'divide' scheduling directive takes 4 or 5 parameters: divide(i, i1, i2, divFactor[, tailStrategy])";
       string i, i1, i2;
       i = scheduleCommand[0];
       i1 = scheduleCommand[1];
@@ -378,9 +405,14 @@ static bool setSchedulingCommands(vector<vector<string>> scheduleCommands, parse
       taco_uassert(sscanf(scheduleCommand[3].c_str(), "%zu", &divideFactor) == 1)
           << "failed to parse fourth parameter to `divide` directive as a size_t";
 
+      TailStrategy tailStrategy = TailStrategy::Guard;
+      if (scheduleCommand.size() == 5) {
+        tailStrategy = parseTailStrategy(scheduleCommand[4]);
+      }
+
       IndexVar divide1(i1);
       IndexVar divide2(i2);
-      stmt = stmt.divide(findVar(i), divide1, divide2, divideFactor);
+      stmt = stmt.divide(findVar(i), divide1, divide2, divideFactor, tailStrategy);
     } else if (command == "precompute") {
       string exprStr, i, iw, name;
       vector<string> i_vars, iw_vars;
@@ -532,6 +564,15 @@ static bool setSchedulingCommands(vector<vector<string>> scheduleCommands, parse
 
       stmt = stmt.unroll(findVar(i), unrollFactor);
 
+    } else if (command == "prefetch") {
+      taco_uassert(scheduleCommand.size() == 2) << "'prefetch' scheduling directive takes 2 parameters: prefetch(i, distance)";
+      string i;
+      size_t distance;
+      i  = scheduleCommand[0];
+      taco_uassert(sscanf(scheduleCommand[1].c_str(), "%zu", &distance) == 1) << "failed to parse second parameter to `prefetch` directive as a size_t";
+
+      stmt = stmt.prefetch(findVar(i), distance);
+
     } else if (command == "parallelize") {
       string i, unit, strategy;
       taco_uassert(scheduleCommand.size() == 3) << "'parallelize' scheduling directive takes 3 parameters: parallelize(i, unit, strategy)";